@@ -0,0 +1,136 @@
+/*
+ * C interface to the card-const-MSSC framework, for embedding the solver in applications not written in C++.
+ * Refer to git repository Readme file for usage instructions.
+ *
+ * Instances are passed as caller-owned, contiguous, row-major buffers which are used in place (no copy);
+ *     they must remain valid and unchanged for the lifetime of the solver handle.
+ * Results are written into caller-provided buffers.
+ * No C++ exception crosses this interface; every function returns an MSSC_* status code.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __CARD_CONST_MSSC_C_H
+#define __CARD_CONST_MSSC_C_H
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(MSSC_C_API_BUILD)
+#define MSSC_C_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(MSSC_C_API_SHARED)
+#define MSSC_C_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define MSSC_C_API __attribute__((visibility("default")))
+#else
+#define MSSC_C_API
+#endif
+
+#define MSSC_C_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Return codes */
+#define MSSC_OK                     0
+#define MSSC_ERROR_INVALID_ARGUMENT 1 /* NULL handle, inconsistent sizes, labels or cardinalities */
+#define MSSC_ERROR_OUT_OF_MEMORY    2
+#define MSSC_ERROR_ENGINE           3 /* Exception raised by Concert Technology, CP Optimizer or CPLEX */
+#define MSSC_ERROR_INTERNAL         4
+
+/* Constraint (see CustomCPSolverOptions::Constraint) */
+#define MSSC_CONSTRAINT_WCSS                       0
+#define MSSC_CONSTRAINT_WCSS_EXTERNAL_CARD_CONTROL 1
+#define MSSC_CONSTRAINT_STANDARD_CARD_CONTROL      2
+#define MSSC_CONSTRAINT_NETWORK_CARD_CONTROL       3
+#define MSSC_CONSTRAINT_LAGRANGIAN_CARD_CONTROL    4
+
+/* Search heuristics (see CustomCPSearchOptions), values follow the order of the C++ enumerations */
+#define MSSC_INITIAL_SOLUTION_NONE                     0
+#define MSSC_INITIAL_SOLUTION_GREEDY_INIT              1
+#define MSSC_INITIAL_SOLUTION_MEMBERSHIPS_AS_INDICATED 2
+
+#define MSSC_MAIN_SEARCH_MAX_MIN_VAR 0
+
+#define MSSC_TIE_HANDLING_NONE                               0
+#define MSSC_TIE_HANDLING_UNBOUND_FARTHEST_TOTAL_SS          1
+#define MSSC_TIE_HANDLING_FIXED_FARTHEST_DIST                2
+#define MSSC_TIE_HANDLING_FIXED_MAX_MIN                      3
+#define MSSC_TIE_HANDLING_FARTHEST_POINT_FROM_BIGGEST_CENTER 4
+#define MSSC_TIE_HANDLING_MAX_MIN_POINT_FROM_ALL_CENTER      5
+
+/* Solve status (see CustomCPSolverOptions::Status) */
+#define MSSC_STATUS_UNKNOWN    0
+#define MSSC_STATUS_FEASIBLE   1
+#define MSSC_STATUS_OPTIMAL    2
+#define MSSC_STATUS_INFEASIBLE 3
+
+
+/* Problem instance, all buffers are caller-owned */
+typedef struct mssc_instance {
+    int32_t n, s, k; /* Number of observations, features and classes */
+
+    const double* coordinates; /* n*s row-major. May be NULL if dissimilarities is given and no center-based tie handling is used */
+    const double* dissimilarities; /* n*n row-major squared euclidean distances. If NULL, computed from coordinates (owned by the solver) */
+
+    const int32_t* memberships; /* n labels in 0..k-1, initial solution. May be NULL unless MSSC_INITIAL_SOLUTION_MEMBERSHIPS_AS_INDICATED */
+    const int32_t* target_cardinalities; /* k cardinalities summing to n. May be NULL with MSSC_CONSTRAINT_WCSS only */
+} mssc_instance;
+
+typedef struct mssc_options {
+    int32_t constraint; /* MSSC_CONSTRAINT_* */
+    int32_t initial_solution; /* MSSC_INITIAL_SOLUTION_* */
+    int32_t main_search; /* MSSC_MAIN_SEARCH_* */
+    int32_t tie_handling; /* MSSC_TIE_HANDLING_* */
+    int32_t symmetry_breaking; /* Non-zero to post value precedence */
+
+    double time_limit; /* Seconds, <= 0 means no limit */
+    int64_t fail_limit; /* <= 0 means no limit */
+    double relative_gap; /* Relative optimality tolerance, 0 means prove optimality */
+} mssc_options;
+
+typedef struct mssc_stats {
+    int32_t status; /* MSSC_STATUS_* */
+    double objective; /* Best WCSS found, meaningless when status is MSSC_STATUS_UNKNOWN or MSSC_STATUS_INFEASIBLE */
+    double bound; /* Best lower bound on WCSS */
+    int64_t nb_solutions;
+    int64_t nb_branches;
+    int64_t nb_fails;
+    double time; /* Seconds */
+} mssc_stats;
+
+/* Called on the solving thread for each improving solution. memberships (n labels) is only valid during the call.
+ *     Return non-zero to continue, zero to stop the search. */
+typedef int32_t (*mssc_solution_callback)(void* user_data, double objective, const int32_t* memberships, int32_t n, double time);
+
+typedef struct mssc_solver mssc_solver; /* Opaque handle */
+
+
+/* Fill options with defaults (network cardinality control, MAX_MIN_VAR, UNBOUND_FARTHEST_TOTAL_SS tie handling, no limits) */
+MSSC_C_API void mssc_options_init(mssc_options* options);
+
+/* Validate instance and options, and create a solver handle. instance buffers are referenced, not copied. */
+MSSC_C_API int32_t mssc_solver_create(const mssc_instance* instance, const mssc_options* options, mssc_solver** solver);
+
+/* Blocking resolution. memberships_out (n labels, may be NULL) receives the best solution, stats_out (may be NULL) the statistics.
+ *     callback may be NULL. */
+MSSC_C_API int32_t mssc_solve(mssc_solver* solver, int32_t* memberships_out, mssc_stats* stats_out,
+                              mssc_solution_callback callback, void* user_data);
+
+/* Stop the solve in progress on this handle, callable from any thread. mssc_solve then returns MSSC_OK with the best solution so far. */
+MSSC_C_API int32_t mssc_cancel(mssc_solver* solver);
+
+/* Release the handle. Must not be called while mssc_solve runs on it. */
+MSSC_C_API void mssc_solver_destroy(mssc_solver* solver);
+
+/* Static string describing a return code */
+MSSC_C_API const char* mssc_error_string(int32_t code);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !__CARD_CONST_MSSC_C_H */
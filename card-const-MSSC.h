@@ -23,5 +23,32 @@
 #include "src/IloWCSS.h" // Constraint speeds up resolution of general MSSC through CP
 #include "src/IloWCSS_StandardCardControl.h" // Constraint speeds up resolution of cardinality-constrained MSSC through CP, based on IloWCSS
 #include "src/IloWCSS_NetworkCardControl.h" // Constraint speeds up resolution of cardinality-constrained MSSC through CP, based on MCF resolution
+#include "src/IloWCSS_LagrangianCardControl.h" // Constraint speeds up resolution of cardinality-constrained MSSC through CP, based on a Lagrangian relaxation of the MCF
+#include "src/PropagationSchedule.h" // Optional adaptive scheduling of the cost-based filtering of the constraints above
+
+// High-level solver, builds the model above internally
+#include "src/MSSCSolver.h"
+
+// Branch-and-bound without CP Optimizer nor CPLEX, for cardinality-constrained MSSC
+#include "src/MSSCBranchAndBound.h"
+
+// Resident instances and Unix socket solve server (POSIX only)
+#include "src/InstanceCache.h"
+#ifndef _WIN32
+#include "src/MSSCDaemon.h"
+#endif
+
+// Must-link preprocessing into weighted super-points
+#include "src/MustLinkContraction.h"
+
+// Exact resolution of one-dimensional instances, used by MSSCSolver
+#include "src/OneDimensionalSolver.h"
+
+// Off-thread output of intermediate solutions
+#include "src/SolutionRing.h"
+#include "src/SolutionWriter.h"
+
+// Independent solution check and WCSS recomputation
+#include "src/SolutionVerifier.h"
 
 #endif // !__CARD_CONST_MSSC_H
\ No newline at end of file
@@ -5,6 +5,9 @@
  *       about how card-const-MSSC can be used. You are expected to modify it
  *       to suit your needs. Because data parsing is left to the user, this file will
  *       NOT compile as supplied here.
+ *
+ * Note: if you don't need to customize the model, MSSCSolver (src/MSSCSolver.h) builds this
+ *       same model internally and streams solutions to a callback.
  * 
  * card-const-MSSC is my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
  *
@@ -76,6 +79,9 @@ int main(int argc, char** argv) {
             // *or* CONSTRAINT: Total WCSS lower bound with MCF-based internal cardinality control
             model.add(IloWCSS_NetworkCardControl(env, x, V, &data));
 
+            // // *or* CONSTRAINT: Total WCSS lower bound with Lagrangian relaxation of the MCF, without CPLEX
+            // model.add(IloWCSS_LagrangianCardControl(env, x, V, &data));
+
         // CONSTRAINT: Binding objective variable to WCSS using actual expression
         IloExprArray wcsd(env, data.K); // wcsd[c] = within cluster sum of dissimilarities for cluster c
         for (int i = 0; i < data.K; i++)
@@ -105,7 +111,7 @@ int main(int argc, char** argv) {
 
         // ENGINE: Creating and configuring CP algorithm
         IloCP cp(model);
-        // cp.setParameter(IloCP::LogVerbosity, IloCP::Quiet); // Uncomment to suppress CP Optimizer output
+        cp.setParameter(IloCP::LogVerbosity, IloCP::Quiet); // The solution writer below shares std::cout, the engine log would interleave with it
         // cp.setParameter(IloCP::TimeLimit, INT_TIME_IN_SECONDS); // Uncomment to set time limit of INT_TIME_IN_SECONDS
 
         // RESOLUTION: Initialize solve process
@@ -117,30 +123,24 @@ int main(int argc, char** argv) {
                                          // NOTE: CP Optimizer moves towards initial fixed-point condition here
                                          //       All propagate member functions present are run.
 
+        // OUTPUT: Intermediate solutions are formatted and written by a background thread
+        //     The search thread only copies memberships into a preallocated ring, it never blocks on I/O.
+        SolutionRing ring(data.N, 64); // Up to 64 solutions in flight, beyond that only the last one is kept (see ring.getNbDropped())
+        SolutionWriter writer(ring, std::cout, SolutionOutputOptions::Format::TEXT, data.K); // or Format::BINARY to a file
+
         // RESOLUTION: Subsequent search
         while (cp.next()) {
             solFound = true; // At least one solution is found, so set to true
 
-            // Display intermediate solutions, for example...
-            cp.out() << std::endl << std::endl << "Status: " << cp.getStatus() << std::endl;
-            cp.out() << "  V = " << cp.getObjValue() << std::endl;
-
-            cp.out() << "  Corresponding memberships: " << std::endl << "  ";
-            for (int i = 0; i < data.N; i++) {
-                cp.out() << cp.getValue(x[i]) << " ";
-                if ((i + 1) % 24 == 0)
-                    cp.out() << "..." << std::endl << "  ";
-            }
-            cp.out() << std::endl;
-
-            cp.out() << "  Cluster cardinalities: " << std::endl << "  ";
-            for (int c = 0; c < data.K; c++)
-                cp.out() << cp.getValue(cardinality[c]) << " ";
-            cp.out() << std::endl;
-
-            cp.out() << "  Cumulative solve duration: " << cp.getTime() << std::endl;
+            // Publish intermediate solution, for example...
+            int* memberships = ring.beginPublish();
+            for (int i = 0; i < data.N; i++)
+                memberships[i] = (int) cp.getValue(x[i]);
+            ring.commitPublish(cp.getObjValue(), cp.getTime());
         }
 
+        writer.stop(); // Write solutions still in the ring before final print
+
 
         /*
          * Final print.
@@ -0,0 +1,88 @@
+/*
+ * Cannot-link constraints as adjacency lists, for use inside the WCSS constraints.
+ * Refer to CannotLinkGraph.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <cassert>
+
+#include "CannotLinkGraph.h"
+
+
+void CannotLinkGraph::build(const Data& data, IlcInt n) {
+    _n = n;
+    offsets.assign(_n + 1, 0);
+    partners.clear();
+
+    mark.assign(_n, 0);
+    stamp = 0;
+
+    if (data.nbCannotLinks == 0)
+        return;
+
+    // Counting sort of both directions of each pair
+    for (int l = 0; l < data.nbCannotLinks; l++) {
+        IlcInt a = data.cannotLinks[2*l], b = data.cannotLinks[2*l + 1];
+        assert(a >= 0 && a < _n && b >= 0 && b < _n && a != b); // A point can't be cannot-linked to itself
+        offsets[a + 1]++;
+        offsets[b + 1]++;
+    }
+
+    for (IlcInt i = 0; i < _n; i++)
+        offsets[i + 1] += offsets[i];
+
+    partners.resize(offsets[_n]);
+    std::vector<IlcInt> next(offsets.begin(), offsets.end() - 1);
+    for (int l = 0; l < data.nbCannotLinks; l++) {
+        IlcInt a = data.cannotLinks[2*l], b = data.cannotLinks[2*l + 1];
+        partners[next[a]++] = b;
+        partners[next[b]++] = a;
+    }
+
+    worklist.reserve(_n);
+}
+
+
+IlcInt CannotLinkGraph::propagate(IlcIntVarArray X, DomainSnapshot& domains) {
+    if (isEmpty())
+        return 0;
+
+    IlcInt nbRemoved = 0;
+
+    worklist.clear();
+    for (IlcInt i = 0; i < _n; i++)
+        if (hasPartners(i) && domains.isFixed(i))
+            worklist.push_back(i);
+
+    while (!worklist.empty()) {
+        IlcInt i = worklist.back();
+        worklist.pop_back();
+
+        const IlcInt c = domains.getValue(i);
+        for (const IlcInt* j = beginPartners(i); j != endPartners(i); ++j) {
+            if (!domains.isInDomain(*j, c))
+                continue;
+
+            if (domains.getSize(*j) == 1)
+                return -1; // Both in c
+
+            X[*j].removeValue(c);
+            domains.removeValue(*j, c);
+            nbRemoved++;
+
+            if (domains.getSize(*j) == 1) // Newly fixed, its own partners are affected
+                worklist.push_back(*j);
+        }
+    }
+
+    return nbRemoved;
+}
+
+
+void CannotLinkGraph::markPartners(IlcInt i) {
+    stamp++;
+    for (const IlcInt* j = beginPartners(i); j != endPartners(i); ++j)
+        mark[*j] = stamp;
+}
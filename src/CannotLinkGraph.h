@@ -0,0 +1,67 @@
+/*
+ * Cannot-link constraints (see Data::cannotLinks) as adjacency lists, for use inside the WCSS constraints.
+ * Cannot-links are propagated by the WCSS constraints themselves rather than posted as separate != constraints,
+ *     so that their bounds account for them:
+ *     * a free point cannot-linked to a point fixed in cluster c loses c (its s2 contribution to c becomes infinite),
+ *     * a free point never counts its cannot-linked companions among the m closest points it could share a cluster
+ *       with (s3), and
+ *     * two cannot-linked points fixed in the same cluster fail.
+ * The engine doesn't wake a constraint up on its own removals. When the cost-based filtering of a constraint fixes a point
+ *     which has cannot-links, the partners of that point are only updated at the next propagation, so the constraint
+ *     push()es itself.
+ * Must-links (Data::mustLinks) are neither propagated nor checked by the WCSS constraints and IloMSSCSearchStrategy, which
+ *     assert there are none. Contract them first with MustLinkContraction and post the constraints on the contracted
+ *     instance, as MSSCSolver does.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __CANNOT_LINK_GRAPH_H
+#define __CANNOT_LINK_GRAPH_H
+
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+class CannotLinkGraph {
+protected:
+    IlcInt _n;
+    std::vector<IlcInt> offsets; // Partners of i are partners[offsets[i]..offsets[i+1]-1]
+    std::vector<IlcInt> partners;
+
+    std::vector<IlcInt> worklist; // Working buffer of propagate
+    std::vector<IlcInt> mark; // Working buffer of markPartners, mark[j] == stamp means j is a partner of the marked point
+    IlcInt stamp;
+
+public:
+    CannotLinkGraph() : _n(0), stamp(0) {}
+
+    // Builds adjacency lists for the n observations of data
+    void build(const Data& data, IlcInt n);
+
+    bool isEmpty() const { return partners.empty(); }
+    bool hasPartners(IlcInt i) const { return offsets[i + 1] > offsets[i]; }
+
+    const IlcInt* beginPartners(IlcInt i) const { return partners.data() + offsets[i]; }
+    const IlcInt* endPartners(IlcInt i) const { return partners.data() + offsets[i + 1]; }
+
+    // Removes from every free point the clusters of the fixed points it is cannot-linked to, until fixpoint
+    //     (points fixed in the process propagate in turn). Removals are mirrored in domains.
+    //     Returns the number of values removed, or -1 if two cannot-linked points are (or would be) in the same cluster.
+    IlcInt propagate(IlcIntVarArray X, DomainSnapshot& domains);
+
+    // After markPartners(i), isMarked(j) tells whether j is cannot-linked to i in O(1)
+    void markPartners(IlcInt i);
+    bool isMarked(IlcInt j) const { return mark[j] == stamp; }
+};
+
+#endif // !__CANNOT_LINK_GRAPH_H
@@ -0,0 +1,143 @@
+/*
+ * Coordinate-space lower bound on the WCSS, for use inside the card-control constraints.
+ * Refer to CentroidBound.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "CentroidBound.h"
+
+
+// Beyond this many features, the centroid region is too loose to be worth its evaluation
+#define __CENTROID_MAX_FEATURES 8
+
+// Tolerated disagreement between dissimilarities and squared distances of coordinates, relative to the largest dissimilarity
+//     (Data built by MustLinkContraction recovers distances between centroids by differences of sums)
+#define __CENTROID_AGREEMENT_TOLERANCE 1e-6
+
+
+static IlcFloat squaredDistanceToBox(const IlcFloat* x, const std::vector<IlcFloat>& low, const std::vector<IlcFloat>& high) {
+    IlcFloat d = 0;
+    for (size_t f = 0; f < low.size(); f++) {
+        if (x[f] < low[f])
+            d += (low[f] - x[f])*(low[f] - x[f]);
+        else if (x[f] > high[f])
+            d += (x[f] - high[f])*(x[f] - high[f]);
+    }
+
+    return d;
+}
+
+
+void CentroidBound::build(const Data& data, IlcInt n, const PropagationParameters* parameters) {
+    _n = n;
+    _s = data.S;
+    enabled = false;
+    coordinates.clear();
+
+    if (parameters == NULL || !parameters->centroidBound || data.coordinates == NULL || _s <= 0 || _s > __CENTROID_MAX_FEATURES)
+        return;
+
+    coordinates.resize(_n*(size_t) _s);
+    for (IlcInt i = 0; i < _n; i++)
+        for (IlcInt f = 0; f < _s; f++)
+            coordinates[i*_s + f] = data.coordinates[i][f];
+
+    // The bound only holds if dissimilarities are the squared distances between coordinates
+    IlcFloat largest = 0;
+    for (IlcInt i = 0; i < _n - 1; i++)
+        for (IlcInt j = i + 1; j < _n; j++)
+            largest = std::max(largest, (IlcFloat) data.dissimilarities[i][j]);
+
+    const IlcFloat tolerance = __CENTROID_AGREEMENT_TOLERANCE*std::max(largest, (IlcFloat) 1);
+    for (IlcInt i = 0; i < _n - 1; i++) {
+        for (IlcInt j = i + 1; j < _n; j++) {
+            IlcFloat d = 0;
+            for (IlcInt f = 0; f < _s; f++)
+                d += (coordinates[i*_s + f] - coordinates[j*_s + f])*(coordinates[i*_s + f] - coordinates[j*_s + f]);
+
+            if (std::fabs(d - data.dissimilarities[i][j]) > tolerance) {
+                coordinates.clear();
+                return;
+            }
+        }
+    }
+
+    mean.assign(_s, 0);
+    low.assign(_s, 0);
+    high.assign(_s, 0);
+    enabled = true;
+}
+
+
+IlcFloat CentroidBound::compute(const std::vector<IlcInt>* setP, const IlcInt* setU, IlcInt nbU, const DomainSnapshot& domains,
+                                IlcIntArray targets, IlcIntArray nbToAdd, const ObservationWeights& weights) {
+    IlcFloat lb = 0;
+
+    for (IlcInt c = 0; c < targets.getSize(); c++) {
+        const std::vector<IlcInt>& members = setP[c];
+
+        // Mean of the fixed units
+        IlcInt m = 0;
+        std::fill(mean.begin(), mean.end(), 0);
+        for (size_t j = 0; j < members.size(); j++) {
+            m += weights[members[j]];
+            for (IlcInt f = 0; f < _s; f++)
+                mean[f] += weights[members[j]]*coordinates[members[j]*_s + f];
+        }
+        if (m > 0)
+            for (IlcInt f = 0; f < _s; f++)
+                mean[f] /= m;
+
+        // Sum of squares of the fixed units around their mean, exact if c is full
+        for (size_t j = 0; j < members.size(); j++) {
+            IlcFloat d = 0;
+            for (IlcInt f = 0; f < _s; f++)
+                d += (coordinates[members[j]*_s + f] - mean[f])*(coordinates[members[j]*_s + f] - mean[f]);
+            lb += weights[members[j]]*d;
+        }
+
+        const IlcInt nb = nbToAdd[c];
+        if (nb == 0)
+            continue;
+
+        candidates.clear();
+        for (IlcInt i = 0; i < nbU; i++)
+            if (domains.isInDomain(setU[i], c))
+                candidates.push_back(setU[i]);
+
+        // Centroid region: along each feature, the added units bring between the sums of their nb smallest and nb largest values
+        for (IlcInt f = 0; f < _s; f++) {
+            entries.clear();
+            for (size_t a = 0; a < candidates.size(); a++)
+                entries.push_back(WeightedContribution(coordinates[candidates[a]*_s + f], weights[candidates[a]]));
+
+            const IlcFloat smallest = ObservationWeights::sumSmallestUnits(entries, nb);
+            if (smallest == IlcInfinity)
+                return IlcInfinity; // Not enough candidates to complete c
+
+            for (size_t e = 0; e < entries.size(); e++)
+                entries[e].first = -entries[e].first;
+            const IlcFloat largest = -ObservationWeights::sumSmallestUnits(entries, nb);
+
+            low[f] = (m*mean[f] + smallest) / targets[c];
+            high[f] = (m*mean[f] + largest) / targets[c];
+        }
+
+        // Fixed units, their sum of squares around the centroid z is that around their mean plus m ||mean - z||^2
+        if (m > 0)
+            lb += m*squaredDistanceToBox(mean.data(), low, high);
+
+        // Cheapest added units
+        entries.clear();
+        for (size_t a = 0; a < candidates.size(); a++)
+            entries.push_back(WeightedContribution(squaredDistanceToBox(&coordinates[candidates[a]*_s], low, high), weights[candidates[a]]));
+        lb += ObservationWeights::sumSmallestUnits(entries, nb);
+    }
+
+    return lb;
+}
@@ -0,0 +1,69 @@
+/*
+ * Coordinate-space lower bound on the WCSS, for use inside the card-control constraints alongside their bounds on dissimilarities.
+ * The final centroid z of a cluster c is pinned by its fixed members P (m units, mean mu): z = (m mu + sum of the added units) / T,
+ *     where the nb = T - m added units are taken among the free points which may still join c. Along each feature, the mean of
+ *     the added units lies between the mean of the nb smallest and the mean of the nb largest candidate units, so that z lies in
+ *     a box B (the centroid region), which shrinks towards mu as c fills up. Since the WCSS of c is the sum of squared distances
+ *     of its units to z, it is at least
+ *         SS(P) + m dist(mu, B)^2 + sum of the nb smallest dist(x, B)^2 among the candidate units x
+ *     and the bound is the sum of these over clusters. Cannot-links are ignored, and a free point may be counted in several clusters.
+ * This holds for squared euclidean distances only: the bound is enabled if PropagationParameters::centroidBound is set and
+ *     Data::coordinates is given, has few enough features for the box to be informative, and agrees with Data::dissimilarities
+ *     (eg. it doesn't for a user-defined matrix).
+ * Points of weight w are w units at the same location (see ObservationWeights.h).
+ * Cost: the agreement check is O(n^2 S) when the constraint is built, for n points and S features, which is as much as reading
+ *     the dissimilarity matrix once more. Then O(k S q log q) per evaluation for q free points.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __CENTROID_BOUND_H
+#define __CENTROID_BOUND_H
+
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Observation weights
+#include "ObservationWeights.h"
+
+// The bound is enabled through the propagation parameters
+#include "PropagationSchedule.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+class CentroidBound {
+protected:
+    IlcInt _n, _s; // nb of points, nb of features
+    bool enabled;
+
+    std::vector<IlcFloat> coordinates; // coordinates[i*_s + f], row-major copy of Data::coordinates
+
+    // Working buffers of compute
+    std::vector<IlcFloat> mean;
+    std::vector<IlcFloat> low, high; // Centroid region
+    std::vector<IlcInt> candidates;
+    std::vector<WeightedContribution> entries;
+
+public:
+    CentroidBound() : _n(0), _s(0), enabled(false) {}
+
+    // Coordinates of the n observations of data, if the bound is enabled and applies to data. parameters may be NULL (disabled)
+    void build(const Data& data, IlcInt n, const PropagationParameters* parameters);
+
+    bool isEnabled() const { return enabled; }
+
+    // Lower bound on the WCSS of the clustering completing setP[c] (fixed points of c) with nbToAdd[c] units among the free points
+    //     setU[0..nbU-1] which have c in their domain, up to targets[c] units. Returns IlcInfinity if some cluster can't be completed.
+    IlcFloat compute(const std::vector<IlcInt>* setP, const IlcInt* setU, IlcInt nbU, const DomainSnapshot& domains,
+                     IlcIntArray targets, IlcIntArray nbToAdd, const ObservationWeights& weights);
+};
+
+#endif // !__CENTROID_BOUND_H
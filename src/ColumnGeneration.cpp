@@ -0,0 +1,404 @@
+/*
+ * Root bound for cardinality-constrained MSSC by column generation.
+ * Refer to ColumnGeneration.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "ColumnGeneration.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CPLEX Optimizer through Concert Technology
+#include <ilcplex/ilocplex.h>
+
+
+// Pricing seeds per target and iteration, taken by decreasing dual per unit
+#define __COLUMN_GENERATION_SEEDS 32
+
+// Columns of reduced cost above -tolerance are not worth adding
+#define __COLUMN_GENERATION_REDUCED_COST_TOLERANCE 1e-6
+
+// Subgradient steps on the Lagrangian bound after the last LP, halving the step after each one without improvement
+#define __COLUMN_GENERATION_ASCENT_STEPS 50
+
+
+static const double infinity = std::numeric_limits<double>::infinity();
+
+
+ColumnGeneration::ColumnGeneration(const Data& data) :
+_data(data), _n(data.N), bound(0), lpValue(infinity), objective(infinity) {
+    assert(isSupported(data));
+
+    weights.assign(_n, 1);
+    if (data.weights != NULL)
+        weights.assign(data.weights, data.weights + _n);
+
+    for (int c = 0; c < data.K; c++) {
+        const size_t t = std::find(sizes.begin(), sizes.end(), data.targetCardinalities[c]) - sizes.begin();
+        if (t == sizes.size()) {
+            sizes.push_back(data.targetCardinalities[c]);
+            counts.push_back(0);
+        }
+        counts[t]++;
+    }
+
+    cannotLinkPartners.resize(_n);
+    for (int l = 0; l < data.nbCannotLinks; l++) {
+        cannotLinkPartners[data.cannotLinks[2*l]].push_back(data.cannotLinks[2*l + 1]);
+        cannotLinkPartners[data.cannotLinks[2*l + 1]].push_back(data.cannotLinks[2*l]);
+    }
+
+    // h_i(t): the t - 1 other units nearest to one unit of i, the w_i - 1 other units of i coming first at distance 0
+    const int nbSizes = (int) sizes.size();
+    halfContributions.assign(_n*(size_t) nbSizes, infinity);
+
+    std::vector<char> isPartner(_n, 0);
+    std::vector<std::pair<double, int> > nearest; // (dissimilarity, units)
+    for (int i = 0; i < _n; i++) {
+        for (size_t l = 0; l < cannotLinkPartners[i].size(); l++)
+            isPartner[cannotLinkPartners[i][l]] = 1;
+
+        nearest.clear();
+        nearest.push_back(std::make_pair(0.0, weights[i] - 1));
+        for (int j = 0; j < _n; j++)
+            if (j != i && !isPartner[j])
+                nearest.push_back(std::make_pair(data.dissimilarities[i][j], weights[j]));
+        std::sort(nearest.begin(), nearest.end());
+
+        for (int t = 0; t < nbSizes; t++) {
+            int needed = sizes[t] - 1;
+            double sum = 0;
+            for (size_t e = 0; e < nearest.size() && needed > 0; e++) {
+                const int taken = std::min(needed, nearest[e].second);
+                sum += taken*nearest[e].first;
+                needed -= taken;
+            }
+
+            if (needed == 0 && weights[i] <= sizes[t])
+                halfContributions[i*(size_t) nbSizes + t] = sum / (2.0*sizes[t]);
+        }
+
+        for (size_t l = 0; l < cannotLinkPartners[i].size(); l++)
+            isPartner[cannotLinkPartners[i][l]] = 0;
+    }
+}
+
+
+void ColumnGeneration::addPartition(const int* partition) {
+    std::vector<std::vector<int> > clusters(_data.K);
+    std::vector<int> load(_data.K, 0);
+    for (int i = 0; i < _n; i++) {
+        if (partition[i] < 0 || partition[i] >= _data.K)
+            return;
+        clusters[partition[i]].push_back(i);
+        load[partition[i]] += weights[i];
+    }
+    for (int l = 0; l < _data.nbCannotLinks; l++)
+        if (partition[_data.cannotLinks[2*l]] == partition[_data.cannotLinks[2*l + 1]])
+            return;
+
+    std::vector<Column> pending;
+    for (int c = 0; c < _data.K; c++) {
+        if (load[c] != _data.targetCardinalities[c])
+            return;
+
+        Column column;
+        column.members = clusters[c];
+        column.size = (int) (std::find(sizes.begin(), sizes.end(), load[c]) - sizes.begin());
+        column.cost = 0;
+        for (size_t a = 0; a + 1 < column.members.size(); a++)
+            for (size_t b = a + 1; b < column.members.size(); b++)
+                column.cost += weights[column.members[a]]*(double) weights[column.members[b]]*_data.dissimilarities[column.members[a]][column.members[b]];
+        column.cost /= load[c];
+        addColumn(column, pending);
+    }
+
+    columns.insert(columns.end(), pending.begin(), pending.end());
+
+    double cost = 0;
+    for (int c = 0; c < _data.K; c++) {
+        double within = 0;
+        for (size_t a = 0; a + 1 < clusters[c].size(); a++)
+            for (size_t b = a + 1; b < clusters[c].size(); b++)
+                within += weights[clusters[c][a]]*(double) weights[clusters[c][b]]*_data.dissimilarities[clusters[c][a]][clusters[c][b]];
+        cost += within / load[c];
+    }
+    if (cost < objective) {
+        memberships.assign(partition, partition + _n);
+        objective = cost;
+    }
+}
+
+
+bool ColumnGeneration::addColumn(Column& column, std::vector<Column>& pending) {
+    std::sort(column.members.begin(), column.members.end());
+    if (!known.insert(column.members).second)
+        return false;
+
+    pending.push_back(column);
+    return true;
+}
+
+
+double ColumnGeneration::evaluate(const std::vector<double>& pi, std::vector<double>& subgradient) const {
+    const int nbSizes = (int) sizes.size();
+
+    double L = 0;
+    for (int i = 0; i < _n; i++) {
+        L += pi[i];
+        subgradient[i] = 1;
+    }
+
+    // P_t: cheapest t units at their per unit value, a point may be taken in part
+    std::vector<std::pair<double, int> > values(_n);
+    for (int t = 0; t < nbSizes; t++) {
+        for (int i = 0; i < _n; i++)
+            values[i] = std::make_pair(halfContributions[i*(size_t) nbSizes + t] - pi[i] / weights[i], i);
+        std::sort(values.begin(), values.end());
+
+        int needed = sizes[t];
+        for (int e = 0; e < _n && needed > 0; e++) {
+            const int i = values[e].second;
+            if (values[e].first == infinity)
+                return infinity; // No cluster of t units at all
+            const int taken = std::min(needed, weights[i]);
+            L += counts[t]*taken*values[e].first;
+            subgradient[i] -= counts[t]*(taken / (double) weights[i]);
+            needed -= taken;
+        }
+        if (needed > 0)
+            return infinity;
+    }
+
+    return L;
+}
+
+
+int ColumnGeneration::price(const std::vector<double>& pi, const std::vector<double>& sigma, std::vector<Column>& pending) {
+    const size_t before = pending.size();
+
+    std::vector<std::pair<double, int> > seeds(_n);
+    for (int i = 0; i < _n; i++)
+        seeds[i] = std::make_pair(-pi[i] / weights[i], i);
+    std::sort(seeds.begin(), seeds.end());
+
+    std::vector<double> pull(_n); // pull[j] = sum of dissimilarities between one unit of j and the units of the column
+    std::vector<int> blocked(_n); // blocked[j] > 0 if j is in the column or cannot-linked to one of its points
+
+    for (size_t t = 0; t < sizes.size(); t++) {
+        const int size = sizes[t];
+
+        for (int s = 0; s < std::min(_n, __COLUMN_GENERATION_SEEDS); s++) {
+            const int seed = seeds[s].second;
+            if (weights[seed] > size)
+                continue;
+
+            Column column;
+            column.size = (int) t;
+            column.members.push_back(seed);
+            int units = weights[seed];
+            double within = 0; // Sum of dissimilarities between units of the column
+            double dual = pi[seed];
+
+            std::fill(blocked.begin(), blocked.end(), 0);
+            blocked[seed] = 1;
+            for (size_t l = 0; l < cannotLinkPartners[seed].size(); l++)
+                blocked[cannotLinkPartners[seed][l]]++;
+            for (int j = 0; j < _n; j++)
+                pull[j] = weights[seed]*_data.dissimilarities[seed][j];
+
+            while (units < size) {
+                int best = -1;
+                double bestIncrease = infinity;
+                for (int j = 0; j < _n; j++) {
+                    if (blocked[j] || units + weights[j] > size)
+                        continue;
+                    const double increase = weights[j]*pull[j] / size - pi[j];
+                    if (increase < bestIncrease) {
+                        bestIncrease = increase;
+                        best = j;
+                    }
+                }
+
+                if (best < 0)
+                    break; // Stuck, no point fits
+
+                column.members.push_back(best);
+                units += weights[best];
+                within += weights[best]*pull[best];
+                dual += pi[best];
+
+                blocked[best] = 1;
+                for (size_t l = 0; l < cannotLinkPartners[best].size(); l++)
+                    blocked[cannotLinkPartners[best][l]]++;
+                for (int j = 0; j < _n; j++)
+                    pull[j] += weights[best]*_data.dissimilarities[best][j];
+            }
+
+            column.cost = within / size;
+            if (units == size && column.cost - dual - sigma[t] < -__COLUMN_GENERATION_REDUCED_COST_TOLERANCE)
+                addColumn(column, pending);
+        }
+    }
+
+    return (int) (pending.size() - before);
+}
+
+
+void ColumnGeneration::run(int maxIterations, double mipTimeLimit, const std::function<bool()>& isStopRequested) {
+    const int nbSizes = (int) sizes.size();
+
+    std::vector<double> pi(_n, 0.0), sigma(nbSizes, 0.0), bestPi(_n, 0.0), subgradient(_n);
+    bound = std::max(bound, evaluate(pi, subgradient));
+
+    IloEnv env;
+    try {
+        // Artificial columns cost more than any partition
+        double artificialCost = 1;
+        for (int i = 0; i < _n - 1; i++)
+            for (int j = i + 1; j < _n; j++)
+                artificialCost += weights[i]*(double) weights[j]*_data.dissimilarities[i][j];
+
+        IloModel master(env);
+        IloObjective wcss = IloAdd(master, IloMinimize(env));
+        IloRangeArray pointRows = IloAdd(master, IloRangeArray(env, _n, 1, 1));
+        IloRangeArray sizeRows(env);
+        for (int t = 0; t < nbSizes; t++)
+            sizeRows.add(IloRange(env, counts[t], counts[t]));
+        master.add(sizeRows);
+
+        IloNumVarArray artificials(env);
+        for (int i = 0; i < _n; i++)
+            artificials.add(IloNumVar(wcss(artificialCost) + pointRows[i](1)));
+        for (int t = 0; t < nbSizes; t++)
+            artificials.add(IloNumVar(wcss(artificialCost) + sizeRows[t](1)));
+
+        IloNumVarArray y(env);
+        size_t nbInMaster = 0;
+        std::vector<Column> pending;
+
+        IloCplex cplex(master);
+        cplex.setOut(env.getNullStream());
+        cplex.setWarning(env.getNullStream());
+
+        // Columns not in the master yet
+        auto extend = [&]() {
+            for (; nbInMaster < columns.size(); nbInMaster++) {
+                const Column& column = columns[nbInMaster];
+                IloNumColumn entries = wcss(column.cost) + sizeRows[column.size](1);
+                for (size_t a = 0; a < column.members.size(); a++)
+                    entries += pointRows[column.members[a]](1);
+                y.add(IloNumVar(entries));
+                entries.end();
+            }
+        };
+
+        IloNumArray duals(env);
+        for (int iteration = 0; iteration < maxIterations; iteration++) {
+            if (isStopRequested && isStopRequested())
+                break;
+
+            extend();
+            if (!cplex.solve())
+                break;
+            lpValue = cplex.getObjValue();
+
+            cplex.getDuals(duals, pointRows);
+            for (int i = 0; i < _n; i++)
+                pi[i] = duals[i];
+            cplex.getDuals(duals, sizeRows);
+            for (int t = 0; t < nbSizes; t++)
+                sigma[t] = duals[t];
+
+            const double L = evaluate(pi, subgradient);
+            if (L > bound) {
+                bound = L;
+                bestPi = pi;
+            }
+            if (bound >= lpValue - __COLUMN_GENERATION_REDUCED_COST_TOLERANCE*std::max(1.0, std::fabs(lpValue)))
+                break; // The restricted LP is optimal
+
+            pending.clear();
+            if (price(pi, sigma, pending) == 0)
+                break;
+            columns.insert(columns.end(), pending.begin(), pending.end());
+        }
+
+        // Subgradient ascent from the best duals, aimed at the last LP value (which L can't exceed)
+        if (lpValue < infinity) {
+            pi = bestPi;
+            double L = evaluate(pi, subgradient), theta = 1;
+            for (int step = 0; step < __COLUMN_GENERATION_ASCENT_STEPS && L < lpValue && !(isStopRequested && isStopRequested()); step++) {
+                double norm = 0;
+                for (int i = 0; i < _n; i++)
+                    norm += subgradient[i]*subgradient[i];
+                if (norm == 0)
+                    break; // pi maximizes L
+
+                const double length = theta*(lpValue - L) / norm;
+                for (int i = 0; i < _n; i++)
+                    pi[i] += length*subgradient[i];
+
+                const double next = evaluate(pi, subgradient);
+                if (next > bound) {
+                    bound = next;
+                    bestPi = pi;
+                }
+                else {
+                    theta /= 2;
+                }
+                L = next;
+            }
+        }
+
+        // Best partition over the generated columns
+        extend();
+
+        if (mipTimeLimit > 0 && y.getSize() > 0 && !(isStopRequested && isStopRequested())) {
+            for (IloInt a = 0; a < artificials.getSize(); a++)
+                artificials[a].setUB(0);
+            master.add(IloConversion(env, y, ILOINT));
+            cplex.setParam(IloCplex::Param::TimeLimit, mipTimeLimit);
+
+            if (cplex.solve()) {
+                IloNumArray values(env);
+                cplex.getValues(values, y);
+
+                // Clusters of each target in order, for the columns of that target
+                std::vector<std::vector<int> > labels(nbSizes);
+                for (int c = _data.K - 1; c >= 0; c--)
+                    labels[std::find(sizes.begin(), sizes.end(), _data.targetCardinalities[c]) - sizes.begin()].push_back(c);
+
+                std::vector<int> partition(_n, -1);
+                double cost = 0;
+                for (IloInt a = 0; a < y.getSize(); a++) {
+                    if (values[a] < 0.5)
+                        continue;
+                    const Column& column = columns[a];
+                    const int c = labels[column.size].back();
+                    labels[column.size].pop_back();
+                    for (size_t m = 0; m < column.members.size(); m++)
+                        partition[column.members[m]] = c;
+                    cost += column.cost;
+                }
+
+                if (cost < objective) { // The MIP may stop on its time limit with a worse partition than one given
+                    memberships = partition;
+                    objective = cost;
+                }
+            }
+        }
+    }
+    catch (...) {
+        env.end(); // Concert Technology objects are not released when going out of scope
+        throw;
+    }
+
+    env.end();
+}
@@ -0,0 +1,99 @@
+/*
+ * Root bound for cardinality-constrained Minimum Sum of Squares Clustering (MSSC) from the set-partitioning formulation,
+ *     solved by column generation as in the work of Babaki et al. (2014), see README.
+ * Master problem: one column per candidate cluster S (a set of points totalling t units, t a target cardinality), of cost WCSS(S)
+ *     min sum of cost(S) y_S  s.t.  sum over S containing i of y_S = 1 for every point i (duals pi),
+ *                                   sum over S of t units of y_S = n_t, the number of clusters of target t (duals sigma),   y >= 0.
+ *     Its LP relaxation, restricted to the columns generated so far, is solved by CPLEX (Concert Technology). Artificial columns
+ *     of prohibitive cost keep it feasible from the start.
+ * Pricing: for each target t, points of largest pi are taken in turn as seeds of a greedy, which adds the point of smallest increase of
+ *     reduced cost until t units are reached (skipping cannot-linked points). Every column of negative reduced cost is added.
+ * Bound: heuristic pricing can't prove the LP optimal, so the bound is that of the Lagrangian relaxation of the point rows, valid for any pi:
+ *     L(pi) = sum_i pi_i + sum_t n_t P_t(pi), where P_t(pi) <= min over S of t units of cost(S) - pi(S)
+ *     is the sum of the t smallest per unit values h_i(t) - pi_i / w_i, h_i(t) being the smallest 1/(2t) sum of dissimilarities between
+ *     one unit of i and t - 1 other units (the s3 of IlcWCSS_StandardCardControl). L is evaluated at the duals of every LP, then improved
+ *     by subgradient steps aimed at the value of the last LP. L(0) is the bound of IlcWCSS_StandardCardControl with no point fixed.
+ * Solution: the restricted master is finally solved as a MIP over the generated columns, within a time limit. The best of its solution
+ *     and the partitions given to addPartition is kept.
+ *
+ * Supported instances: target cardinalities set. Weights are units (a point of weight w brings w units to its column). Cannot-links are
+ *     respected by generated columns and ignored by the bound. Must-links must have been contracted (see MustLinkContraction.h).
+ *
+ * Main arguments: * data, refer to Data struct in Data.h for problem data nomenclature. Must outlive the object.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __COLUMN_GENERATION_H
+#define __COLUMN_GENERATION_H
+
+#include <functional>
+#include <set>
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+
+class ColumnGeneration {
+protected:
+    const Data& _data;
+    int _n;
+
+    // Targets, grouped by value
+    std::vector<int> sizes; // Distinct target cardinalities
+    std::vector<int> counts; // counts[t] = nb of clusters of target sizes[t]
+    std::vector<int> weights;
+    std::vector<std::vector<int> > cannotLinkPartners;
+
+    std::vector<double> halfContributions; // halfContributions[i*nbSizes + t] = h_i(sizes[t]), infinity if i can't reach sizes[t] units
+
+    // Columns
+    struct Column {
+        std::vector<int> members; // Sorted
+        int size; // Index in sizes
+        double cost;
+    };
+    std::vector<Column> columns;
+    std::set<std::vector<int> > known;
+
+    double bound, lpValue;
+    std::vector<int> memberships; // Best partition found over the columns, empty if none
+    double objective;
+
+    // Lagrangian bound at pi, fills the subgradient
+    double evaluate(const std::vector<double>& pi, std::vector<double>& subgradient) const;
+
+    // Greedy pricing at (pi, sigma), returns the number of columns added to pending
+    int price(const std::vector<double>& pi, const std::vector<double>& sigma, std::vector<Column>& pending);
+
+    bool addColumn(Column& column, std::vector<Column>& pending); // Returns false if already known
+
+public:
+    ColumnGeneration(const Data& data);
+
+    ColumnGeneration(const ColumnGeneration&) = delete;
+    ColumnGeneration& operator=(const ColumnGeneration&) = delete;
+
+    static bool isSupported(const Data& data) { return data.targetCardinalities != NULL; }
+
+    // Add the clusters of a partition as initial columns, eg. Data::memberships (ignored if it doesn't match the targets or
+    //     the cannot-links). It also becomes the best partition if it is better than the previous one.
+    void addPartition(const int* partition);
+
+    // At most maxIterations LP resolutions, then the MIP within mipTimeLimit seconds (skipped if <= 0).
+    //     isStopRequested, if set, is polled between LP resolutions and ascent steps: once it returns true, the bound
+    //     reached so far is kept and the MIP is skipped.
+    void run(int maxIterations, double mipTimeLimit, const std::function<bool()>& isStopRequested = std::function<bool()>());
+
+    double getBound() const { return bound; } // Lower bound on the WCSS, 0 before run
+    double getLPValue() const { return lpValue; } // Value of the last restricted LP, an upper bound on the LP relaxation
+    size_t getNbColumns() const { return columns.size(); }
+
+    bool hasSolution() const { return !memberships.empty(); }
+    double getObjective() const { return objective; }
+    const std::vector<int>& getMemberships() const { return memberships; } // memberships[i] = cluster of point i, meets the targets
+};
+
+#endif // !__COLUMN_GENERATION_H
@@ -6,6 +6,7 @@
 #ifndef __DATA_H
 #define __DATA_H
 
+#include <cstddef>
 #include <string>
 
 
@@ -25,6 +26,21 @@ struct Data {
     int* memberships;
     // Target class cardinalities (K-element array of non-zero integers, must agree with N and memberships above)
     int* targetCardinalities;
+
+    // Observation weights (N-element array of positive integers), NULL means every observation counts once
+    //     Observation i stands for weights[i] identical observations (eg. duplicates, coreset or pre-aggregated points):
+    //     the WCSS and cardinalities, target cardinalities included, are then counted in these units.
+    int* weights;
+
+    // Must-link constraints (2*nbMustLinks-element array): observations mustLinks[2l] and mustLinks[2l+1] belong to the same class
+    int nbMustLinks;
+    int* mustLinks;
+    // Cannot-link constraints (2*nbCannotLinks-element array): observations cannotLinks[2l] and cannotLinks[2l+1] belong to different classes
+    int nbCannotLinks;
+    int* cannotLinks;
+
+    Data() : N(0), S(0), K(0), coordinates(NULL), dissimilarities(NULL), memberships(NULL), targetCardinalities(NULL), weights(NULL),
+             nbMustLinks(0), mustLinks(NULL), nbCannotLinks(0), cannotLinks(NULL) {}
 };
 
 #endif // !__DATA_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*
+ * Packed bitset snapshot of the domains of the representative variables X.
+ * Refer to DomainSnapshot.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include "DomainSnapshot.h"
+
+
+void DomainSnapshot::resize(IlcInt n, IlcInt k) {
+    _n = n;
+    _k = k;
+    _w = (k + 63) >> 6;
+    _words.assign(_n*_w, 0);
+}
+
+
+void DomainSnapshot::take(IlcIntVarArray X) {
+    for (IlcInt i = 0; i < _n; i++) {
+        DomainWord* words = &_words[i*_w];
+        for (IlcInt b = 0; b < _w; b++)
+            words[b] = 0;
+
+        if (X[i].isFixed()) { // Most common case deep in the tree, a single engine call
+            IlcInt c = X[i].getValue();
+            words[c >> 6] = ((DomainWord) 1) << (c & 63);
+        }
+        else {
+            for (IlcIntExpIterator iter(X[i]); iter.ok(); ++iter) {
+                IlcInt c = *iter;
+                words[c >> 6] |= ((DomainWord) 1) << (c & 63);
+            }
+        }
+    }
+}
+
+
+IlcInt DomainSnapshot::countCandidates(IlcInt c, const IlcInt* vars, IlcInt nbVars) const {
+    const IlcInt b = c >> 6;
+    const IlcInt shift = c & 63;
+
+    // Branch-free so the compiler can vectorize the gather-and-add
+    IlcInt count = 0;
+    for (IlcInt i = 0; i < nbVars; i++)
+        count += (IlcInt) ((_words[vars[i]*_w + b] >> shift) & 1);
+
+    return count;
+}
+
+
+void DomainSnapshot::countCandidates(IlcInt* counts, const IlcInt* vars, IlcInt nbVars) const {
+    for (IlcInt c = 0; c < _k; c++)
+        counts[c] = 0;
+
+    for (IlcInt i = 0; i < nbVars; i++) {
+        const DomainWord* words = &_words[vars[i]*_w];
+        for (IlcInt b = 0; b < _w; b++) {
+            DomainWord w = words[b];
+            while (w != 0) { // Only visit set bits, domains shrink quickly during search
+                counts[(b << 6) + domainWordLowestBit(w)]++;
+                w &= w - 1;
+            }
+        }
+    }
+}
+
+
+IlcInt DomainSnapshot::removeValues(IlcIntVarArray X, const DomainWord* mask, const IlcInt* vars, IlcInt nbVars) {
+    IlcInt nbNewlyFixed = 0;
+
+    for (IlcInt i = 0; i < nbVars; i++) {
+        DomainWord* words = &_words[vars[i]*_w];
+
+        // Cheap test first, most variables are not concerned
+        bool concerned = false;
+        bool emptied = true;
+        for (IlcInt b = 0; b < _w; b++) {
+            concerned = concerned || ((words[b] & mask[b]) != 0);
+            emptied = emptied && ((words[b] & ~mask[b]) == 0);
+        }
+
+        if (!concerned)
+            continue;
+
+        if (emptied)
+            return -1;
+
+        // Mirror removals in the engine, one call per value actually removed
+        for (IlcInt b = 0; b < _w; b++) {
+            DomainWord toRemove = words[b] & mask[b];
+            words[b] &= ~mask[b];
+
+            while (toRemove != 0) {
+                X[vars[i]].removeValue((b << 6) + domainWordLowestBit(toRemove));
+                toRemove &= toRemove - 1;
+            }
+        }
+
+        if (getSize(vars[i]) == 1)
+            nbNewlyFixed++;
+    }
+
+    return nbNewlyFixed;
+}
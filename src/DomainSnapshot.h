@@ -0,0 +1,94 @@
+/*
+ * Packed bitset snapshot of the domains of the representative variables X.
+ * A snapshot is taken once per propagation (or branching decision) so that subsequent domain tests,
+ *     per-cluster candidate counts and "cluster full" removals are plain bit operations over a flat array
+ *     instead of one virtual engine call per (point, cluster) pair.
+ *
+ * Each variable's domain is stored on W = ceil(K/64) consecutive 64-bit words (bit c set means c is in the domain).
+ *     For the common case K <= 64, W = 1 and the whole snapshot is a packed N-word array.
+ *
+ * Note: a snapshot does NOT follow the engine. Any value removed from X after the snapshot was taken
+ *       must also be removed from the snapshot (see removeValue) to keep both consistent.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __DOMAIN_SNAPSHOT_H
+#define __DOMAIN_SNAPSHOT_H
+
+#include <vector>
+
+// Packed domain words
+#include "DomainWord.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+class DomainSnapshot {
+protected:
+    IlcInt _n, _k; // nb of variables, nb of values (clusters)
+    IlcInt _w; // nb of words per variable
+    std::vector<DomainWord> _words; // _words[i*_w + (c >> 6)] bit (c & 63) set means c is in domain of var i
+
+public:
+    DomainSnapshot() : _n(0), _k(0), _w(0) {}
+    DomainSnapshot(IlcInt n, IlcInt k) { resize(n, k); }
+
+    void resize(IlcInt n, IlcInt k);
+
+    // Read domains of all variables of X (the only engine calls made by the snapshot)
+    void take(IlcIntVarArray X);
+
+    IlcInt getNbVars() const { return _n; }
+    IlcInt getNbValues() const { return _k; }
+    IlcInt getNbWordsPerVar() const { return _w; }
+    const DomainWord* getWords(IlcInt i) const { return &_words[i*_w]; }
+
+    bool isInDomain(IlcInt i, IlcInt c) const {
+        return ((_words[i*_w + (c >> 6)] >> (c & 63)) & 1) != 0;
+    }
+
+    IlcInt getSize(IlcInt i) const {
+        if (_w == 1)
+            return domainWordPopCount(_words[i]);
+
+        IlcInt size = 0;
+        for (IlcInt b = 0; b < _w; b++)
+            size += domainWordPopCount(_words[i*_w + b]);
+        return size;
+    }
+
+    bool isFixed(IlcInt i) const {
+        return getSize(i) == 1;
+    }
+
+    // Smallest value in domain of var i (ie the value of var i when it is fixed), -1 if domain is empty
+    IlcInt getMin(IlcInt i) const {
+        for (IlcInt b = 0; b < _w; b++)
+            if (_words[i*_w + b] != 0)
+                return (b << 6) + domainWordLowestBit(_words[i*_w + b]);
+        return -1;
+    }
+
+    IlcInt getValue(IlcInt i) const { return getMin(i); }
+
+    // Mirror in the snapshot a removal already operated (or about to be operated) on the engine variable
+    void removeValue(IlcInt i, IlcInt c) {
+        _words[i*_w + (c >> 6)] &= ~(((DomainWord) 1) << (c & 63));
+    }
+
+    // Number of variables among vars[0..nbVars-1] with c in their domain
+    IlcInt countCandidates(IlcInt c, const IlcInt* vars, IlcInt nbVars) const;
+
+    // counts[c] = number of variables among vars[0..nbVars-1] with c in their domain, for all c at once
+    void countCandidates(IlcInt* counts, const IlcInt* vars, IlcInt nbVars) const;
+
+    // Remove values whose bit is set in mask (W words) from every variable among vars[0..nbVars-1], both in snapshot and engine.
+    //     Returns the number of variables that became fixed as a result (caller is expected to update its sets),
+    //     or -1 if a domain would be emptied, in which case nothing is removed from that variable and the caller must fail.
+    IlcInt removeValues(IlcIntVarArray X, const DomainWord* mask, const IlcInt* vars, IlcInt nbVars);
+};
+
+#endif // !__DOMAIN_SNAPSHOT_H
@@ -0,0 +1,42 @@
+/*
+ * 64-bit words of packed domain bitsets (bit c set means value c is in the domain) and the bit operations on them.
+ *     Shared by DomainSnapshot (CP Optimizer variables) and MSSCBranchAndBound (standalone engine), hence independent of CP Optimizer.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __DOMAIN_WORD_H
+#define __DOMAIN_WORD_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+typedef std::uint64_t DomainWord;
+
+
+// Number of bits set in w
+inline int domainWordPopCount(DomainWord w) {
+#if defined(_MSC_VER)
+    return (int) __popcnt64(w);
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+// Index of lowest bit set in w (w must be non-zero)
+inline int domainWordLowestBit(DomainWord w) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, w);
+    return (int) index;
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+#endif // !__DOMAIN_WORD_H
@@ -0,0 +1,226 @@
+/*
+ * Exhaustive completion of small residual subproblems.
+ * Refer to EndgameSolver.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "EndgameSolver.h"
+
+
+static const double infinity = std::numeric_limits<double>::infinity();
+
+
+// Weight of observation i, see Data::weights
+static inline int getWeight(const Data& data, int i) {
+    return (data.weights != NULL) ? data.weights[i] : 1;
+}
+
+
+class Endgame {
+public:
+    const Data& data;
+    const bool valuePrecedence;
+    int q, k;
+
+    std::vector<int> freePoints; // In index order
+    std::vector<int> remaining; // Units still to add to each cluster
+    std::vector<double> cost; // cost[r*k + c] = cost of the r-th free point in c given the fixed points, infinity if not in domain
+    std::vector<double> restBound; // restBound[r] = sum of the cheapest cost of free points r..q-1
+    std::vector<std::vector<int> > earlierPartners; // Cannot-linked free points of smaller rank
+
+    // Value precedence holds within chains of clusters of equal target cardinality, chainOf[c] being the chain of c and
+    //     rankOf[c] its rank in it (clusters are ranked by index).
+    std::vector<int> chainOf, rankOf;
+    int nbChains;
+
+    // Value precedence: fixed points between free points r-1 and r (segment r) are valid iff at least need[r*nbChains + g]
+    //     clusters of each chain g appeared before them, after which at least top[r*nbChains + g] clusters of it appeared.
+    //     Segment q follows the last free point.
+    std::vector<int> need, top;
+
+    // Search state
+    std::vector<int> appeared, savedAppeared; // Clusters of each chain which appeared so far, saved per depth
+    std::vector<int> assignment, best;
+    std::vector<std::vector<int> > members; // Free points (by rank) assigned to each cluster
+    double bestCost;
+    std::vector<std::pair<double, int> > choices; // Per depth buffer, q*k
+
+    Endgame(const DomainSnapshot& domains, const Data& data_, bool valuePrecedence_) :
+    data(data_), valuePrecedence(valuePrecedence_), q(0), k(data_.K), nbChains(0), bestCost(infinity) {
+        const int n = domains.getNbVars();
+
+        for (int i = 0; i < n; i++)
+            if (!domains.isFixed(i))
+                freePoints.push_back(i);
+        q = (int) freePoints.size();
+
+        remaining.assign(data.targetCardinalities, data.targetCardinalities + k);
+        for (int i = 0; i < n; i++)
+            if (domains.isFixed(i))
+                remaining[domains.getValue(i)] -= getWeight(data, i);
+
+        cost.assign(q*(size_t) k, infinity);
+        restBound.assign(q + 1, 0.0);
+        for (int r = 0; r < q; r++) {
+            const int i = freePoints[r];
+            std::vector<double> sums(k, 0.0);
+            for (int j = 0; j < n; j++)
+                if (domains.isFixed(j))
+                    sums[domains.getValue(j)] += getWeight(data, j)*data.dissimilarities[i][j];
+
+            for (int c = 0; c < k; c++)
+                if (domains.isInDomain(i, c))
+                    cost[r*k + c] = getWeight(data, i)*sums[c] / data.targetCardinalities[c];
+        }
+        for (int r = q - 1; r >= 0; r--)
+            restBound[r] = restBound[r + 1] + *std::min_element(cost.begin() + r*k, cost.begin() + (r + 1)*k);
+
+        earlierPartners.resize(q);
+        if (data.nbCannotLinks > 0) {
+            std::vector<int> rank(n, -1);
+            for (int r = 0; r < q; r++)
+                rank[freePoints[r]] = r;
+
+            for (int l = 0; l < data.nbCannotLinks; l++) {
+                const int a = rank[data.cannotLinks[2*l]], b = rank[data.cannotLinks[2*l + 1]];
+                if (a >= 0 && b >= 0)
+                    earlierPartners[std::max(a, b)].push_back(std::min(a, b));
+            }
+        }
+
+        chainOf.assign(k, -1);
+        rankOf.assign(k, 0);
+        for (int c = 0; c < k; c++) {
+            for (int c2 = c - 1; c2 >= 0 && chainOf[c] < 0; c2--)
+                if (data.targetCardinalities[c2] == data.targetCardinalities[c]) {
+                    chainOf[c] = chainOf[c2];
+                    rankOf[c] = rankOf[c2] + 1;
+                }
+            if (chainOf[c] < 0)
+                chainOf[c] = nbChains++;
+        }
+
+        need.assign((q + 1)*(size_t) nbChains, 0);
+        top.assign((q + 1)*(size_t) nbChains, 0);
+        if (valuePrecedence) {
+            int segment = 0;
+            std::vector<int> prefixTop(nbChains, 0);
+            for (int i = 0; i < n; i++) {
+                if (!domains.isFixed(i)) {
+                    segment++;
+                    std::fill(prefixTop.begin(), prefixTop.end(), 0);
+                    continue;
+                }
+
+                // Valid if the value already appeared or is the next one of its chain, given what appeared before the segment
+                const int v = domains.getValue(i), g = chainOf[v], t = rankOf[v];
+                if (t > prefixTop[g])
+                    need[segment*nbChains + g] = std::max(need[segment*nbChains + g], t);
+                prefixTop[g] = std::max(prefixTop[g], t + 1);
+                top[segment*nbChains + g] = std::max(top[segment*nbChains + g], t + 1);
+            }
+        }
+        appeared.assign(nbChains, 0);
+        savedAppeared.resize((q + 1)*(size_t) nbChains);
+
+        assignment.assign(q, -1);
+        members.resize(k);
+        choices.resize(q*(size_t) k);
+    }
+
+    void search(int r, double partial) {
+        if (!valuePrecedence) {
+            branch(r, partial);
+            return;
+        }
+
+        for (int g = 0; g < nbChains; g++)
+            if (appeared[g] < need[r*nbChains + g])
+                return;
+
+        int* saved = &savedAppeared[r*(size_t) nbChains];
+        for (int g = 0; g < nbChains; g++) {
+            saved[g] = appeared[g];
+            appeared[g] = std::max(appeared[g], top[r*nbChains + g]);
+        }
+        branch(r, partial);
+        std::copy(saved, saved + nbChains, appeared.begin());
+    }
+
+    void branch(int r, double partial) {
+        if (r == q) {
+            if (partial < bestCost) {
+                bestCost = partial;
+                best = assignment;
+            }
+            return;
+        }
+
+        if (partial + restBound[r] >= bestCost)
+            return;
+
+        const int i = freePoints[r];
+        const int w = getWeight(data, i);
+
+        // Candidate clusters with their incremental cost, cheapest first
+        std::pair<double, int>* candidates = &choices[r*(size_t) k];
+        int nbCandidates = 0;
+        for (int c = 0; c < k; c++) {
+            if (cost[r*k + c] == infinity || remaining[c] < w || (valuePrecedence && rankOf[c] > appeared[chainOf[c]]))
+                continue;
+
+            bool linked = false;
+            for (int s : earlierPartners[r])
+                linked = linked || (assignment[s] == c);
+            if (linked)
+                continue;
+
+            double delta = 0;
+            for (int s : members[c])
+                delta += getWeight(data, freePoints[s])*data.dissimilarities[i][freePoints[s]];
+            candidates[nbCandidates++] = std::make_pair(cost[r*k + c] + w*delta / data.targetCardinalities[c], c);
+        }
+        std::sort(candidates, candidates + nbCandidates);
+
+        for (int t = 0; t < nbCandidates; t++) {
+            const int c = candidates[t].second, before = appeared[chainOf[c]];
+
+            assignment[r] = c;
+            remaining[c] -= w;
+            members[c].push_back(r);
+            appeared[chainOf[c]] = std::max(before, rankOf[c] + 1);
+
+            search(r + 1, partial + candidates[t].first);
+
+            appeared[chainOf[c]] = before;
+            members[c].pop_back();
+            remaining[c] += w;
+            assignment[r] = -1;
+        }
+    }
+};
+
+
+bool solveEndgame(const DomainSnapshot& domains, const Data& data, bool valuePrecedence, int* completion) {
+    Endgame endgame(domains, data, valuePrecedence);
+
+    // Overfilled clusters, or units left over: nothing to search
+    for (int c = 0; c < data.K; c++)
+        if (endgame.remaining[c] < 0)
+            return false;
+
+    endgame.search(0, 0);
+    if (endgame.bestCost == infinity)
+        return false;
+
+    for (int r = 0; r < endgame.q; r++)
+        completion[endgame.freePoints[r]] = endgame.best[r];
+
+    return true;
+}
@@ -0,0 +1,36 @@
+/*
+ * Exhaustive completion of small residual subproblems, used by the search goal (see IlcMSSCSearchStrategy.h) once few
+ *     points are free: near the leaves, goal allocation, binary branching and full propagation of the WCSS constraint at
+ *     every node cost far more than the work left.
+ *
+ * With cardinalities fixed to their targets, the WCSS is sum over c of S[c] / T[c] with constant T[c], so assigning a
+ *     free point to a cluster adds a known amount given the points already there: w_i * (sum of w_j * d_ij over
+ *     j in c) / T[c]. Free points are assigned in index order by a depth-first branch-and-bound which maintains these
+ *     sums incrementally, tries the cheapest clusters first, and prunes with the sum over the remaining free points of
+ *     their cheapest assignment to the fixed points alone (dissimilarities are non-negative).
+ *
+ * Completions respect the domains, the remaining cardinality of each cluster (in units, see Data::weights), cannot-links
+ *     between free points (those with fixed points are already reflected in domains) and, if requested, the value
+ *     precedence posted by MSSCSolver for symmetry breaking: each cluster after the previous one of equal target
+ *     cardinality, over the whole array.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __ENDGAME_SOLVER_H
+#define __ENDGAME_SOLVER_H
+
+// Problem data structure
+#include "Data.h"
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+
+// Best completion of the free variables of domains, data must have target cardinalities.
+//     Fills completion[i] for every free i (other entries are left untouched) and returns true, or returns false if no
+//     completion satisfies the constraints above. The number of free points should be small (exponential search).
+bool solveEndgame(const DomainSnapshot& domains, const Data& data, bool valuePrecedence, int* completion);
+
+#endif // !__ENDGAME_SOLVER_H
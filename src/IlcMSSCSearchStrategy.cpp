@@ -27,21 +27,27 @@
 #include "IlcMSSCSearchStrategy.h"
 
 
+// Weight of observation i, weights may be NULL (see Data::weights)
+static inline int getWeight(const int* weights, IlcInt i) {
+    return (weights != NULL) ? weights[i] : 1;
+}
+
+
 // Computes the delta objective when pt is assigned to cluster c
-int getDeltaObjective(IlcIntVarArray vars, IlcInt pt, IlcInt c, double const* const* const dissimilarities) {
+int getDeltaObjective(const DomainSnapshot& domains, IlcInt pt, IlcInt c, double const* const* const dissimilarities, const int* weights) {
     double S1 = 0, S2 = 0;
     int card_cluster = 0;
 
-    // Compute S1 WCSD for cluster c, S2 contribution of pt to c
-    for (int i = 0; i < vars.getSize(); i++) {
-        if (vars[i].isFixed() && (vars[i].getValue() == c)) {
-            card_cluster++; // We found a point in c
+    // Compute S1 WCSD for cluster c, S2 contribution of pt to c (between units)
+    for (int i = 0; i < domains.getNbVars(); i++) {
+        if (domains.isFixed(i) && (domains.getValue(i) == c)) {
+            card_cluster += getWeight(weights, i); // We found a point in c
 
-            for (int j = i + 1; j < vars.getSize(); j++)
-                if (vars[j].isFixed() && (vars[j].getValue() == c))
-                    S1 += dissimilarities[i][j]; // we found a point in the same cluster so we add the distance between'em
+            for (int j = i + 1; j < domains.getNbVars(); j++)
+                if (domains.isFixed(j) && (domains.getValue(j) == c))
+                    S1 += getWeight(weights, i)*getWeight(weights, j)*dissimilarities[i][j]; // we found a point in the same cluster so we add the distance between'em
 
-            S2 += dissimilarities[i][pt]; // we add the distance between the point in c and candidate pt
+            S2 += getWeight(weights, i)*dissimilarities[i][pt]; // we add the distance between the point in c and candidate pt
         }
     }
 
@@ -49,18 +55,18 @@ int getDeltaObjective(IlcIntVarArray vars, IlcInt pt, IlcInt c, double const* co
         return 0; // Assigning point to empty cluster has 0 cost
 
     // Multiply by 1000 for precision.
-    return (int) (((S1 + S2) / (card_cluster + 1) - S1 / card_cluster) * 1000);
+    return (int) (((S1 + getWeight(weights, pt)*S2) / (card_cluster + getWeight(weights, pt)) - S1 / card_cluster) * 1000);
 }
 
 
 // Computes total SS between pt and all points in U.
-int getUnboundPointsTotalSS(IlcIntVarArray vars, IlcInt pt, double const* const* const dissimilarities) {
+int getUnboundPointsTotalSS(const DomainSnapshot& domains, IlcInt pt, double const* const* const dissimilarities, const int* weights) {
     // Init total distance between pt and all points
     double total_dist = 0;
 
-    for (int i = 0; i < vars.getSize(); i++)
-        if (!vars[i].isFixed())
-            total_dist += dissimilarities[i][pt];
+    for (int i = 0; i < domains.getNbVars(); i++)
+        if (!domains.isFixed(i))
+            total_dist += getWeight(weights, i)*dissimilarities[i][pt];
 
     return (int) (total_dist * 100);
 }
@@ -74,12 +80,54 @@ inline int getIntDist(IlcInt i, IlcInt j, double const* const* const dissimilari
 
 // Strategy as a goal to be given to CP Optimizer engine
 ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const SearchParameters&, searchParameters, const bool&, solFound) {
+    /*
+     * Cooperative cancellation: checked once per branching decision, failing prunes the whole remaining tree
+     */
+
+    if (searchParameters.control != NULL && searchParameters.control->isCancelRequested())
+        fail();
+
+
     /*
      * Initializations
      */
 
     IlcBool found = IlcFalse; // Check if a choice can be made. Otherwise, end of search for current solution reached
 
+    // Domains are only read through this snapshot below, one pass of engine calls per decision
+    SearchBuffers localBuffers;
+    SearchBuffers& buffers = (searchParameters.buffers != NULL) ? *searchParameters.buffers : localBuffers;
+    DomainSnapshot& domains = buffers.domains;
+    if (domains.getNbVars() != vars.getSize() || domains.getNbValues() != data.K)
+        domains.resize(vars.getSize(), data.K);
+    domains.take(vars);
+
+    /*
+     * Endgame: few free variables left, complete the node optimally in one step instead of branching
+     *     NOTE: skipped while following indicated memberships, which must be reproduced as given.
+     */
+
+    if (searchParameters.endgameThreshold > 0 && data.targetCardinalities != NULL
+        && (solFound || searchParameters.initialSolution != CustomCPSearchOptions::InitialSolution::MEMBERSHIPS_AS_INDICATED)) {
+        IlcInt nbFree = 0;
+        for (IlcInt i = 0; i < domains.getNbVars() && nbFree <= searchParameters.endgameThreshold; i++)
+            if (!domains.isFixed(i))
+                nbFree++;
+
+        if (nbFree > 0 && nbFree <= searchParameters.endgameThreshold) {
+            std::vector<int>& completion = buffers.completion;
+            completion.assign(domains.getNbVars(), -1);
+            if (!solveEndgame(domains, data, searchParameters.valuePrecedence, completion.data()))
+                fail();
+
+            for (IlcInt i = 0; i < domains.getNbVars(); i++)
+                if (!domains.isFixed(i))
+                    vars[i].setValue(completion[i]);
+
+            return 0;
+        }
+    }
+
     IlcInt bestI; // Chosen variable
     IlcInt bestJ; // Chosen value for variable
 
@@ -97,20 +145,21 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
             case CustomCPSearchOptions::InitialSolution::GREEDY_INIT: {
                 // find min size domain
                 int minimum_domain_size = __MAX_INT;
-                for (IlcInt i = 0; i < vars.getSize(); i++)
-                    if (!vars[i].isFixed() && vars[i].getSize() < minimum_domain_size)
-                        minimum_domain_size = vars[i].getSize();
+                for (IlcInt i = 0; i < domains.getNbVars(); i++)
+                    if (!domains.isFixed(i) && domains.getSize(i) < minimum_domain_size)
+                        minimum_domain_size = domains.getSize(i);
 
                 min_contrib_loco = __MAX_INT;
 
-                for (IlcInt i = 0; i < vars.getSize(); i++) {
-                    if (!vars[i].isFixed() && vars[i].getSize() == minimum_domain_size) {
+                for (IlcInt i = 0; i < domains.getNbVars(); i++) {
+                    if (!domains.isFixed(i) && domains.getSize(i) == minimum_domain_size) {
                         found = IlcTrue;
 
-                        for (IlcIntExpIterator iter(vars[i]); iter.ok(); ++iter) {
-                            IlcInt j = *iter;
+                        for (IlcInt j = 0; j < data.K; j++) {
+                            if (!domains.isInDomain(i, j))
+                                continue;
 
-                            int aggr = getDeltaObjective(vars, i, j, data.dissimilarities);
+                            int aggr = getDeltaObjective(domains, i, j, data.dissimilarities, data.weights);
 
                             if (aggr < min_contrib_loco) {
                                 min_contrib_loco = aggr;
@@ -125,8 +174,8 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
 
             case CustomCPSearchOptions::InitialSolution::MEMBERSHIPS_AS_INDICATED: {
                 // Choose unbound variable...
-                for (IlcInt i = 0; i < vars.getSize(); i++) {
-                    if (!vars[i].isFixed()) {
+                for (IlcInt i = 0; i < domains.getNbVars(); i++) {
+                    if (!domains.isFixed(i)) {
                         found = IlcTrue;
                         bestI = i;
                         break;
@@ -160,16 +209,17 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
     switch (searchParameters.mainSearch) {
         case CustomCPSearchOptions::MainSearch::MAX_MIN_VAR: {
             IlcInt bestinterimJ;
-            for (IlcInt i = 0; i < vars.getSize(); i++) {
-                if (!vars[i].isFixed()) {
+            for (IlcInt i = 0; i < domains.getNbVars(); i++) {
+                if (!domains.isFixed(i)) {
                     found = IlcTrue;
                     min_contrib_loco = __MAX_INT;
 
                     // Explore vars[i] domain
-                    for (IlcIntExpIterator iter(vars[i]); iter.ok(); ++iter) {
-                        IlcInt j = *iter;
+                    for (IlcInt j = 0; j < data.K; j++) {
+                        if (!domains.isInDomain(i, j))
+                            continue;
 
-                        int aggr = getDeltaObjective(vars, i, j, data.dissimilarities);
+                        int aggr = getDeltaObjective(domains, i, j, data.dissimilarities, data.weights);
 
                         if (aggr < min_contrib_loco) {
                             min_contrib_loco = aggr;
@@ -207,16 +257,16 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
         occupied_clusters.push_back(-1); // The back is always the highest occupied cluster index
         int sk_cluster_to_fill = -1; // Cluster selected to be filled for the tie-breaking
 
-        for (int i = 0; i < vars.getSize(); i++) {
-            if (vars[i].isFixed()) {
-                if ((vars[i].getValue() - occupied_clusters.back()) >= 2) { // Skipped cluster, we're done, we know what the next empty cluster is
+        for (int i = 0; i < domains.getNbVars(); i++) {
+            if (domains.isFixed(i)) {
+                if ((domains.getValue(i) - occupied_clusters.back()) >= 2) { // Skipped cluster, we're done, we know what the next empty cluster is
                     jump_happened = true;
                     sk_cluster_jump = occupied_clusters.back();
-                    occupied_clusters.push_back(vars[i].getValue());
+                    occupied_clusters.push_back(domains.getValue(i));
                     // Yet we don't break because occupied_clusters could be useful...
                 }
-                else if ((vars[i].getValue() - occupied_clusters.back()) == 1) {
-                    occupied_clusters.push_back(vars[i].getValue());
+                else if ((domains.getValue(i) - occupied_clusters.back()) == 1) {
+                    occupied_clusters.push_back(domains.getValue(i));
                 }
             }
         }
@@ -257,9 +307,9 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
                 int max_dist = 0;
 
                 // Look for farthest point
-                for (IlcInt i = 0; i < vars.getSize(); i++) {
-                    if (!vars[i].isFixed() && vars[i].isInDomain(sk_cluster_to_fill)) {
-                        comp_dist = getUnboundPointsTotalSS(vars, i, data.dissimilarities);
+                for (IlcInt i = 0; i < domains.getNbVars(); i++) {
+                    if (!domains.isFixed(i) && domains.isInDomain(i, sk_cluster_to_fill)) {
+                        comp_dist = getUnboundPointsTotalSS(domains, i, data.dissimilarities, data.weights);
 
                         // ...break tie with farthest point.
                         if (comp_dist > max_dist) {
@@ -277,10 +327,10 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
                 int max_dist = 0;
 
                 // Look for farthest point
-                for (int i = 0; i < vars.getSize(); i++) {
-                    if (!vars[i].isFixed() && vars[i].isInDomain(sk_cluster_to_fill)) {
-                        for (int j = 0; j < vars.getSize(); j++) {
-                            if (vars[j].isFixed() && getIntDist(i, j, data.dissimilarities) > max_dist) {
+                for (int i = 0; i < domains.getNbVars(); i++) {
+                    if (!domains.isFixed(i) && domains.isInDomain(i, sk_cluster_to_fill)) {
+                        for (int j = 0; j < domains.getNbVars(); j++) {
+                            if (domains.isFixed(j) && getIntDist(i, j, data.dissimilarities) > max_dist) {
                                 max_dist = getIntDist(i, j, data.dissimilarities);
                                 bestI = i;
                                 bestJ = sk_cluster_to_fill;
@@ -295,8 +345,8 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
             case CustomCPSearchOptions::TieHandling::FIXED_MAX_MIN: {
                 int max_dist_overall = 0;
                 int max_dist_overall_indexof = bestI;
-                for (int i = 0; i < vars.getSize(); i++) {
-                    if (!vars[i].isFixed() && vars[i].isInDomain(sk_cluster_to_fill)) { // getting [PT]Min
+                for (int i = 0; i < domains.getNbVars(); i++) {
+                    if (!domains.isFixed(i) && domains.isInDomain(i, sk_cluster_to_fill)) { // getting [PT]Min
                         int min_dist_to_all_clusters = __MAX_INT;
                         int min_dist_to_all_clusters_indexof;
 
@@ -305,8 +355,8 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
                             int min_dist_to_current_cluster = __MAX_INT;
                             int min_dist_to_current_cluster_indexof;
 
-                            for (int j = 0; j < vars.getSize(); j++) {
-                                if (vars[j].isFixed() && vars[j].getValue() == current_cluster && getIntDist(i, j, data.dissimilarities) < min_dist_to_current_cluster) {
+                            for (int j = 0; j < domains.getNbVars(); j++) {
+                                if (domains.isFixed(j) && domains.getValue(j) == current_cluster && getIntDist(i, j, data.dissimilarities) < min_dist_to_current_cluster) {
                                     min_dist_to_current_cluster = getIntDist(i, j, data.dissimilarities);
                                     min_dist_to_current_cluster_indexof = i;
                                 }
@@ -336,10 +386,10 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
                 for (int i = 0; i < data.K; i++)
                     cards[i] = 0;
 
-                // Determine cardinalities
-                for (int i = 0; i < vars.getSize(); i++)
-                    if (vars[i].isFixed())
-                        cards[vars[i].getValue()] += 1;
+                // Determine cardinalities (in units)
+                for (int i = 0; i < domains.getNbVars(); i++)
+                    if (domains.isFixed(i))
+                        cards[domains.getValue(i)] += getWeight(data.weights, i);
 
                 // Determine biggest cluster
                 int biggest_cluster_index; int biggest_card = 0;
@@ -365,10 +415,10 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
                 for (int i = 0; i < data.S; i++)
                     biggest_cluster_center[i] = 0;
 
-                for (int i = 0; i < vars.getSize(); i++) {
-                    if (vars[i].isFixed() && vars[i].getValue() == biggest_cluster_index) {
+                for (int i = 0; i < domains.getNbVars(); i++) {
+                    if (domains.isFixed(i) && domains.getValue(i) == biggest_cluster_index) {
                         for (int j = 0; j < data.S; j++) {
-                            biggest_cluster_center[j] += data.coordinates[i][j];
+                            biggest_cluster_center[j] += getWeight(data.weights, i)*data.coordinates[i][j];
                         }
                     }
                 }
@@ -378,13 +428,13 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
 
                 // Find farthest point
                 double biggest_distance = 0;
-                for (int i = 0; i < vars.getSize(); i++) {
+                for (int i = 0; i < domains.getNbVars(); i++) {
                     double temp_dist_pts = 0;
                     for (int j = 0; j < data.S; j++) {
                         temp_dist_pts += (biggest_cluster_center[j] - data.coordinates[i][j])*(biggest_cluster_center[j] - data.coordinates[i][j]);
                     }
 
-                    if (temp_dist_pts > biggest_distance && vars[i].isInDomain(sk_cluster_to_fill)) {
+                    if (temp_dist_pts > biggest_distance && domains.isInDomain(i, sk_cluster_to_fill)) {
                         biggest_distance = temp_dist_pts;
                         bestI = i;
                     }
@@ -402,10 +452,10 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
                 for (int i = 0; i < data.K; i++)
                     cards[i] = 0;
 
-                // Determine max occupied cluster and cardinalities
-                for (int i = 0; i < vars.getSize(); i++)
-                    if (vars[i].isFixed())
-                        cards[vars[i].getValue()] += 1;
+                // Determine max occupied cluster and cardinalities (in units)
+                for (int i = 0; i < domains.getNbVars(); i++)
+                    if (domains.isFixed(i))
+                        cards[domains.getValue(i)] += getWeight(data.weights, i);
 
                 // Determine center of clusters
                 double** cluster_center = new double*[data.K];
@@ -421,10 +471,10 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
 
                 for (std::vector<int>::iterator iter = occupied_clusters.begin(); iter != occupied_clusters.end(); iter++) {
                     int c = *iter;
-                    for (int i = 0; i < vars.getSize(); i++) {
-                        if (vars[i].isFixed() && vars[i].getValue() == c) {
+                    for (int i = 0; i < domains.getNbVars(); i++) {
+                        if (domains.isFixed(i) && domains.getValue(i) == c) {
                             for (int j = 0; j < data.S; j++) {
-                                cluster_center[c][j] += data.coordinates[i][j];
+                                cluster_center[c][j] += getWeight(data.weights, i)*data.coordinates[i][j];
                             }
                         }
                     }
@@ -438,8 +488,8 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
 
                 // Find farthest point to centers
                 double max_distance_global = 0;
-                for (int i = 0; i < vars.getSize(); i++) {
-                    if (!vars[i].isFixed() && vars[i].isInDomain(sk_cluster_to_fill)) {
+                for (int i = 0; i < domains.getNbVars(); i++) {
+                    if (!domains.isFixed(i) && domains.isInDomain(i, sk_cluster_to_fill)) {
                         double smallest_distance_local = std::numeric_limits<double>::infinity();
                         // for (int c = 0; c <= max_occupied_cluster; c++) {
                         for (std::vector<int>::iterator iter = occupied_clusters.begin(); iter != occupied_clusters.end(); iter++) {
@@ -495,5 +545,6 @@ ILCGOAL4(IlcMSSCSearchStrategy, IlcIntVarArray, vars, const Data&, data, const S
 
 // Macro which wraps the engine goal into a modeling layer (Concert Technology) object
 ILOCPGOALWRAPPER4(IloMSSCSearchStrategy, cp, IloIntVarArray, varso, const Data&, datao, const SearchParameters&, searchParameterso, const bool&, solFoundo) {
+    assert(datao.nbMustLinks == 0); // Must-links are ignored, the instance must be contracted first (see CannotLinkGraph.h)
     return IlcMSSCSearchStrategy(cp, cp.getIntVarArray(varso), datao, searchParameterso, solFoundo);
 }
\ No newline at end of file
@@ -11,6 +11,13 @@
  *                       * solFound, bool from scope where engine IloCP is instantiated.
  *                             Is set to true once a first solution has been found using the engine's IloCP::next method.
  *
+ * Cancellation is cooperative: if searchParameters.control is set and cancellation is requested through it (possibly from
+ *     another thread), every subsequent branching decision fails, which quickly exhausts the search tree.
+ *
+ * Endgame: if searchParameters.endgameThreshold is set, once at most that many variables are free the best completion
+ *     of the node is found by exhaustive search (refer to EndgameSolver.h) and assigned in a single step, the node fails
+ *     if there is none. Only valid if the model fixes cluster cardinalities to Data::targetCardinalities.
+ *
  * This search strategy uses elements from the work of:
  * Dao TBH., Duong KC., Vrain C. (2015) Constrained Minimum Sum of Squares Clustering by Constraint Programming.
  *     In: Pesant G. (eds) Principles and Practice of Constraint Programming. CP 2015.
@@ -28,12 +35,21 @@
 #include <algorithm>
 #include <vector>
 
+// Cancellation flag shared with other threads
+#include <atomic>
+
 // Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
 #include <ilcp/cpext.h>
 
 // Problem data structure
 #include "Data.h"
 
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Exhaustive completion of small residual subproblems
+#include "EndgameSolver.h"
+
 // Possible to use <limits> but eh...
 #define __MAX_INT 2147483647
 
@@ -66,10 +82,38 @@ namespace CustomCPSearchOptions {
 }
 
 
+// State shared between the search goal and the code driving the search, which may live on another thread
+struct SearchControl {
+    std::atomic<bool> cancelRequested; // Once set, every branching decision fails
+
+    SearchControl() : cancelRequested(false) {}
+
+    void cancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+    bool isCancelRequested() const { return cancelRequested.load(std::memory_order_relaxed); }
+};
+
+
+// Working buffers of the search goal, kept by the code driving the search and reused from one branching decision to the next
+//     instead of being allocated at each of them. A goal is done with them once it returns its subgoals, but engines searching
+//     concurrently must not share them.
+struct SearchBuffers {
+    DomainSnapshot domains;
+    std::vector<int> completion; // Endgame
+};
+
+
 struct SearchParameters {
     CustomCPSearchOptions::InitialSolution initialSolution;
     CustomCPSearchOptions::MainSearch mainSearch;
     CustomCPSearchOptions::TieHandling tieHandling;
+
+    SearchControl* control; // Optional (NULL by default), must outlive the search
+    SearchBuffers* buffers; // Optional (NULL by default, buffers are then allocated at each decision), must outlive the search
+
+    IlcInt endgameThreshold; // Largest number of free variables handed to the endgame solver, 0 (default) disables it
+    bool valuePrecedence; // Completions must keep each cluster after the previous one of equal target, as the model's symmetry breaking does
+
+    SearchParameters() : control(NULL), buffers(NULL), endgameThreshold(0), valuePrecedence(false) {}
 };
 
 #endif // !__SEARCH_T
@@ -77,6 +121,6 @@ struct SearchParameters {
 
 
 
-int getDeltaObjective(IlcIntVarArray vars, IlcInt pt, IlcInt c, double const* const* const dissimilarities);
-int getUnboundPointsTotalSS(IlcIntVarArray vars, IlcInt pt, double const* const* const dissimilarities);
+int getDeltaObjective(const DomainSnapshot& domains, IlcInt pt, IlcInt c, double const* const* const dissimilarities, const int* weights);
+int getUnboundPointsTotalSS(const DomainSnapshot& domains, IlcInt pt, double const* const* const dissimilarities, const int* weights);
 int getIntDist(IlcInt i, IlcInt j, double const* const* const dissimilarities);
\ No newline at end of file
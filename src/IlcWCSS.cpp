@@ -28,18 +28,34 @@
 #include "IlcWCSS.h"
 
 
-IlcWCSSI::IlcWCSSI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data) :
+IlcWCSSI::IlcWCSSI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) :
 IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.getSize()), _k(data.K) {
+    // Snapshot of domains of X, taken at the start of each propagation
+    domains.resize(_n, _k);
+
+    // Must-links are not propagated, the instance must be contracted first (see CannotLinkGraph.h)
+    assert(data.nbMustLinks == 0);
+
+    // Cannot-link constraints (see CannotLinkGraph.h for why they are propagated here)
+    cannotLinks.build(data, _n);
+
+    // Observation weights, sizes below are counted in units (a point of weight w is w units)
+    weights.build(data, _n);
+
+    // When to run the V_prime loop, adaptive if requested (see PropagationSchedule.h)
+    schedule.build(propagation, _n);
+    const IlcInt totalWeight = weights.getTotal();
+
     // sets of points and their sizes
     setP_assigned = new (cp.getHeap()) std::vector<IlcInt>[_k]; // setP_assigned[c] = i means point i is assigned to cluster c
 
     // size of each cluster c
     sizeCluster = IlcIntArray(cp, _k);
 
-    // lower bound of WCSS of each cluster c if we add m points to it
+    // lower bound of WCSS of each cluster c if we add m units to it
     lb_schedule = new (cp.getHeap()) IlcFloat*[_k];
     for (int i = 0; i < _k; i++)
-        lb_schedule[i] = new (cp.getHeap()) IlcFloat[_n + 1]; // lb_schedule[c][m] is lower bound on WCSS if m points assigned to c
+        lb_schedule[i] = new (cp.getHeap()) IlcFloat[totalWeight + 1]; // lb_schedule[c][m] is lower bound on WCSS if m units assigned to c
 
     // Sum of dissimilarities of each cluster c
     S1 = IlcFloatArray(cp, _k); // S1[c] = sum of dissimilarities (squared) of cluster c 
@@ -47,21 +63,21 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     // Sum of dissimilarities between each unassigned point and each cluster
     s2 = new (cp.getHeap()) IlcFloat*[_n]; // Allocation on engine heap for efficient and unified memory control
     for (int i = 0; i < _n; i++)
-        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between x and all points in cluster c
+        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between one unit of x and all units in cluster c
 
     // Smallest 1/2 contribution of each unassigned point together with m other points
-    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free points brought along in addition to x
+    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free units brought along in addition to one unit of x
 
-    // Array for dynamic prog for global lower bound computation, assign q points to clusters
+    // Array for dynamic prog for global lower bound computation, assign q points (qWeight units) to clusters
     lb_global = new (cp.getHeap()) IlcFloat*[_k];
     for (int i = 0; i < _k; i++)
-        lb_global[i] = new (cp.getHeap()) IlcFloat[_n + 1]; // lb_global[c][m] = lower bound on WCSS of c clusters if we assign m points to them
+        lb_global[i] = new (cp.getHeap()) IlcFloat[totalWeight + 1]; // lb_global[c][m] = lower bound on WCSS of c clusters if we assign m units to them
 
-    // lb_except[m] = lb if we add m points to clusters 0 through _k-1 except c
-    lb_except = IlcFloatArray(cp, _n);
+    // lb_except[m] = lb if we add m units to clusters 0 through _k-1 except c
+    lb_except = IlcFloatArray(cp, totalWeight);
 
-    // lb_prime[m] = lb on wcss of cluster c when we add m points + point i to it
-    lb_prime = IlcFloatArray(cp, _n);
+    // lb_prime[m] = lb on wcss of cluster c when we add m units + point i to it
+    lb_prime = IlcFloatArray(cp, totalWeight);
 
     // This espsilon is subtracted from the computed lower bound to prevent false backtracking while comparing with upper bound due to rounding errors
     _epsc = 5e-5;
@@ -87,11 +103,18 @@ void IlcWCSSI::propagate() {
         setP_assigned[i].clear();
     p = 0;
 
+    // One pass of engine calls, every subsequent domain test is done on the snapshot
+    domains.take(_X);
+
+    // Cannot-links: clusters of fixed points are removed from the free points they are cannot-linked to
+    if (cannotLinks.propagate(_X, domains) < 0)
+        fail(); // Two cannot-linked points in the same cluster
+
     // Populating sets
     for (int i = 0; i < _n; i++) {
-        if (_X[i].isFixed()) {
+        if (domains.isFixed(i)) {
             p++;
-            setP_assigned[_X[i].getValue()].push_back(i);
+            setP_assigned[domains.getValue(i)].push_back(i);
         }
         else {
             q++;
@@ -99,30 +122,32 @@ void IlcWCSSI::propagate() {
         }
     }
 
-    // Size of each cluster c
+    qWeight = weights.sum(setU_unassigned.data(), q);
+
+    // Size of each cluster c, in units
     for (int c = 0; c < _k; c++)
-        sizeCluster[c] = setP_assigned[c].size(); // sizeCluster[c] = m means c is size m
+        sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m
 
-    // Lower bound of WCSS of each cluster c if we add m points to it > INIT
+    // Lower bound of WCSS of each cluster c if we add m units to it > INIT
     for (int c = 0; c < _k; c++)
-        for (int m = 0; m <= q; m++)
-            lb_schedule[c][m] = 0; // lb_schedule[c][m] is lower bound on WCSS if m points assigned to c
+        for (int m = 0; m <= qWeight; m++)
+            lb_schedule[c][m] = 0; // lb_schedule[c][m] is lower bound on WCSS if m units assigned to c
 
-    // Sum of dissimilarities of each cluster c
+    // Sum of dissimilarities of each cluster c (between units)
     for (int c = 0; c < _k; c++) {
         S1[c] = 0;
-        for (int i = 0; i < sizeCluster[c] - 1; i++)
-            for (int j = i + 1; j < sizeCluster[c]; j++)
-                S1[c] += _dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
+        for (int i = 0; i < (IlcInt) setP_assigned[c].size() - 1; i++)
+            for (int j = i + 1; j < (IlcInt) setP_assigned[c].size(); j++)
+                S1[c] += weights[setP_assigned[c][i]]*weights[setP_assigned[c][j]]*_dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
     }
 
-    // Sum of dissimilarities between each unassigned point and each cluster
+    // Sum of dissimilarities between (one unit of) each unassigned point and each cluster
     for (int i = 0; i < q; i++) { // for each unassigned point
         for (int c = 0; c < _k; c++) { // for each cluster
-            if (_X[setU_unassigned[i]].isInDomain(c)) { // if unassigned point i can be assigned to cluster c
+            if (domains.isInDomain(setU_unassigned[i], c)) { // if unassigned point i can be assigned to cluster c
                 s2[i][c] = 0;
-                for (int j = 0; j < sizeCluster[c]; j++) { // for each point j in cluster c
-                    s2[i][c] += _dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
+                for (int j = 0; j < (IlcInt) setP_assigned[c].size(); j++) { // for each point j in cluster c
+                    s2[i][c] += weights[setP_assigned[c][j]]*_dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
                 }
             }
             else { // else, unassigned point i can't be part of cluster c, set to infinity to exclude
@@ -131,39 +156,26 @@ void IlcWCSSI::propagate() {
         }
     }
 
-    // Smallest 1/2 contribution of each unassigned point together with m other points
+    // Smallest 1/2 contribution of each unassigned point together with m other units
     for (int i = 0; i < q; i++) {
-        s3[i].clear();
-        for (int j = 0; j < q; j++) {
-            // At first, we put all points in that list
-            s3[i].push_back(_dissimilarities[setU_unassigned[i]][setU_unassigned[j]] / 2);
-        }
-
-        std::sort(s3[i].begin(), s3[i].end()); // sort distances for each point, first element 0 because d(x,x) = 0
-
-        for (int j = 1; j < q; j++)
-            s3[i][j] += s3[i][j - 1]; // Compute minimum 1/2 contributions, first element is 0
+        cannotLinks.markPartners(setU_unassigned[i]);
+        weights.fillHalfContributions(setU_unassigned[i], setU_unassigned.data(), q, _dissimilarities, cannotLinks, qWeight, s3[i]);
     }
 
     // Computing lower bound for each cluster
     for (int c = 0; c < _k; c++) { // for each cluster
-        for (int m = 0; m <= q; m++) { // if we add m points to c, m = 0 we add nothing, m = 1 we add only x, m = q we add x and all of the unassigned points remaining
-            std::vector<IlcFloat> s; // s of every point x with current m possibility << will be destroyed going out of scope
-            for (int i = 0; i < q; i++) { // contribution for each unassigned point
-                if (m > 0) {
+        for (int m = 0; m <= qWeight; m++) { // if we add m units to c, m = 0 we add nothing, m = 1 we add only x, m = qWeight we add all of the unassigned units remaining
+            IlcFloat S2 = 0;
+
+            if (m > 0) {
+                s.clear();
+                for (int i = 0; i < q; i++) { // contribution of each unit of each unassigned point
                     assert(s3[i][0] == 0);
-                    s.push_back(s2[i][c] + s3[i][m - 1]); // s3[i][m-1] = 0 for m = 1
+                    s.push_back(WeightedContribution(s2[i][c] + s3[i][m - 1], weights[setU_unassigned[i]])); // s3[i][m-1] = 0 for m = 1
                 }
-                else {
-                    s.push_back(0); // not adding anything, this is actually useless
-                }
-            }
 
-            std::sort(s.begin(), s.end()); // sorting candidate points...
-
-            IlcFloat S2 = 0;
-            for (int i = 0; i < m; i++) // ... of which we select the m points that induce the lowest cost
-                S2 += s[i];
+                S2 = ObservationWeights::sumSmallestUnits(s, m); // sorting candidate points, of which we select the m units that induce the lowest cost
+            }
 
             if (sizeCluster[c] + m > 0)
                 lb_schedule[c][m] = (S1[c] + S2) / (sizeCluster[c] + m);
@@ -173,11 +185,11 @@ void IlcWCSSI::propagate() {
     }
 
     // Dynamic prog for global lower bound, assign q points to clusters
-    for (int i = 0; i <= q; i++)
+    for (int i = 0; i <= qWeight; i++)
         lb_global[0][i] = lb_schedule[0][i]; // same because for both we assign points to one cluster, the cluster number 0
 
     for (int c = 1; c < _k; c++) {
-        for (int m = 0; m <= q; m++) {
+        for (int m = 0; m <= qWeight; m++) {
             lb_global[c][m] = IlcInfinity;
 
             for (int i = 0; i <= m; i++)
@@ -186,50 +198,74 @@ void IlcWCSSI::propagate() {
         }
     }
 
+    const IlcFloat ub_pruning = schedule.getPruningBound(_V.getMax());
+
     // Lower bound for all clusters
-    _V.setMin(lb_global[_k - 1][q] - _epsc);
+    if (lb_global[_k - 1][qWeight] - _epsc > ub_pruning)
+        fail();
+    _V.setMin(lb_global[_k - 1][qWeight] - _epsc);
+
+    // V_prime loop, unless delayed
+    if (!schedule.shouldFilter(p, lb_global[_k - 1][qWeight], ub_pruning))
+        return;
+    IlcInt nbRemovals = 0;
+
+    bool cannotLinkedVarWasFixed = false;
 
     for (int c = 0; c < _k; c++) { // for each value c in domains of points, ie for each cluster
-        for (int m = 0; m < q; m++) {
-            lb_except[m] = 0; // lb_except[m] = lb if we add m points to clusters 0 through _k-1 except c
+        for (int m = 0; m < qWeight; m++) {
+            lb_except[m] = 0; // lb_except[m] = lb if we add m units to clusters 0 through _k-1 except c
 
-            for (int j = m; j <= q; j++)
+            for (int j = m; j <= qWeight; j++)
                 if (lb_global[_k - 1][j] - lb_schedule[c][j - m] > lb_except[m])
                     lb_except[m] = lb_global[_k - 1][j] - lb_schedule[c][j - m];
         }
 
         for (int i = 0; i < q; i++) {
-            if (_X[setU_unassigned[i]].isInDomain(c)) { // for each i point in U such that c is in domain of Gi
-                for (int m = 0; m < q; m++)
-                    lb_prime[m] = ((sizeCluster[c] + m)*lb_schedule[c][m] + s2[i][c] + s3[i][m]) / (sizeCluster[c] + m + 1);
+            if (domains.isInDomain(setU_unassigned[i], c)) { // for each i point in U such that c is in domain of Gi
+                const IlcInt w = weights[setU_unassigned[i]]; // i brings w units along with m other units
+
+                for (int m = 0; m <= qWeight - w; m++)
+                    lb_prime[m] = ((sizeCluster[c] + m)*lb_schedule[c][m] + w*(s2[i][c] + s3[i][m + w - 1])) / (sizeCluster[c] + m + w);
 
                 IlcFloat V_prime = IlcInfinity;
 
                 // Find optimal updated WCSS
-                for (int m = 0; m < q; m++) {
-                    if (V_prime > (lb_except[q - 1 - m] + lb_prime[m]))
-                        V_prime = (lb_except[q - 1 - m] + lb_prime[m]);
+                for (int m = 0; m <= qWeight - w; m++) {
+                    if (V_prime > (lb_except[qWeight - w - m] + lb_prime[m]))
+                        V_prime = (lb_except[qWeight - w - m] + lb_prime[m]);
                 }
 
-                if (V_prime >= _V.getMax()) {
+                if (V_prime >= ub_pruning) {
                     _X[setU_unassigned[i]].removeValue(c);
+                    domains.removeValue(setU_unassigned[i], c);
+                    nbRemovals++;
+
+                    if (domains.getSize(setU_unassigned[i]) == 1 && cannotLinks.hasPartners(setU_unassigned[i]))
+                        cannotLinkedVarWasFixed = true;
                 }
             }
         }
     }
+
+    schedule.record(nbRemovals);
+
+    // Points fixed above have partners to update (see CannotLinkGraph.h)
+    if (cannotLinkedVarWasFixed)
+        push();
 }
 
 
 // Function which returns an engine handle (IlcConstraintI*) for the constraint implementation IlcWCSSI
-IlcConstraint IlcWCSS(IlcIntVarArray X, IlcFloatVar V, const Data& data) {
+IlcConstraint IlcWCSS(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) {
     IlcCPEngine cp = X.getCPEngine();
-    return new (cp.getHeap()) IlcWCSSI(cp, X, V, data);
+    return new (cp.getHeap()) IlcWCSSI(cp, X, V, data, propagation);
 }
 
 
 // Macro which wraps the engine constraint handle into a modeling layer (Concert Technology) extractable object
-ILOCPCONSTRAINTWRAPPER3(IloWCSS, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao) {
+ILOCPCONSTRAINTWRAPPER4(IloWCSS, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao, const PropagationParameters*, _propagationo) {
     use(cp, _Xo);
     use(cp, _Vo);
-    return IlcWCSS(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao);
+    return IlcWCSS(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao, _propagationo);
 }
\ No newline at end of file
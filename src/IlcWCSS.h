@@ -32,6 +32,18 @@
 // Problem data structure
 #include "Data.h"
 
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Cannot-link constraints
+#include "CannotLinkGraph.h"
+
+// Observation weights
+#include "ObservationWeights.h"
+
+// Scheduling of cost-based filtering
+#include "PropagationSchedule.h"
+
 // Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
 #include <ilcp/cpext.h>
 
@@ -48,11 +60,18 @@ protected:
 
     IlcInt _n, _k; // size of problem, nb of clusters
     IlcInt p, q; // size of sets P and U resp.
+    IlcInt qWeight; // total weight of set U (equal to q without weights)
 
     IlcIntVarArray _X; // Point assignments
     IlcFloatVar _V; // total WCSS
 
+    CannotLinkGraph cannotLinks;
+    ObservationWeights weights;
+    PropagationSchedule schedule;
+
     // In propagate
+    DomainSnapshot domains;
+
     std::vector<IlcInt> setU_unassigned;
     std::vector<IlcInt>* setP_assigned;
 
@@ -63,6 +82,7 @@ protected:
     IlcFloatArray S1;
     IlcFloat** s2;
     std::vector<IlcFloat>* s3;
+    std::vector<WeightedContribution> s;
 
     IlcFloat** lb_global;
 
@@ -72,7 +92,7 @@ protected:
     double _epsc;
 
 public:
-    IlcWCSSI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data);
+    IlcWCSSI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation);
     ~IlcWCSSI();
     virtual void propagate();
     virtual void post();
@@ -80,4 +100,4 @@ public:
 };
 
 
-IlcConstraint IlcWCSS(IlcIntVarArray X, IlcFloatVar V, const Data& data);
\ No newline at end of file
+IlcConstraint IlcWCSS(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation = NULL);
\ No newline at end of file
@@ -0,0 +1,392 @@
+/*
+ * Refer to IlcWCSS_LagrangianCardControl.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include "IlcWCSS_LagrangianCardControl.h"
+
+
+// Subgradient steps per propagation
+#define __LAGRANGIAN_ITERATIONS 8
+
+// Scale of the first (Polyak) step of each propagation, halved after every step which doesn't improve the bound
+#define __LAGRANGIAN_STEP 1.0
+
+
+IlcWCSS_LagrangianCardControlI::IlcWCSS_LagrangianCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) : 
+IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.getSize()), _k(data.K) {
+    // Populate _targetCards
+    _targetCards = IlcIntArray(cp, _k);
+    for (int c = 0; c < data.K; c++)
+        _targetCards[c] = data.targetCardinalities[c];
+
+    // Make sure everything's cute
+    assert(_targetCards.getSize() == _k); // number of indicated cards is same as clusters
+
+    // Observation weights, cardinalities are counted in units (a point of weight w is w units)
+    weights.build(data, _n);
+
+    // Coordinate-space bound on the objective, if enabled and coordinates are given (see CentroidBound.h)
+    centroids.build(data, _n, propagation);
+
+    // When to run the reduced-cost loop, adaptive if requested (see PropagationSchedule.h)
+    schedule.build(propagation, _n);
+
+    // Nogoods learned from bound failures, if requested (see NogoodStore.h)
+    nogoods.build(data, _n, propagation);
+
+    IlcInt ctrl_nb_pts = 0;
+    for (int c = 0; c < _k; c++)
+        ctrl_nb_pts += _targetCards[c];
+    assert(ctrl_nb_pts == weights.getTotal()); // number of indicated units is same as problem size
+
+    // Snapshot of domains of X, taken at the start of each propagation
+    domains.resize(_n, _k);
+
+    // Must-links are not propagated, the instance must be contracted first (see CannotLinkGraph.h)
+    assert(data.nbMustLinks == 0);
+
+    // Cannot-link constraints (see CannotLinkGraph.h for why they are propagated here)
+    cannotLinks.build(data, _n);
+
+    // Mask of clusters which are filled to their target cardinality
+    fullClusters.assign(domains.getNbWordsPerVar(), 0);
+
+    // Number of free units which can still join each cluster c
+    candidateCount.assign(_k, 0);
+
+    // sets of points and their sizes
+    setP_assigned = new (cp.getHeap()) std::vector<IlcInt>[_k]; // setP_assigned[c] = i means point i is assigned to cluster c
+
+    // size of each cluster c
+    sizeCluster = IlcIntArray(cp, _k);
+
+    // Sum of dissimilarities of each cluster c
+    S1 = IlcFloatArray(cp, _k); // S1[c] = sum of dissimilarities (squared) of cluster c 
+
+    // Sum of dissimilarities (squared) between each unassigned point and each cluster
+    s2 = new (cp.getHeap()) IlcFloat*[_n]; // Allocation on engine heap for efficient and unified memory control
+    for (int i = 0; i < _n; i++)
+        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between one unit of x and all units in cluster c
+
+    // Smallest 1/2 contribution of each unassigned point together with m other points
+    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free units brought along in addition to one unit of x
+
+    // Global lower bound
+    lb_global = 0;
+
+    // Number of units to add in cluster c to completion
+    nb_points_to_add = IlcIntArray(cp, _k);
+
+    // Lagrangian relaxation of the cardinality constraints of the flow, multipliers start at 0
+    arcCost.resize(_n*(size_t) _k);
+    multipliers.assign(_k, 0);
+    bestMultipliers.assign(_k, 0);
+    trialMultipliers.assign(_k, 0);
+    subgradient.assign(_k, 0);
+    cheapest.resize(_n);
+    bestCheapest.resize(_n);
+
+    // This espsilon is subtracted from the computed lower bound to prevent false backtracking while comparing with upper bound due to rounding errors
+    _epsc = 5e-5;
+}
+
+
+IlcWCSS_LagrangianCardControlI::~IlcWCSS_LagrangianCardControlI() {
+    // Any dynamically allocated elements are allocated in the engine heap which manages memory for us
+}
+
+
+void IlcWCSS_LagrangianCardControlI::post() {
+    for (int i = 0; i < _n; i++)
+        _X[i].whenDomain(this);
+    
+    _V.whenRange(this);
+}
+
+
+void IlcWCSS_LagrangianCardControlI::propagate() {
+    // Reset sets & number of points assigned and unassigned
+    setU_unassigned.clear(); q = 0;
+    for (int c = 0; c < _k; c++)
+        setP_assigned[c].clear();
+    p = 0;
+
+    // One pass of engine calls, every subsequent domain test is done on the snapshot
+    domains.take(_X);
+
+    // Populating sets and definition of partial problem
+    for (int i = 0; i < _n; i++) {
+        if (domains.isFixed(i)) {
+            p++;
+            setP_assigned[domains.getValue(i)].push_back(i);
+        }
+        else {
+            q++;
+            setU_unassigned.push_back(i);
+        }
+    }
+
+    // Size of each cluster c and how many points to add
+    max_clust_completion = 0; // Max number of points to add, all clusters considered
+    for (IlcInt c = 0; c < _k; c++) {
+        sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m (in units)
+        nb_points_to_add[c] = _targetCards[c] - sizeCluster[c];
+
+        if (nb_points_to_add[c] < 0) // Constraint is violated if a cluster is overfilled
+            fail(); // Backtrack
+
+        if (nb_points_to_add[c] > max_clust_completion)
+            max_clust_completion = nb_points_to_add[c]; // Update max_clust_completion
+    }
+
+    // Preliminary filtering: remove possibility to assign points to cluster c if full
+    // NOTE: This can be replaced with a GCC in the model only if there is a guarantee it would propagate before this constraint.
+    bool prelimFilteringVarWasFixed;
+    do {
+        // Nothing has yet changed entering this loop
+        prelimFilteringVarWasFixed = false;
+
+        // Cannot-links: clusters of fixed points are removed from the free points they are cannot-linked to
+        IlcInt nbCannotLinkRemovals = cannotLinks.propagate(_X, domains);
+        if (nbCannotLinkRemovals < 0)
+            fail(); // Two cannot-linked points in the same cluster
+
+        // Nogoods learned from earlier bound failures
+        IlcInt nbNogoodRemovals = nogoods.isEnabled() ? nogoods.propagate(_X, domains) : 0;
+        if (nbNogoodRemovals < 0)
+            fail(); // A partial assignment already known to fail
+
+        // Filter values if corresponding clusters are filled, all filled clusters at once
+        //     With weights, a cluster is also closed to the points heavier than what it has left to house
+        IlcInt nbNewlyFixed;
+        if (weights.isUnit()) {
+            for (IlcInt b = 0; b < (IlcInt) fullClusters.size(); b++)
+                fullClusters[b] = 0;
+            for (IlcInt c = 0; c < _k; c++)
+                if (nb_points_to_add[c] == 0)
+                    fullClusters[c >> 6] |= ((DomainWord) 1) << (c & 63);
+
+            nbNewlyFixed = domains.removeValues(_X, fullClusters.data(), setU_unassigned.data(), q); // Careful, a variable could get bound here, hence the whole reason this "do... while" exists in the first place
+        }
+        else {
+            nbNewlyFixed = weights.removeOversized(_X, domains, nb_points_to_add, setU_unassigned.data(), q);
+        }
+
+        if (nbNewlyFixed < 0)
+            fail(); // A point can't go anywhere
+
+        // If some variable was fixed, update sets and subproblem characteristics
+        if (nbNewlyFixed > 0 || nbCannotLinkRemovals > 0 || nbNogoodRemovals > 0) {
+            std::vector<IlcInt>::iterator setU_iter = setU_unassigned.begin();
+            while (setU_iter != setU_unassigned.end()) {
+                if (domains.isFixed(*setU_iter)) {
+                    prelimFilteringVarWasFixed = true;
+                    setP_assigned[domains.getValue(*setU_iter)].push_back(*setU_iter); p++;
+                    setU_iter = setU_unassigned.erase(setU_iter); q--;
+                } else {
+                    ++setU_iter;
+                }
+            }
+
+            // Size of each cluster c and how many points to add
+            max_clust_completion = 0; // max number of points to add all clusters considered
+            for (IlcInt c = 0; c < _k; c++) {
+                sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m (in units)
+                nb_points_to_add[c] = _targetCards[c] - sizeCluster[c];
+
+                if (nb_points_to_add[c] < 0) // Constraint is violated if a cluster is overfilled
+                    fail();
+
+                if (nb_points_to_add[c] > max_clust_completion)
+                    max_clust_completion = nb_points_to_add[c]; // Update max_clust_completion
+            }
+        }
+    } while (prelimFilteringVarWasFixed);
+
+    // A cluster which can't reach its target cardinality with the free points that may still join it is a dead end
+    weights.sumCandidates(domains, candidateCount.data(), setU_unassigned.data(), q);
+    for (IlcInt c = 0; c < _k; c++)
+        if (candidateCount[c] < nb_points_to_add[c])
+            fail();
+
+    // If no points are assigned, which can happen when posting this constraint, there is no work to be done
+    if (q == _n) {
+        _X[0].setValue(0); // The first point must be assigned to 0 in all cases when symmetry-breaking constraints are active
+        return;
+    }
+
+    // Sum of dissimilarities of each cluster c (between units)
+    for (int c = 0; c < _k; c++) {
+        S1[c] = 0;
+        for (int i = 0; i < ((IlcInt) setP_assigned[c].size() - 1); i++)
+            for (int j = i + 1; j < (IlcInt) setP_assigned[c].size(); j++)
+                S1[c] += weights[setP_assigned[c][i]]*weights[setP_assigned[c][j]]*_dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
+    }
+
+    // Sum of dissimilarities between (one unit of) each unassigned point and each cluster
+    for (int i = 0; i < q; i++) { // for each unassigned point
+        for (int c = 0; c < _k; c++) { // for each cluster
+            if (nb_points_to_add[c] > 0 && domains.isInDomain(setU_unassigned[i], c)) { // if unassigned point i can be assigned to cluster c
+                s2[i][c] = 0;
+                for (int j = 0; j < (IlcInt) setP_assigned[c].size(); j++) { // for each point j in cluster c
+                    s2[i][c] += weights[setP_assigned[c][j]]*_dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
+                }
+            }
+            else { // else, unassigned point i can't be part of cluster c, set to infinity to exclude
+                s2[i][c] = IlcInfinity;
+            }
+        }
+    }
+
+    // Smallest 1/2 contribution of each unassigned point together with m other units
+    //     We only need to study adding max_clust_completion
+    for (int i = 0; i < q; i++) {
+        cannotLinks.markPartners(setU_unassigned[i]);
+        weights.fillHalfContributions(setU_unassigned[i], setU_unassigned.data(), q, _dissimilarities, cannotLinks, max_clust_completion, s3[i]);
+    }
+
+    // Arc costs, as in the MCF of IlcWCSS_NetworkCardControl: one unit of i completes c along with the cheapest other units
+    for (int i = 0; i < q; i++)
+        for (int c = 0; c < _k; c++)
+            arcCost[i*_k + c] = (s2[i][c] != IlcInfinity) ? (s2[i][c] + s3[i][nb_points_to_add[c] - 1]) / _targetCards[c] : IlcInfinity;
+
+    IlcFloat lb_fixed = 0; // Contribution of the fixed points alone
+    for (int c = 0; c < _k; c++)
+        lb_fixed += S1[c] / _targetCards[c];
+
+    // Subgradient ascent on the multipliers, from those of the previous propagation. Every evaluation is a valid bound,
+    //     the best one is kept.
+    IlcFloat lagrangian = evaluateLagrangian(multipliers);
+    IlcFloat bestLagrangian = lagrangian;
+    bestMultipliers = multipliers;
+    bestCheapest = cheapest;
+
+    IlcFloat step = __LAGRANGIAN_STEP;
+    for (int iteration = 0; iteration < __LAGRANGIAN_ITERATIONS && bestLagrangian != IlcInfinity; iteration++) {
+        IlcFloat norm = 0;
+        for (int c = 0; c < _k; c++)
+            norm += subgradient[c]*subgradient[c];
+        if (norm == 0)
+            break; // The relaxed flow meets every cardinality: it is optimal, the bound is that of the MCF
+
+        // Polyak step towards the bound that would prune the node (or a bit above the current one without incumbent)
+        IlcFloat target = (_V.getMax() != IlcInfinity) ? (schedule.getPruningBound(_V.getMax()) - lb_fixed) : (bestLagrangian + 0.1*std::max((IlcFloat) 1, std::abs(bestLagrangian)));
+        if (target <= bestLagrangian)
+            break; // Node is pruned already
+
+        for (int c = 0; c < _k; c++)
+            trialMultipliers[c] = multipliers[c] + step*(target - lagrangian)/norm*subgradient[c];
+        multipliers.swap(trialMultipliers);
+
+        lagrangian = evaluateLagrangian(multipliers);
+        if (lagrangian > bestLagrangian) {
+            bestLagrangian = lagrangian;
+            bestMultipliers = multipliers;
+            bestCheapest = cheapest;
+        }
+        else {
+            step /= 2;
+        }
+    }
+    multipliers = bestMultipliers; // Warm start of the next propagation
+
+    if (bestLagrangian == IlcInfinity)
+        fail(); // Some point can't go anywhere
+
+    // Global lower bound
+    lb_global = lb_fixed + bestLagrangian;
+
+    // Filter objective, also with the coordinate-space bound if available (filtering below relies on the multipliers only)
+    IlcFloat lb_objective = lb_global;
+    if (centroids.isEnabled())
+        lb_objective = std::max(lb_objective, centroids.compute(setP_assigned, setU_unassigned.data(), q, domains, _targetCards, nb_points_to_add, weights));
+    const IlcFloat ub_pruning = schedule.getPruningBound(_V.getMax());
+    const IlcFloat ub_nogoods = schedule.getIncumbentBound();
+    if (nogoods.isEnabled() && lb_objective - _epsc > ub_nogoods)
+        nogoods.learn(setP_assigned, ub_nogoods, _epsc); // The node fails below, see IlcWCSS_StandardCardControl
+    if (lb_objective - _epsc > ub_pruning)
+        fail();
+    _V.setMin(lb_objective - _epsc); // Rounding errors, see IlcWCSS_StandardCardControl
+
+    // Reduced-cost loop, unless delayed
+    if (!schedule.shouldFilter(p, lb_global, ub_pruning))
+        return;
+    IlcInt nbRemovals = 0;
+
+    bool cannotLinkedVarWasFixed = false;
+
+    // Sending all units of i to c rather than to its cheapest cluster, under the same multipliers, is a bound of x_i = c
+    for (int i = 0; i < q; i++) {
+        const IlcInt w = weights[setU_unassigned[i]];
+
+        for (int c = 0; c < _k; c++) {
+            if (!domains.isInDomain(setU_unassigned[i], c) || arcCost[i*_k + c] == IlcInfinity)
+                continue;
+
+            const IlcFloat V_prime = lb_global + w*((arcCost[i*_k + c] - bestMultipliers[c]) - bestCheapest[i]);
+            if (V_prime >= ub_pruning) {
+                _X[setU_unassigned[i]].removeValue(c);
+                domains.removeValue(setU_unassigned[i], c);
+                nbRemovals++;
+
+                if (domains.getSize(setU_unassigned[i]) == 1 && cannotLinks.hasPartners(setU_unassigned[i]))
+                    cannotLinkedVarWasFixed = true;
+            }
+        }
+    }
+
+    schedule.record(nbRemovals);
+
+    // Points fixed above have partners to update (see CannotLinkGraph.h)
+    if (cannotLinkedVarWasFixed)
+        push();
+}
+
+
+// Lagrangian function at lambda: the units lacking in the clusters are priced at lambda, each free point then sends all
+//     its units to the cluster of smallest reduced cost arcCost - lambda. cheapest and subgradient (units lacking minus
+//     units received, per cluster) are filled for lambda. IlcInfinity if some point has no arc.
+IlcFloat IlcWCSS_LagrangianCardControlI::evaluateLagrangian(const std::vector<IlcFloat>& lambda) {
+    IlcFloat lagrangian = 0;
+    for (int c = 0; c < _k; c++) {
+        lagrangian += lambda[c]*nb_points_to_add[c];
+        subgradient[c] = nb_points_to_add[c];
+    }
+
+    for (int i = 0; i < q; i++) {
+        IlcFloat best = IlcInfinity;
+        IlcInt bestC = -1;
+        for (int c = 0; c < _k; c++)
+            if (arcCost[i*_k + c] != IlcInfinity && arcCost[i*_k + c] - lambda[c] < best) {
+                best = arcCost[i*_k + c] - lambda[c];
+                bestC = c;
+            }
+
+        if (bestC < 0)
+            return IlcInfinity;
+
+        cheapest[i] = best;
+        lagrangian += weights[setU_unassigned[i]]*best;
+        subgradient[bestC] -= weights[setU_unassigned[i]];
+    }
+
+    return lagrangian;
+}
+
+
+// Function which returns an engine handle (IlcConstraintI*) for the constraint implementation IlcWCSS_LagrangianCardControlI
+IlcConstraint IlcWCSS_LagrangianCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) {
+    IlcCPEngine cp = X.getCPEngine();
+    return new (cp.getHeap()) IlcWCSS_LagrangianCardControlI(cp, X, V, data, propagation);
+}
+
+
+// Macro which wraps the engine constraint handle into a modeling layer (Concert Technology) extractable object
+ILOCPCONSTRAINTWRAPPER4(IloWCSS_LagrangianCardControl, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao, const PropagationParameters*, _propagationo) {
+    use(cp, _Xo);
+    use(cp, _Vo);
+    return IlcWCSS_LagrangianCardControl(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao, _propagationo);
+}
\ No newline at end of file
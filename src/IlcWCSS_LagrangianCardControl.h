@@ -0,0 +1,123 @@
+/*
+ * This constraint should be used in conjunction with an appropriate model to speedup exact Minimum Sum of Squares Clustering with pre-set, strict cluster cardinalities.
+ * It sits between IloWCSS_StandardCardControl (cheap, weaker) and IloWCSS_NetworkCardControl (stronger, one MCF per propagation through CPLEX).
+ * The MCF of IloWCSS_NetworkCardControl sends the units of the free points to the clusters at the cost of their arcs, each cluster c receiving
+ *     exactly the nb_points_to_add[c] units it lacks. Here, these cardinality constraints are relaxed with Lagrange multipliers (one per cluster):
+ *     for fixed multipliers, the flow decomposes per point into a minimum over its clusters, in O(qk), and any multipliers give a valid bound.
+ *     The multipliers are improved by a few subgradient steps per propagation, warm-started from the multipliers of the previous propagation,
+ *     which, along a depth-first search, is most often the parent node. At the optimal multipliers, the bound is that of the MCF (the
+ *     transportation polytope is integral), without an LP solver.
+ * The objective function is filtered through tightening of the lower bound.
+ * The reprentative variables are filtered through Lagrangian reduced costs against an upper bound decided by the best incumbent solution.
+ *
+ * Main arguments: * X, array of integer representative variables that link observations to their cluster.
+ *                 * V, WCSS of solution, must be constrained to take value of WCSS in Concert Technology model.
+ *
+ * Additional arguments: * data, refer to Data struct in Data.h for problem data nomenclature.
+ *                       * propagation, optional scheduling of the cost-based filtering (see PropagationSchedule.h).
+ *
+ * Note: this constraint is also heavily dependent on the search strategy. Use IloMSSCSearchStrategy (IloGoal).
+ *
+ * This constraint uses elements from the work of:
+ * Dao TBH., Duong KC., Vrain C. (2015) Constrained Minimum Sum of Squares Clustering by Constraint Programming.
+ *     In: Pesant G. (eds) Principles and Practice of Constraint Programming. CP 2015.
+ *     Lecture Notes in Computer Science, vol 9255. Springer, Cham
+ *     doi:10.1007/978-3-319-23219-5_39
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+// Vector and vector operations
+#include <algorithm>
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Cannot-link constraints
+#include "CannotLinkGraph.h"
+
+// Observation weights
+#include "ObservationWeights.h"
+
+// Coordinate-space bound
+#include "CentroidBound.h"
+
+// Scheduling of cost-based filtering
+#include "PropagationSchedule.h"
+
+// Nogoods learned from bound failures
+#include "NogoodStore.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+// Refer to cpp file for explanation of variables defined here
+
+
+ILOSTLBEGIN
+
+
+class IlcWCSS_LagrangianCardControlI : public IlcConstraintI {
+protected:
+    IlcFloat evaluateLagrangian(const std::vector<IlcFloat>& lambda); // Fills cheapest and subgradient
+
+    double const* const* const _dissimilarities;
+    IlcIntArray _targetCards;
+
+    IlcInt _n, _k; // size of problem, nb of clusters
+    IlcInt p, q; // size of sets P and U resp.
+
+    IlcIntVarArray _X; // Point assignments
+    IlcFloatVar _V; // total WCSS
+
+    CannotLinkGraph cannotLinks;
+    ObservationWeights weights;
+    CentroidBound centroids;
+    PropagationSchedule schedule;
+    NogoodStore nogoods;
+
+    // In propagate
+    DomainSnapshot domains;
+    std::vector<DomainWord> fullClusters;
+    std::vector<IlcInt> candidateCount;
+
+    std::vector<IlcInt> setU_unassigned;
+    std::vector<IlcInt>* setP_assigned;
+
+    IlcIntArray sizeCluster;
+
+    IlcFloatArray S1;
+    IlcFloat** s2;
+    std::vector<IlcFloat>* s3;
+
+    IlcIntArray nb_points_to_add;
+    IlcInt max_clust_completion;
+
+    // Lagrangian relaxation
+    std::vector<IlcFloat> arcCost; // arcCost[i*_k + c] = cost of one unit of the i-th unassigned point in c, IlcInfinity if no such arc
+    std::vector<IlcFloat> multipliers; // Kept from one propagation to the next (warm start)
+    std::vector<IlcFloat> bestMultipliers;
+    std::vector<IlcFloat> trialMultipliers;
+    std::vector<IlcFloat> subgradient;
+    std::vector<IlcFloat> cheapest; // cheapest[i] = smallest reduced cost of one unit of the i-th unassigned point
+    std::vector<IlcFloat> bestCheapest;
+
+    IlcFloat lb_global;
+
+    double _epsc;
+
+public:
+    IlcWCSS_LagrangianCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation);
+    ~IlcWCSS_LagrangianCardControlI();
+    virtual void propagate();
+    virtual void post();
+    IlcIntVarArray getEngineVars() { return _X; }
+};
+
+IlcConstraint IlcWCSS_LagrangianCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation = NULL);
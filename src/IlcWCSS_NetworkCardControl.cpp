@@ -12,6 +12,10 @@
  *
  * Note: this constraint is also heavily dependent on the search strategy. Use IloMSSCSearchStrategy (IloGoal).
  *
+ * With two clusters (and unit weights), the MCF reduces to sending to cluster 0 the free points whose cost difference
+ *     between both clusters is smallest. The bound and exact reduced costs are then computed by sorting, in O(q log q),
+ *     and CPLEX is not called.
+ *
  * This constraint uses elements from the work of:
  * Dao TBH., Duong KC., Vrain C. (2015) Constrained Minimum Sum of Squares Clustering by Constraint Programming.
  *     In: Pesant G. (eds) Principles and Practice of Constraint Programming. CP 2015.
@@ -28,7 +32,7 @@
 #include "IlcWCSS_NetworkCardControl.h"
 
 
-IlcWCSS_NetworkCardControlI::IlcWCSS_NetworkCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data) :
+IlcWCSS_NetworkCardControlI::IlcWCSS_NetworkCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) :
 IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.getSize()), _k(data.K) {
     // Populate _targetCards
     _targetCards = IlcIntArray(cp, _k);
@@ -37,10 +41,37 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
 
     // Make sure everything's cute
     assert(_targetCards.getSize() == _k); // number of indicated cards is same as clusters
+    // Observation weights, cardinalities are counted in units (a point of weight w is w units)
+    weights.build(data, _n);
+
+    // Coordinate-space bound on the objective, if enabled and coordinates are given (see CentroidBound.h)
+    centroids.build(data, _n, propagation);
+
+    // When to run the getDeltaObj loop, adaptive if requested (see PropagationSchedule.h)
+    schedule.build(propagation, _n);
+
+    // Nogoods learned from bound failures, if requested (see NogoodStore.h)
+    nogoods.build(data, _n, propagation);
+
     IlcInt ctrl_nb_pts = 0;
     for (IlcInt c = 0; c < _k; c++)
         ctrl_nb_pts += _targetCards[c];
-    assert(ctrl_nb_pts == _n); // number of indicated points is same as problem size
+    assert(ctrl_nb_pts == weights.getTotal()); // number of indicated units is same as problem size
+
+    // Snapshot of domains of X, taken at the start of each propagation
+    domains.resize(_n, _k);
+
+    // Must-links are not propagated, the instance must be contracted first (see CannotLinkGraph.h)
+    assert(data.nbMustLinks == 0);
+
+    // Cannot-link constraints (see CannotLinkGraph.h for why they are propagated here)
+    cannotLinks.build(data, _n);
+
+    // Mask of clusters which are filled to their target cardinality
+    fullClusters.assign(domains.getNbWordsPerVar(), 0);
+
+    // Number of free units which can still join each cluster c
+    candidateCount.assign(_k, 0);
 
     // sets of points and their sizes
     setP_assigned = new (cp.getHeap()) std::vector<IlcInt>[_k]; // setP_assigned[c] = i means point i is assigned to cluster c
@@ -54,10 +85,10 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     // Sum of dissimilarities (squared) between each unassigned point and each cluster
     s2 = new (cp.getHeap()) IlcFloat*[_n]; // Allocation on engine heap for efficient and unified memory control
     for (IlcInt i = 0; i < _n; i++)
-        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between x and all points in cluster c
+        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between one unit of x and all units in cluster c
 
     // Smallest 1/2 contribution of each unassigned point together with m other points
-    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free points brought along in addition to x
+    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free units brought along in addition to one unit of x
 
     // Map between main problem variables and CPLEX model variables
     problem_to_cplex_var_map = new (cp.getHeap()) IlcInt*[_n];
@@ -72,10 +103,15 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     for (IlcInt i = 0; i < _n; i++)
         hasFlow[i] = new (cp.getHeap()) IlcRevBool[_k]; // indices are equivalent to problem_to_cplex_var_map
 
+    // Backup for which edges are filled to capacity (the weight of their point) after CPLEX is run
+    isSaturated = new (cp.getHeap()) IlcRevBool*[_n];
+    for (IlcInt i = 0; i < _n; i++)
+        isSaturated[i] = new (cp.getHeap()) IlcRevBool[_k]; // indices are equivalent to problem_to_cplex_var_map
+
     // Global lower bound as computed by CPLEX
     lb_global = new (cp.getHeap()) IlcRevFloat(cp, 0.0);
 
-    // Points to add in cluster c for completion
+    // Units to add in cluster c for completion
     nb_points_to_add = IlcIntArray(cp, _k);
 
     // This espsilon is subtracted from the computed lower bound to prevent false backtracking while comparing with upper bound due to rounding errors
@@ -90,6 +126,10 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     varWasFixed = new (cp.getHeap()) IlcRevBool[_n];
     for (IlcInt i = 0; i < _n; i++)
         varWasFixed[i].setValue(cp, IlcFalse);
+
+    // MCF bounds and flows of the subproblems solved so far, up to relabelling of clusters
+    transpositions.build(cp, _n, _k, propagation);
+    flowBits.assign(transpositions.getNbPayloadWords(), 0);
 }
 
 
@@ -121,11 +161,14 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             setP_assigned[c].clear();
         p = 0;
 
+        // One pass of engine calls, every subsequent domain test is done on the snapshot
+        domains.take(_X);
+
         // Populating sets and definition of partial problem
         for (IlcInt i = 0; i < _n; i++) {
-            if (_X[i].isFixed()) {
+            if (domains.isFixed(i)) {
                 p++;
-                setP_assigned[_X[i].getValue()].push_back(i);
+                setP_assigned[domains.getValue(i)].push_back(i);
             }
             else {
                 q++;
@@ -136,7 +179,7 @@ void IlcWCSS_NetworkCardControlI::propagate() {
         // Size of each cluster c and how many points to add
         max_clust_completion = 0; // Max number of points to add, all clusters considered
         for (IlcInt c = 0; c < _k; c++) {
-            sizeCluster[c] = setP_assigned[c].size(); // sizeCluster[c] = m means c is size m
+            sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m (in units)
             nb_points_to_add[c] = _targetCards[c] - sizeCluster[c];
 
             if (nb_points_to_add[c] < 0) // Constraint is violated if a cluster is overfilled
@@ -153,35 +196,52 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             // Nothing has yet changed entering this loop
             prelimFilteringVarWasFixed = false;
 
-            // Filter values if corresponding clusters are filled
-            for (IlcInt c = 0; c < _k; c++) {
-                if (nb_points_to_add[c] == 0) {
-                    std::vector<IlcInt>::iterator setU_iter = setU_unassigned.begin();
-
-                    while (setU_iter != setU_unassigned.end()) {
-                        if (_X[*setU_iter].isInDomain(c)) {
-                            _X[*setU_iter].removeValue(c); // Careful, a variable could get bound here, hence the whole reason this "do... while" exists in the first place
-
-                            if (_X[*setU_iter].isFixed()) {
-                                prelimFilteringVarWasFixed = true;
-                                setP_assigned[_X[*setU_iter].getValue()].push_back(*setU_iter); p++;
-                                setU_iter = setU_unassigned.erase(setU_iter); q--; 
-                            } else {
-                                ++setU_iter;
-                            }
-                        } else {
-                            ++setU_iter;
-                        }
-                    }
-                }
+            // Cannot-links: clusters of fixed points are removed from the free points they are cannot-linked to
+            IlcInt nbCannotLinkRemovals = cannotLinks.propagate(_X, domains);
+            if (nbCannotLinkRemovals < 0)
+                fail(); // Two cannot-linked points in the same cluster
+
+            // Nogoods learned from earlier bound failures
+            IlcInt nbNogoodRemovals = nogoods.isEnabled() ? nogoods.propagate(_X, domains) : 0;
+            if (nbNogoodRemovals < 0)
+                fail(); // A partial assignment already known to fail
+
+            // Filter values if corresponding clusters are filled, all filled clusters at once
+            //     With weights, a cluster is also closed to the points heavier than what it has left to house
+            IlcInt nbNewlyFixed;
+            if (weights.isUnit()) {
+                for (IlcInt b = 0; b < (IlcInt) fullClusters.size(); b++)
+                    fullClusters[b] = 0;
+                for (IlcInt c = 0; c < _k; c++)
+                    if (nb_points_to_add[c] == 0)
+                        fullClusters[c >> 6] |= ((DomainWord) 1) << (c & 63);
+
+                nbNewlyFixed = domains.removeValues(_X, fullClusters.data(), setU_unassigned.data(), q); // Careful, a variable could get bound here, hence the whole reason this "do... while" exists in the first place
             }
+            else {
+                nbNewlyFixed = weights.removeOversized(_X, domains, nb_points_to_add, setU_unassigned.data(), q);
+            }
+
+            if (nbNewlyFixed < 0)
+                fail(); // A point can't go anywhere
 
             // If some variable was fixed, update sets and subproblem characteristics
-            if (prelimFilteringVarWasFixed) {
+            if (nbNewlyFixed > 0 || nbCannotLinkRemovals > 0 || nbNogoodRemovals > 0) {
+                std::vector<IlcInt>::iterator setU_iter = setU_unassigned.begin();
+                while (setU_iter != setU_unassigned.end()) {
+                    if (domains.isFixed(*setU_iter)) {
+                        prelimFilteringVarWasFixed = true;
+                        setP_assigned[domains.getValue(*setU_iter)].push_back(*setU_iter); p++;
+                        setU_iter = setU_unassigned.erase(setU_iter); q--;
+                    } else {
+                        ++setU_iter;
+                    }
+                }
+
                 // Size of each cluster c and how many points to add
                 max_clust_completion = 0; // max number of points to add all clusters considered
                 for (IlcInt c = 0; c < _k; c++) {
-                    sizeCluster[c] = setP_assigned[c].size(); // sizeCluster[c] = m means c is size m
+                    sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m (in units)
                     nb_points_to_add[c] = _targetCards[c] - sizeCluster[c];
 
                     if (nb_points_to_add[c] < 0) // Constraint is violated if a cluster is overfilled
@@ -193,6 +253,12 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             }
         } while (prelimFilteringVarWasFixed);
 
+        // A cluster which can't reach its target cardinality with the free points that may still join it is a dead end
+        weights.sumCandidates(domains, candidateCount.data(), setU_unassigned.data(), q);
+        for (IlcInt c = 0; c < _k; c++)
+            if (candidateCount[c] < nb_points_to_add[c])
+                fail();
+
         // If no points are assigned, which can happen when posting this constraint, there is no work to be done
         if (q == _n) {
             _X[0].setValue(0); // The first point must be assigned to 0 in all cases when symmetry-breaking constraints are active
@@ -204,12 +270,12 @@ void IlcWCSS_NetworkCardControlI::propagate() {
      * Kitchen: prepare ingredients for further steps, ie relevant point contributions to each cluster
      */
 
-        // Sum of dissimilarities of each cluster c
+        // Sum of dissimilarities of each cluster c (between units)
         for (IlcInt c = 0; c < _k; c++) {
             S1[c] = 0;
-            for (IlcInt i = 0; i < (sizeCluster[c] - 1); i++)
-                for (IlcInt j = i + 1; j < sizeCluster[c]; j++)
-                    S1[c] += _dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
+            for (IlcInt i = 0; i < ((IlcInt) setP_assigned[c].size() - 1); i++)
+                for (IlcInt j = i + 1; j < (IlcInt) setP_assigned[c].size(); j++)
+                    S1[c] += weights[setP_assigned[c][i]]*weights[setP_assigned[c][j]]*_dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
         }
 
         // Variable mapping for clusters between CP realm and CPLEX realm
@@ -227,18 +293,18 @@ void IlcWCSS_NetworkCardControlI::propagate() {
         // Initialize var counter for observation variables in CPLEX realm 
         cplex_var_map_counter = 0;
 
-        // Sum of dissimilarities between each unassigned point and each cluster & variable mapping for observations between CP realm and CPLEX realm
+        // Sum of dissimilarities between (one unit of) each unassigned point and each cluster & variable mapping for observations between CP realm and CPLEX realm
         for (IlcInt i = 0; i < q; i++) { // for each unassigned point
             for (IlcInt c = 0; c < _k; c++) { // for each cluster
-                if (_X[setU_unassigned[i]].isInDomain(c) && problem_to_cplex_cluster_var_map[c] != -1) {
+                if (domains.isInDomain(setU_unassigned[i], c) && problem_to_cplex_cluster_var_map[c] != -1) {
                     // Second condition in this "if" statement is redundant
-                    //     if nb_points_to_add[c] == 0, then necessarily _X[setU_unassigned[i]].isInDomain(c) is false
+                    //     if nb_points_to_add[c] == 0, then necessarily domains.isInDomain(setU_unassigned[i], c) is false
                     problem_to_cplex_var_map[i][c] = cplex_var_map_counter;
                     cplex_var_map_counter++;
 
                     s2[i][c] = 0;
-                    for (IlcInt j = 0; j < sizeCluster[c]; j++) { // for each point j in cluster c
-                        s2[i][c] += _dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
+                    for (IlcInt j = 0; j < (IlcInt) setP_assigned[c].size(); j++) { // for each point j in cluster c
+                        s2[i][c] += weights[setP_assigned[c][j]]*_dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
                     }
                 }
                 else { // else, unassigned point i can't be part of cluster c, set to infinity and exclude
@@ -248,18 +314,30 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             }
         }
 
-        // Smallest 1/2 contributions of each unassigned point together with m other points
+        // Smallest 1/2 contributions of each unassigned point together with m other units
         for (IlcInt i = 0; i < q; i++) {
-            s3[i].clear(); // Important to clear vector from previous run
-            for (int j = 0; j < q; j++) {
-                // At first, we put all points in that list
-                s3[i].push_back(_dissimilarities[setU_unassigned[i]][setU_unassigned[j]] / 2);
-            }
+            cannotLinks.markPartners(setU_unassigned[i]);
+            weights.fillHalfContributions(setU_unassigned[i], setU_unassigned.data(), q, _dissimilarities, cannotLinks, max_clust_completion, s3[i]);
+        }
 
-            std::sort(s3[i].begin(), s3[i].end()); // sort distances for each point, first element 0 because d(x,x) = 0
+        const IlcFloat ub_pruning = schedule.getPruningBound(_V.getMax());
+        const IlcFloat ub_nogoods = schedule.getIncumbentBound();
+
+        // Coordinate-space bound on the objective, if available (see CentroidBound.h)
+        //     Cheap next to the MCF, which is never solved if this bound alone fails the node. Filtering relies on the MCF only.
+        if (centroids.isEnabled()) {
+            const IlcFloat lb_centroids = centroids.compute(setP_assigned, setU_unassigned.data(), q, domains, _targetCards, nb_points_to_add, weights) - _epsc;
+            if (nogoods.isEnabled() && lb_centroids > ub_nogoods)
+                nogoods.learn(setP_assigned, ub_nogoods, _epsc); // The node fails below, see IlcWCSS_StandardCardControl
+            if (lb_centroids > ub_pruning)
+                fail();
+            _V.setMin(lb_centroids);
+        }
 
-            for (int j = 1; j < max_clust_completion; j++)
-                s3[i][j] += s3[i][j-1]; // Compute minimum 1/2 contributions, first element is 0
+        // Two clusters: no MCF needed, see propagateTwoClusters
+        if (_k == 2 && weights.isUnit()) {
+            propagateTwoClusters();
+            return;
         }
 
         // Check whether meaningful change has occured that warrants fresh computations
@@ -274,13 +352,13 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             }
 
             // If a point was assigned to a cluster other than one to which it was matched by the last MCF
-            if (_X[i].isFixed() && _X[i].getValue() != destination[i].getValue()) {
+            if (domains.isFixed(i) && domains.getValue(i) != destination[i].getValue()) {
                 activeVarValHasChanged = true;
                 break;
             }
 
             // If the cluster to which a point was matched by the last MCF no longer exists in the domain of the corresponding var
-            if (!_X[i].isInDomain(destination[i].getValue())) {
+            if (!domains.isInDomain(i, destination[i].getValue())) {
                 activeVarValHasChanged = true;
                 break;
             }
@@ -288,7 +366,7 @@ void IlcWCSS_NetworkCardControlI::propagate() {
 
         // If a var was newly bound after the last propagation
         for (IlcInt i = 0; i < _n; i++) {
-            if (_X[i].isFixed() && !varWasFixed[i].getValue()) {
+            if (domains.isFixed(i) && !varWasFixed[i].getValue()) {
                 activeVarValHasChanged = true;
                 varWasFixed[i].setValue(getCPEngine(), IlcTrue); // Update record for subsequent propagations
             }
@@ -302,6 +380,19 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             }
         }
 
+        // With weights, a point may be split between several clusters, destination only records one of them
+        //     Set U is unchanged at this point (otherwise a var was newly bound), so indices of hasFlow still hold
+        if (!activeVarValHasChanged && !weights.isUnit())
+            for (IlcInt i = 0; i < q && !activeVarValHasChanged; i++)
+                for (IlcInt c = 0; c < _k; c++)
+                    if (hasFlow[i][c].getValue() && problem_to_cplex_var_map[i][c] == -1) {
+                        activeVarValHasChanged = true;
+                        break;
+                    }
+
+        // Total weight of free points, ie flow going through the network
+        IlcInt qWeight = weights.sum(setU_unassigned.data(), q);
+
 
     /*
      * Core: Minimum-Cost Flow (MCF) formulation for lower-bound computations
@@ -311,7 +402,32 @@ void IlcWCSS_NetworkCardControlI::propagate() {
      *              cleanup beyond this point when leaving this scope (in particular when failures occur).
      */
 
-        if (activeVarValHasChanged) { // A meaningful change has occured that warrants fresh computations 
+        // The same subproblem, up to relabelling of clusters of equal target, may have been solved on another path
+        bool isTransposition = false;
+        TranspositionKey key;
+        if (activeVarValHasChanged && transpositions.isEnabled()) {
+            key = transpositions.computeKey(setP_assigned, setU_unassigned.data(), q, domains, _targetCards, nb_points_to_add, clusterRanks);
+
+            IlcFloat bound;
+            if (transpositions.lookup(key, bound, flowBits.data())) {
+                if (bound == IlcInfinity)
+                    fail(); // No valid assignment of free points, see below
+
+                lb_global->setValue(getCPEngine(), bound);
+                for (IlcInt i = 0; i < q; i++) {
+                    for (IlcInt c = 0; c < _k; c++) {
+                        const bool arc = (problem_to_cplex_var_map[i][c] != -1);
+                        const size_t flowBit = TranspositionTable::getFlowBit(i, clusterRanks[c], _k, false);
+                        const size_t saturatedBit = TranspositionTable::getFlowBit(i, clusterRanks[c], _k, true);
+                        hasFlow[i][c].setValue(getCPEngine(), arc && ((flowBits[flowBit >> 6] >> (flowBit & 63)) & 1));
+                        isSaturated[i][c].setValue(getCPEngine(), arc && ((flowBits[saturatedBit >> 6] >> (saturatedBit & 63)) & 1));
+                    }
+                }
+                isTransposition = true;
+            }
+        }
+
+        if (activeVarValHasChanged && !isTransposition) { // A meaningful change has occured that warrants fresh computations 
             // CPLEX environment for minimum-cost flow
             IloEnv cpx_env;
 
@@ -320,7 +436,7 @@ void IlcWCSS_NetworkCardControlI::propagate() {
 
             // Variables
             IloInt _cn = q + cplex_var_map_counter + cluster_not_filled_counter; // Number of vars in CPLEX model
-            IloNumVarArray _cX(cpx_env, _cn, 0.0, max_clust_completion); // CPLEX model variables, minimum arc capacity is 0. Most arcs should have capacity 1,
+            IloNumVarArray _cX(cpx_env, _cn, 0.0, max_clust_completion); // CPLEX model variables, minimum arc capacity is 0. Most arcs should have capacity 1 (the weight of their point),
                                                                          // except arcs linking clusters to drain, capacity in that case should be nb_points_to_add[c]
 
             // NETWORK: primary source
@@ -328,10 +444,10 @@ void IlcWCSS_NetworkCardControlI::propagate() {
 
             for (IloInt i = 0; i < q; i++) {
                 _csource += _cX[i];
-                cpx_model.add(_cX[i] <= 1); // Max capacity is 1, see above
+                cpx_model.add(_cX[i] <= weights[setU_unassigned[i]]); // Max capacity is 1 (weight), see above
             }
 
-            cpx_model.add(_csource == q);
+            cpx_model.add(_csource == qWeight);
 
             // NETWORK: transit unbound points
             for (int i = 0; i < q; i++) {
@@ -341,7 +457,7 @@ void IlcWCSS_NetworkCardControlI::propagate() {
                 for (IlcInt c = 0; c < _k; c++) {
                     if (problem_to_cplex_var_map[i][c] != -1) {
                         _cTempTransitPoint += _cX[q + problem_to_cplex_var_map[i][c]];
-                        cpx_model.add(_cX[q + problem_to_cplex_var_map[i][c]] <= 1); // Max capacity is 1, see above
+                        cpx_model.add(_cX[q + problem_to_cplex_var_map[i][c]] <= weights[setU_unassigned[i]]); // Max capacity is 1 (weight), see above
                     }
                 }
 
@@ -392,7 +508,7 @@ void IlcWCSS_NetworkCardControlI::propagate() {
                 if (problem_to_cplex_cluster_var_map[c] != -1)
                     _cdrain -= _cX[q + cplex_var_map_counter + problem_to_cplex_cluster_var_map[c]];
 
-            cpx_model.add(_cdrain == -q);
+            cpx_model.add(_cdrain == -qWeight);
 
             // Objective
             cpx_model.add(IloMinimize(cpx_env, lb_global_expr));
@@ -406,16 +522,44 @@ void IlcWCSS_NetworkCardControlI::propagate() {
             // Solve
             if (!cplex.solve()) {
                 cpx_env.end();
+                if (transpositions.isEnabled())
+                    transpositions.store(key, IlcInfinity, flowBits.data());
                 fail(); // If CPLEX can't solve model, it means this branch can't be successful because there is no valid assignment of free points
             }
 
             lb_global->setValue(getCPEngine(), cplex.getObjValue() - _epsc); // Protection against rounding errors, see constructor
 
             // Backup which arcs have flow, useful for further value filtering
-            for (IlcInt i = 0; i < q; i++)
-                for (IlcInt c = 0; c < _k; c++)
+            for (IlcInt i = 0; i < q; i++) {
+                for (IlcInt c = 0; c < _k; c++) {
+                    if (problem_to_cplex_var_map[i][c] == -1) { // No such arc
+                        hasFlow[i][c].setValue(getCPEngine(), IlcFalse);
+                        isSaturated[i][c].setValue(getCPEngine(), IlcFalse);
+                        continue;
+                    }
+
                     // Solution is integral, using inequality to shield against rounding errors
-                    hasFlow[i][c].setValue(getCPEngine(), (cplex.getValue(_cX[q + problem_to_cplex_var_map[i][c]]) > 0.5));
+                    IloNum flow = cplex.getValue(_cX[q + problem_to_cplex_var_map[i][c]]);
+                    hasFlow[i][c].setValue(getCPEngine(), (flow > 0.5));
+                    isSaturated[i][c].setValue(getCPEngine(), (flow > weights[setU_unassigned[i]] - 0.5));
+                }
+            }
+
+            // Record bound and flow, under the canonical ranks of clusters
+            if (transpositions.isEnabled()) {
+                std::fill(flowBits.begin(), flowBits.end(), 0);
+                for (IlcInt i = 0; i < q; i++) {
+                    for (IlcInt c = 0; c < _k; c++) {
+                        const size_t flowBit = TranspositionTable::getFlowBit(i, clusterRanks[c], _k, false);
+                        const size_t saturatedBit = TranspositionTable::getFlowBit(i, clusterRanks[c], _k, true);
+                        if (hasFlow[i][c].getValue())
+                            flowBits[flowBit >> 6] |= (std::uint64_t) 1 << (flowBit & 63);
+                        if (isSaturated[i][c].getValue())
+                            flowBits[saturatedBit >> 6] |= (std::uint64_t) 1 << (saturatedBit & 63);
+                    }
+                }
+                transpositions.store(key, lb_global->getValue(), flowBits.data());
+            }
 
             // No need for CPLEX beyond this point, release memory
             cpx_env.end();
@@ -427,6 +571,10 @@ void IlcWCSS_NetworkCardControlI::propagate() {
      *     Reusing most recent valid MCF solution for efficient computation
      */
         
+        if (nogoods.isEnabled() && lb_global->getValue() > ub_nogoods)
+            nogoods.learn(setP_assigned, ub_nogoods, _epsc); // The node fails below, see IlcWCSS_StandardCardControl
+        if (lb_global->getValue() > ub_pruning)
+            fail();
         _V.setMin(lb_global->getValue()); // lb_global (ie lb_global_expr) and _V.getMax() have slightly different values (rounding errors). 
                                           // This means, sometimes, failure occurs when near a new, improving solution even though it shouldn't.
                                           // Removing a small epsilon solves the problem.
@@ -442,35 +590,133 @@ void IlcWCSS_NetworkCardControlI::propagate() {
 
         if (activeVarValHasChanged)
             for (IlcInt i = 0; i < _n; i++)
-                if (_X[i].isFixed())
-                    destination[i].setValue(getCPEngine(), _X[i].getValue());
+                if (domains.isFixed(i))
+                    destination[i].setValue(getCPEngine(), domains.getValue(i));
+
+        // getDeltaObj loop, unless delayed. The MCF records above are kept up to date regardless.
+        if (!schedule.shouldFilter(p, lb_global->getValue(), ub_pruning))
+            return;
+        IlcInt nbRemovals = 0;
+
+        bool cannotLinkedVarWasFixed = false;
 
-        // Variable fitering
         for (IlcInt c = 0; c < _k; c++) { // for each value c in domains of points, ie for each cluster
             for (IlcInt i = 0; i < q; i++) {
                 if (problem_to_cplex_var_map[i][c] != -1 && !hasFlow[i][c].getValue()) {
-                    // Get objective value increase if i-th point in U is assigned to cluster c
-                    deltaObj = getDeltaObj(i, destination[setU_unassigned[i]].getValue(), c); // -1 means infeasible updated solution
-                    
+                    // Get objective value increase if one unit of i-th point in U is assigned to cluster c
+                    //     With weights, the point may be split, getDeltaObj then considers every cluster it sends flow to
+                    deltaObj = getDeltaObj(i, weights.isUnit() ? destination[setU_unassigned[i]].getValue() : -1, c); // -1 means infeasible updated solution
+
+                    // The MCF cost is convex in the flow forced on an arc: sending all w units of the point to c costs at least w times the first unit
+                    if (deltaObj > 0)
+                        deltaObj *= weights[setU_unassigned[i]];
+
                     // If new objective exceeds incumbent cost
-                    if (deltaObj < -0.1 || (lb_global->getValue() + deltaObj) > _V.getMax()) { // -0.1 is shield against rounding errors.
-                        if (_X[setU_unassigned[i]].getSize() == 1) {
+                    if (deltaObj < -0.1 || (lb_global->getValue() + deltaObj) > ub_pruning) { // -0.1 is shield against rounding errors.
+                        if (domains.getSize(setU_unassigned[i]) == 1) {
                             // For some reason, CP optimizer, in extremely rare cases, would NOT fail if the dom of a var is emptied
                             //     We force failure here
                             fail();
                         }
 
                         _X[setU_unassigned[i]].removeValue(c);
+                        domains.removeValue(setU_unassigned[i], c);
+                        nbRemovals++;
+
+                        if (domains.getSize(setU_unassigned[i]) == 1 && cannotLinks.hasPartners(setU_unassigned[i]))
+                            cannotLinkedVarWasFixed = true;
                     }
                 }
             }
         }
 
+        schedule.record(nbRemovals);
+
+        // Points fixed above have partners to update (see CannotLinkGraph.h)
+        if (cannotLinkedVarWasFixed)
+            push();
+
 
     // Ended propagate
 }
 
 
+void IlcWCSS_NetworkCardControlI::propagateTwoClusters() {
+    // Every free point goes to cluster 1, except nb_points_to_add[0] of them. Those which can go either way are sent to
+    //     cluster 0 by increasing cost difference, which is what the MCF would do.
+    IlcFloat lb = S1[0] / _targetCards[0] + S1[1] / _targetCards[1];
+    IlcInt nbToFirst = nb_points_to_add[0]; // Points cluster 0 still has to take among those free to go either way
+
+    costDifferences.clear();
+    for (IlcInt i = 0; i < q; i++) {
+        const bool toFirst = (problem_to_cplex_var_map[i][0] != -1), toSecond = (problem_to_cplex_var_map[i][1] != -1);
+        assert(toFirst || toSecond); // Full clusters were removed from domains, which can't be empty
+
+        const IlcFloat cost0 = toFirst ? (s2[i][0] + s3[i][nb_points_to_add[0] - 1]) / _targetCards[0] : IlcInfinity;
+        const IlcFloat cost1 = toSecond ? (s2[i][1] + s3[i][nb_points_to_add[1] - 1]) / _targetCards[1] : IlcInfinity;
+
+        if (toFirst && toSecond) {
+            lb += cost1;
+            costDifferences.push_back(std::make_pair(cost0 - cost1, i));
+        }
+        else if (toFirst) {
+            lb += cost0;
+            nbToFirst--;
+        }
+        else {
+            lb += cost1;
+        }
+    }
+
+    const IlcInt nbFree = (IlcInt) costDifferences.size();
+    if (nbToFirst < 0 || nbToFirst > nbFree)
+        fail(); // Points bound to one cluster overfill it
+
+    std::sort(costDifferences.begin(), costDifferences.end());
+    for (IlcInt r = 0; r < nbToFirst; r++)
+        lb += costDifferences[r].first;
+
+    lb_global->setValue(getCPEngine(), lb - _epsc); // Same protection as the MCF bound, see constructor
+    const IlcFloat ub_pruning = schedule.getPruningBound(_V.getMax());
+    const IlcFloat ub_nogoods = schedule.getIncumbentBound();
+    if (nogoods.isEnabled() && lb_global->getValue() > ub_nogoods)
+        nogoods.learn(setP_assigned, ub_nogoods, _epsc); // The node fails below, see IlcWCSS_StandardCardControl
+    if (lb_global->getValue() > ub_pruning)
+        fail();
+    _V.setMin(lb_global->getValue());
+
+    // Variable filtering: moving a point across swaps it with the boundary point of the other side, which is exact
+    bool cannotLinkedVarWasFixed = false;
+
+    for (IlcInt r = 0; r < nbFree; r++) {
+        const IlcInt i = costDifferences[r].second;
+        const bool inFirst = (r < nbToFirst);
+        const IlcInt c = inFirst ? 1 : 0; // Cluster i is not sent to
+
+        bool remove;
+        if (inFirst) // i leaves cluster 0, the cheapest point of cluster 1 takes its place
+            remove = (nbToFirst == nbFree) || (lb_global->getValue() + costDifferences[nbToFirst].first - costDifferences[r].first) > ub_pruning;
+        else // i joins cluster 0, its most expensive point leaves
+            remove = (nbToFirst == 0) || (lb_global->getValue() + costDifferences[r].first - costDifferences[nbToFirst - 1].first) > ub_pruning;
+
+        if (remove) {
+            if (domains.getSize(setU_unassigned[i]) == 1)
+                fail(); // Same as in propagate
+
+            _X[setU_unassigned[i]].removeValue(c);
+            domains.removeValue(setU_unassigned[i], c);
+
+            if (cannotLinks.hasPartners(setU_unassigned[i]))
+                cannotLinkedVarWasFixed = true;
+        }
+    }
+
+    // Points fixed above have partners to update (see CannotLinkGraph.h)
+    if (cannotLinkedVarWasFixed)
+        push();
+}
+
+
 inline IlcFloat IlcWCSS_NetworkCardControlI::getDeltaObj(IlcInt origin_i, IlcInt origin_c, IlcInt targeted_c) {
     //                                                          ^ relocated point                 ^ headed to
     //                                                                           ^ whence it came
@@ -483,6 +729,8 @@ inline IlcFloat IlcWCSS_NetworkCardControlI::getDeltaObj(IlcInt origin_i, IlcInt
     //     Here |V| = q + _k - 1 because we remove the vertex corresponding to origin_i and any edges that lead to/emanate from it.
     //     Graph here is bipartite, on the left are vertices representing points in U. On the right, partial clusters.
     //     Vertices are named 0..q-1 on the left-hand side for the points, q + c# on the right-hand side for the clusters.
+    //     With weights, an arc may have flow without being saturated, it can then be taken both ways.
+    //     origin_c == -1 means origin_i may be split, any cluster it sends flow to can then take the deficit.
     std::vector<IlcFloat> graphMinDist(q + _k, IlcInfinity);
     graphMinDist[q + targeted_c] = 0; // Origin is targeted_c, where we have excess flow to redirect
 
@@ -492,14 +740,16 @@ inline IlcFloat IlcWCSS_NetworkCardControlI::getDeltaObj(IlcInt origin_i, IlcInt
 
         for (IlcInt i = 0; i < q; i++) {
             for (IlcInt c = 0; c < _k; c++) {
-                if (i != origin_i && c != targeted_c && problem_to_cplex_var_map[i][c] != -1 && !hasFlow[i][c].getValue()) {
+                if (i != origin_i && c != targeted_c && problem_to_cplex_var_map[i][c] != -1 && !isSaturated[i][c].getValue()) {
                     // Going right
                     // c != targeted_c: can never return to originating node. If there is a lower-weight path from targeted_c, it means negative-weight cycle.
                     if ((graphMinDist[i] + (s2[i][c] + s3[i][nb_points_to_add[c] - 1]) / _targetCards[c]) < graphMinDist[q + c]) {
                         graphMinDist[q + c] = graphMinDist[i] + (s2[i][c] + s3[i][nb_points_to_add[c] - 1]) / _targetCards[c];
                         hasChangedWeights = true;
                     }
-                } else if (i != origin_i && c != origin_c && problem_to_cplex_var_map[i][c] != -1 && hasFlow[i][c].getValue()) {
+                }
+
+                if (i != origin_i && c != origin_c && problem_to_cplex_var_map[i][c] != -1 && hasFlow[i][c].getValue()) {
                     // Going left
                     // c != origin_c: can never leave destination node. If there is a lower-weight path from origin_c, it means negative-weight cycle.
                     if ((graphMinDist[q + c] - (s2[i][c] + s3[i][nb_points_to_add[c] - 1]) / _targetCards[c]) < graphMinDist[i]) {
@@ -515,6 +765,23 @@ inline IlcFloat IlcWCSS_NetworkCardControlI::getDeltaObj(IlcInt origin_i, IlcInt
             break;
     }
 
+    // Split point: best of the clusters it sends flow to
+    if (origin_c == -1) {
+        IlcFloat bestDelta = IlcInfinity;
+        for (IlcInt c = 0; c < _k; c++) {
+            if (c == targeted_c || problem_to_cplex_var_map[origin_i][c] == -1 || !hasFlow[origin_i][c].getValue() || !(graphMinDist[q + c] < IlcInfinity))
+                continue;
+
+            IlcFloat delta = (s2[origin_i][targeted_c] + s3[origin_i][nb_points_to_add[targeted_c] - 1]) / _targetCards[targeted_c]
+                           - (s2[origin_i][c] + s3[origin_i][nb_points_to_add[c] - 1]) / _targetCards[c]
+                           + graphMinDist[q + c];
+            if (delta < bestDelta)
+                bestDelta = delta;
+        }
+
+        return (bestDelta < IlcInfinity) ? bestDelta : -1;
+    }
+
     // Unreachable destination (ie, infeasible flow)
     if (!(graphMinDist[q + origin_c] < IlcInfinity)) // Destination is origin_c, where we have flow deficit
         return -1;
@@ -528,16 +795,16 @@ inline IlcFloat IlcWCSS_NetworkCardControlI::getDeltaObj(IlcInt origin_i, IlcInt
 
 
 // Function which returns an engine handle (IlcConstraintI*) for the constraint implementation IlcWCSS_NetworkCardControlI
-IlcConstraint IlcWCSS_NetworkCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data) {
+IlcConstraint IlcWCSS_NetworkCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) {
     IlcCPEngine cp = X.getCPEngine(); // Get CP engine from variable array
-    return new (cp.getHeap()) IlcWCSS_NetworkCardControlI(cp, X, V, data);
+    return new (cp.getHeap()) IlcWCSS_NetworkCardControlI(cp, X, V, data, propagation);
 }
 
 
 // Macro which wraps the engine constraint handle into a modeling layer (Concert Technology) extractable object
 //     For some reason, ILOCPCONSTRAINTWRAPPERn doesn't work with reference types; have to use pointer to _datao
-ILOCPCONSTRAINTWRAPPER3(IloWCSS_NetworkCardControl, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao) {
+ILOCPCONSTRAINTWRAPPER4(IloWCSS_NetworkCardControl, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao, const PropagationParameters*, _propagationo) {
     use(cp, _Xo); // Force extraction of modeling layer extractables (ie, get engine level objects)
     use(cp, _Vo);
-    return IlcWCSS_NetworkCardControl(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao);
+    return IlcWCSS_NetworkCardControl(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao, _propagationo);
 }
\ No newline at end of file
@@ -32,6 +32,27 @@
 // Problem data structure
 #include "Data.h"
 
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Cannot-link constraints
+#include "CannotLinkGraph.h"
+
+// Observation weights
+#include "ObservationWeights.h"
+
+// Coordinate-space bound
+#include "CentroidBound.h"
+
+// Bounds of subproblems met on other paths
+#include "TranspositionTable.h"
+
+// Scheduling of cost-based filtering
+#include "PropagationSchedule.h"
+
+// Nogoods learned from bound failures
+#include "NogoodStore.h"
+
 // Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
 #include <ilcp/cpext.h>
 
@@ -50,6 +71,9 @@ protected:
     inline IlcFloat getDeltaObj(IlcInt origin_i, IlcInt origin_c, IlcInt target_c);
     IlcFloat deltaObj;
 
+    void propagateTwoClusters(); // Closed-form bound and filtering when _k == 2, without CPLEX
+    std::vector<std::pair<IlcFloat, IlcInt> > costDifferences; // (cost to cluster 0 - cost to cluster 1, index in U) of points free to go either way
+
     IlcRevInt* destination;
     IlcRevBool* varWasFixed;
 
@@ -62,7 +86,17 @@ protected:
     IlcIntVarArray _X; // Point assignments
     IlcFloatVar _V; // total WCSS
 
+    CannotLinkGraph cannotLinks;
+    ObservationWeights weights;
+    CentroidBound centroids;
+    PropagationSchedule schedule;
+    NogoodStore nogoods;
+
     // In propagate
+    DomainSnapshot domains;
+    std::vector<DomainWord> fullClusters;
+    std::vector<IlcInt> candidateCount;
+
     std::vector<IlcInt> setU_unassigned;
     std::vector<IlcInt>* setP_assigned;
 
@@ -82,15 +116,20 @@ protected:
     IlcInt max_clust_completion;
     IlcInt cluster_not_filled_counter;
     IlcRevBool** hasFlow;
+    IlcRevBool** isSaturated; // Differs from hasFlow only for points of weight > 1 split between clusters by the MCF
+
+    TranspositionTable transpositions; // MCF bound and flow of subproblems already solved, see TranspositionTable.h
+    std::vector<IlcInt> clusterRanks;
+    std::vector<std::uint64_t> flowBits;
 
     double _epsc;
 
 public:
-    IlcWCSS_NetworkCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data);
+    IlcWCSS_NetworkCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation);
     ~IlcWCSS_NetworkCardControlI();
     virtual void propagate();
     virtual void post();
     IlcIntVarArray getEngineVars() { return _X; }
 };
 
-IlcConstraint IlcWCSS_NetworkCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data);
\ No newline at end of file
+IlcConstraint IlcWCSS_NetworkCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation = NULL);
\ No newline at end of file
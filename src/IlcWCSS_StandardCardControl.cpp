@@ -29,7 +29,7 @@
 #include "IlcWCSS_StandardCardControl.h"
 
 
-IlcWCSS_StandardCardControlI::IlcWCSS_StandardCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data) : 
+IlcWCSS_StandardCardControlI::IlcWCSS_StandardCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) : 
 IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.getSize()), _k(data.K) {
     // Populate _targetCards
     _targetCards = IlcIntArray(cp, _k);
@@ -39,10 +39,37 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     // Make sure everything's cute
     assert(_targetCards.getSize() == _k); // number of indicated cards is same as clusters
 
+    // Observation weights, cardinalities are counted in units (a point of weight w is w units)
+    weights.build(data, _n);
+
+    // Coordinate-space bound on the objective, if enabled and coordinates are given (see CentroidBound.h)
+    centroids.build(data, _n, propagation);
+
+    // When to run the V_prime loop and shaving, adaptive if requested (see PropagationSchedule.h)
+    schedule.build(propagation, _n);
+
+    // Nogoods learned from bound failures, if requested (see NogoodStore.h)
+    nogoods.build(data, _n, propagation);
+
     IlcInt ctrl_nb_pts = 0;
     for (int c = 0; c < _k; c++)
         ctrl_nb_pts += _targetCards[c];
-    assert(ctrl_nb_pts == _n); // number of indicated points is same as problem size
+    assert(ctrl_nb_pts == weights.getTotal()); // number of indicated units is same as problem size
+
+    // Snapshot of domains of X, taken at the start of each propagation
+    domains.resize(_n, _k);
+
+    // Must-links are not propagated, the instance must be contracted first (see CannotLinkGraph.h)
+    assert(data.nbMustLinks == 0);
+
+    // Cannot-link constraints (see CannotLinkGraph.h for why they are propagated here)
+    cannotLinks.build(data, _n);
+
+    // Mask of clusters which are filled to their target cardinality
+    fullClusters.assign(domains.getNbWordsPerVar(), 0);
+
+    // Number of free units which can still join each cluster c
+    candidateCount.assign(_k, 0);
 
     // sets of points and their sizes
     setP_assigned = new (cp.getHeap()) std::vector<IlcInt>[_k]; // setP_assigned[c] = i means point i is assigned to cluster c
@@ -53,7 +80,8 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     // lower bound of WCSS of each cluster c
     lb_schedule = new (cp.getHeap()) IlcFloat*[_k];
     for (int i = 0; i < _k; i++)
-        lb_schedule[i] = new (cp.getHeap()) IlcFloat[2]; // lb_schedule[c][m] is lower bound on WCSS if c completed target (cardinality - m).
+        lb_schedule[i] = new (cp.getHeap()) IlcFloat[_targetCards[i] + 1]; // lb_schedule[c][m] is lower bound on WCSS if c completed target (cardinality - m).
+                                                                           // m = 0 for the global bound, m = weight of the point being filtered otherwise.
 
     // Sum of dissimilarities of each cluster c
     S1 = IlcFloatArray(cp, _k); // S1[c] = sum of dissimilarities (squared) of cluster c 
@@ -61,10 +89,10 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     // Sum of dissimilarities (squared) between each unassigned point and each cluster
     s2 = new (cp.getHeap()) IlcFloat*[_n]; // Allocation on engine heap for efficient and unified memory control
     for (int i = 0; i < _n; i++)
-        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between x and all points in cluster c
+        s2[i] = new (cp.getHeap()) IlcFloat[_k]; // s2[x][c] = sum of dissimilarities between one unit of x and all units in cluster c
 
     // Smallest 1/2 contribution of each unassigned point together with m other points
-    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free points brought along in addition to x
+    s3 = new (cp.getHeap()) std::vector<IlcFloat>[_n]; // s3[x][m] = smallest contribution of the m other free units brought along in addition to one unit of x
 
     // Global lower bound
     lb_global = 0;
@@ -75,7 +103,7 @@ IlcConstraintI(cp), _X(X), _V(V), _dissimilarities(data.dissimilarities), _n(X.g
     // Lower bound of active cluster under assumption to house active point in filtering
     lb_prime = 0;
 
-    // Number of points to add in cluster c to completion
+    // Number of units to add in cluster c to completion
     nb_points_to_add = IlcIntArray(cp, _k);
 
     // This espsilon is subtracted from the computed lower bound to prevent false backtracking while comparing with upper bound due to rounding errors
@@ -103,11 +131,14 @@ void IlcWCSS_StandardCardControlI::propagate() {
         setP_assigned[c].clear();
     p = 0;
 
+    // One pass of engine calls, every subsequent domain test is done on the snapshot
+    domains.take(_X);
+
     // Populating sets and definition of partial problem
     for (int i = 0; i < _n; i++) {
-        if (_X[i].isFixed()) {
+        if (domains.isFixed(i)) {
             p++;
-            setP_assigned[_X[i].getValue()].push_back(i);
+            setP_assigned[domains.getValue(i)].push_back(i);
         }
         else {
             q++;
@@ -118,7 +149,7 @@ void IlcWCSS_StandardCardControlI::propagate() {
     // Size of each cluster c and how many points to add
     max_clust_completion = 0; // Max number of points to add, all clusters considered
     for (IlcInt c = 0; c < _k; c++) {
-        sizeCluster[c] = setP_assigned[c].size(); // sizeCluster[c] = m means c is size m
+        sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m (in units)
         nb_points_to_add[c] = _targetCards[c] - sizeCluster[c];
 
         if (nb_points_to_add[c] < 0) // Constraint is violated if a cluster is overfilled
@@ -135,35 +166,52 @@ void IlcWCSS_StandardCardControlI::propagate() {
         // Nothing has yet changed entering this loop
         prelimFilteringVarWasFixed = false;
 
-        // Filter values if corresponding clusters are filled
-        for (IlcInt c = 0; c < _k; c++) {
-            if (nb_points_to_add[c] == 0) {
-                std::vector<IlcInt>::iterator setU_iter = setU_unassigned.begin();
-
-                while (setU_iter != setU_unassigned.end()) {
-                    if (_X[*setU_iter].isInDomain(c)) {
-                        _X[*setU_iter].removeValue(c); // Careful, a variable could get bound here, hence the whole reason this "do... while" exists in the first place
-
-                        if (_X[*setU_iter].isFixed()) {
-                            prelimFilteringVarWasFixed = true;
-                            setP_assigned[_X[*setU_iter].getValue()].push_back(*setU_iter); p++;
-                            setU_iter = setU_unassigned.erase(setU_iter); q--; 
-                        } else {
-                            ++setU_iter;
-                        }
-                    } else {
-                        ++setU_iter;
-                    }
-                }
-            }
+        // Cannot-links: clusters of fixed points are removed from the free points they are cannot-linked to
+        IlcInt nbCannotLinkRemovals = cannotLinks.propagate(_X, domains);
+        if (nbCannotLinkRemovals < 0)
+            fail(); // Two cannot-linked points in the same cluster
+
+        // Nogoods learned from earlier bound failures
+        IlcInt nbNogoodRemovals = nogoods.isEnabled() ? nogoods.propagate(_X, domains) : 0;
+        if (nbNogoodRemovals < 0)
+            fail(); // A partial assignment already known to fail
+
+        // Filter values if corresponding clusters are filled, all filled clusters at once
+        //     With weights, a cluster is also closed to the points heavier than what it has left to house
+        IlcInt nbNewlyFixed;
+        if (weights.isUnit()) {
+            for (IlcInt b = 0; b < (IlcInt) fullClusters.size(); b++)
+                fullClusters[b] = 0;
+            for (IlcInt c = 0; c < _k; c++)
+                if (nb_points_to_add[c] == 0)
+                    fullClusters[c >> 6] |= ((DomainWord) 1) << (c & 63);
+
+            nbNewlyFixed = domains.removeValues(_X, fullClusters.data(), setU_unassigned.data(), q); // Careful, a variable could get bound here, hence the whole reason this "do... while" exists in the first place
+        }
+        else {
+            nbNewlyFixed = weights.removeOversized(_X, domains, nb_points_to_add, setU_unassigned.data(), q);
         }
 
+        if (nbNewlyFixed < 0)
+            fail(); // A point can't go anywhere
+
         // If some variable was fixed, update sets and subproblem characteristics
-        if (prelimFilteringVarWasFixed) {
+        if (nbNewlyFixed > 0 || nbCannotLinkRemovals > 0 || nbNogoodRemovals > 0) {
+            std::vector<IlcInt>::iterator setU_iter = setU_unassigned.begin();
+            while (setU_iter != setU_unassigned.end()) {
+                if (domains.isFixed(*setU_iter)) {
+                    prelimFilteringVarWasFixed = true;
+                    setP_assigned[domains.getValue(*setU_iter)].push_back(*setU_iter); p++;
+                    setU_iter = setU_unassigned.erase(setU_iter); q--;
+                } else {
+                    ++setU_iter;
+                }
+            }
+
             // Size of each cluster c and how many points to add
             max_clust_completion = 0; // max number of points to add all clusters considered
             for (IlcInt c = 0; c < _k; c++) {
-                sizeCluster[c] = setP_assigned[c].size(); // sizeCluster[c] = m means c is size m
+                sizeCluster[c] = weights.sum(setP_assigned[c].data(), setP_assigned[c].size()); // sizeCluster[c] = m means c is size m (in units)
                 nb_points_to_add[c] = _targetCards[c] - sizeCluster[c];
 
                 if (nb_points_to_add[c] < 0) // Constraint is violated if a cluster is overfilled
@@ -175,32 +223,33 @@ void IlcWCSS_StandardCardControlI::propagate() {
         }
     } while (prelimFilteringVarWasFixed);
 
+    // A cluster which can't reach its target cardinality with the free points that may still join it is a dead end
+    weights.sumCandidates(domains, candidateCount.data(), setU_unassigned.data(), q);
+    for (IlcInt c = 0; c < _k; c++)
+        if (candidateCount[c] < nb_points_to_add[c])
+            fail();
+
     // If no points are assigned, which can happen when posting this constraint, there is no work to be done
     if (q == _n) {
         _X[0].setValue(0); // The first point must be assigned to 0 in all cases when symmetry-breaking constraints are active
         return;
     }
 
-    // lower bound of WCSS of each cluster c if we add m points to it > INIT
-    for (int c = 0; c < _k; c++)
-        for (int m = 0; m < 2; m++)
-            lb_schedule[c][m] = 0; // lb_schedule[c][m] is lower bound on WCSS if c completed target (cardinality - m).
-
-    // Sum of dissimilarities of each cluster c
+    // Sum of dissimilarities of each cluster c (between units)
     for (int c = 0; c < _k; c++) {
         S1[c] = 0;
-        for (int i = 0; i < (sizeCluster[c] - 1); i++)
-            for (int j = i + 1; j < sizeCluster[c]; j++)
-                S1[c] += _dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
+        for (int i = 0; i < ((IlcInt) setP_assigned[c].size() - 1); i++)
+            for (int j = i + 1; j < (IlcInt) setP_assigned[c].size(); j++)
+                S1[c] += weights[setP_assigned[c][i]]*weights[setP_assigned[c][j]]*_dissimilarities[setP_assigned[c][i]][setP_assigned[c][j]];
     }
 
-    // Sum of dissimilarities between each unassigned point and each cluster
+    // Sum of dissimilarities between (one unit of) each unassigned point and each cluster
     for (int i = 0; i < q; i++) { // for each unassigned point
         for (int c = 0; c < _k; c++) { // for each cluster
-            if (nb_points_to_add[c] > 0 && _X[setU_unassigned[i]].isInDomain(c)) { // if unassigned point i can be assigned to cluster c
+            if (nb_points_to_add[c] > 0 && domains.isInDomain(setU_unassigned[i], c)) { // if unassigned point i can be assigned to cluster c
                 s2[i][c] = 0;
-                for (int j = 0; j < sizeCluster[c]; j++) { // for each point j in cluster c
-                    s2[i][c] += _dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
+                for (int j = 0; j < (IlcInt) setP_assigned[c].size(); j++) { // for each point j in cluster c
+                    s2[i][c] += weights[setP_assigned[c][j]]*_dissimilarities[setU_unassigned[i]][setP_assigned[c][j]];
                 }
             }
             else { // else, unassigned point i can't be part of cluster c, set to infinity to exclude
@@ -209,42 +258,35 @@ void IlcWCSS_StandardCardControlI::propagate() {
         }
     }
 
-    // Smallest 1/2 contribution of each unassigned point together with m other points
+    // Smallest 1/2 contribution of each unassigned point together with m other units
     //     We only need to study adding max_clust_completion
     for (int i = 0; i < q; i++) {
-        s3[i].clear();
-        for (int j = 0; j < q; j++) {
-            // At first, we put all points in that list
-            s3[i].push_back(_dissimilarities[setU_unassigned[i]][setU_unassigned[j]] / 2);
-        }
-
-        std::sort(s3[i].begin(), s3[i].end()); // sort distances for each point, first element 0 because d(x,x) = 0
-
-        for (int j = 1; j < max_clust_completion; j++)
-            s3[i][j] += s3[i][j - 1]; // Compute minimum 1/2 contributions, first element is 0
+        cannotLinks.markPartners(setU_unassigned[i]);
+        weights.fillHalfContributions(setU_unassigned[i], setU_unassigned.data(), q, _dissimilarities, cannotLinks, max_clust_completion, s3[i]);
     }
 
     // Computing lower bound for each cluster
-    //     We only need to study adding discreet amounts of points
+    //     We only need to study adding discreet amounts of units, all of them at the same contribution per unit
+    //     (completing c), hence a single sort for every m
     for (int c = 0; c < _k; c++) { // for each cluster
-        for (int m = 0; m < 2; m++) { // if we add (nb_points_to_add[c] - m) points to c
-            std::vector<IlcFloat> s; // s of every point x with current m possibilities
-            for (int i = 0; i < q; i++) { // contribution for each unassigned point, must consider them all for sorting
-                if ((nb_points_to_add[c] - m) > 0) { // if we have points to add
-                    s.push_back(s2[i][c] + s3[i][(nb_points_to_add[c]) - 1]);
-                }
-                else {
-                    s.push_back(0); // not adding anything, this is actually useless
-                }
-            }
+        if (nb_points_to_add[c] == 0) {
+            lb_schedule[c][0] = S1[c] / _targetCards[c];
+            continue;
+        }
 
-            std::sort(s.begin(), s.end()); // sorting candidate points...
+        s.clear();
+        for (int i = 0; i < q; i++) // contribution for each unit of each unassigned point, must consider them all for sorting
+            s.push_back(WeightedContribution(s2[i][c] + s3[i][(nb_points_to_add[c]) - 1], weights[setU_unassigned[i]]));
 
-            IlcFloat S2 = 0;
-            for (int i = 0; i < (nb_points_to_add[c] - m); i++) // ... of which we select the (nb_points_to_add[c] - m) points that induce the lowest cost
-                S2 += s[i];
+        // lb_schedule[c][m] temporarily holds the sum of the (nb_points_to_add[c] - m) smallest contributions (S2)
+        ObservationWeights::sumSmallestUnits(s, nb_points_to_add[c], lb_schedule[c]);
+        std::reverse(lb_schedule[c], lb_schedule[c] + nb_points_to_add[c] + 1);
 
-            lb_schedule[c][m] = (S1[c] + S2) / (nb_points_to_add[c] + sizeCluster[c] - m); // -m because at some point we take one fewer point (max m = 1).
+        for (int m = 0; m <= nb_points_to_add[c]; m++) { // if we add (nb_points_to_add[c] - m) units to c
+            if (_targetCards[c] - m > 0)
+                lb_schedule[c][m] = (S1[c] + lb_schedule[c][m]) / (_targetCards[c] - m); // -m because at some point we take m fewer units (m = weight of filtered point).
+            else
+                lb_schedule[c][m] = 0;
         }
     }
 
@@ -254,42 +296,149 @@ void IlcWCSS_StandardCardControlI::propagate() {
     for (int c = 0; c < _k; c++)
         lb_global += lb_schedule[c][0];
 
-    // Filter objective
-    _V.setMin(lb_global - _epsc); // lb_global and _V.getMax() have slightly different values (rounding errors). 
+    // Filter objective, also with the coordinate-space bound if available (filtering below relies on the per cluster bounds only)
+    IlcFloat lb_objective = lb_global;
+    if (centroids.isEnabled())
+        lb_objective = std::max(lb_objective, centroids.compute(setP_assigned, setU_unassigned.data(), q, domains, _targetCards, nb_points_to_add, weights));
+    // Nodes fail and values are filtered against the incumbent lowered by the relative gap, if any (see PropagationSchedule::getPruningBound)
+    const IlcFloat ub_pruning = schedule.getPruningBound(_V.getMax());
+    const IlcFloat ub_nogoods = schedule.getIncumbentBound(); // Nogoods hold in the whole tree, unlike the upper bound of V
+    if (nogoods.isEnabled() && lb_objective - _epsc > ub_nogoods)
+        nogoods.learn(setP_assigned, ub_nogoods, _epsc); // The node fails below, record a subset of the fixed points which fails as well
+    if (lb_objective - _epsc > ub_pruning)
+        fail();
+    _V.setMin(lb_objective - _epsc); // lb_global and _V.getMax() have slightly different values (rounding errors). 
                                   // This means, sometimes, failure occurs when near a new, improving solution even though it shouldn't.
                                   // Removing a small epsilon solves the problem.
                                   // In an abundance of caution, apply as large an epsilon as possible. In this case, higher precision is superfluous.
                                   // Seriously, rounding errors are the devil.
 
+    // V_prime loop, unless delayed
+    if (!schedule.shouldFilter(p, lb_global, ub_pruning))
+        return;
+    IlcInt nbRemovals = 0;
+
+    bool cannotLinkedVarWasFixed = false;
+    shavingCandidates.clear();
+
     for (int c = 0; c < _k; c++) { // for each value c in domains of points, ie for each cluster
         lb_except = lb_global - lb_schedule[c][0]; // Remove contribution of cluster c
 
         for (int i = 0; i < q; i++) {
-            if (_X[setU_unassigned[i]].isInDomain(c)) { // for each i point in U such that c is in domain of var i
-                lb_prime = ((nb_points_to_add[c] + sizeCluster[c] - 1)*lb_schedule[c][1] + s2[i][c] + s3[i][nb_points_to_add[c] - 1]) / (nb_points_to_add[c] + sizeCluster[c]);
+            if (domains.isInDomain(setU_unassigned[i], c)) { // for each i point in U such that c is in domain of var i
+                const IlcInt w = weights[setU_unassigned[i]]; // i completes c along with (nb_points_to_add[c] - w) other units
+                assert(w <= nb_points_to_add[c]);
+
+                lb_prime = ((_targetCards[c] - w)*lb_schedule[c][w] + w*(s2[i][c] + s3[i][nb_points_to_add[c] - 1])) / _targetCards[c];
 
                 V_prime = lb_except + lb_prime; // Add updated contribution of cluster c
 
                 // If new objective exceeds incumbent cost
-                if (V_prime >= _V.getMax()) {
+                if (V_prime >= ub_pruning) {
                     _X[setU_unassigned[i]].removeValue(c);
+                    domains.removeValue(setU_unassigned[i], c);
+                    nbRemovals++;
+
+                    if (domains.getSize(setU_unassigned[i]) == 1 && cannotLinks.hasPartners(setU_unassigned[i]))
+                        cannotLinkedVarWasFixed = true;
+                }
+                else if (schedule.isShavingEnabled()) {
+                    shavingCandidates.push_back(std::make_pair(V_prime, i*_k + c));
                 }
             }
         }
     }
+
+    schedule.record(nbRemovals);
+
+    // Shaving: kept values closest to being filtered first, each tentatively assigned against the full bound, for as
+    //     long as the budget allows. Refutations are applied once all probes are done, probes share the state above.
+    if (!shavingCandidates.empty() && schedule.shouldShave(p, lb_global, ub_pruning)) {
+        std::sort(shavingCandidates.begin(), shavingCandidates.end(), std::greater<std::pair<IlcFloat, IlcInt> >());
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        IlcInt nbProbes = 0;
+        shavingRefuted.clear();
+
+        for (const std::pair<IlcFloat, IlcInt>& candidate : shavingCandidates) {
+            if (nbProbes > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= schedule.getShavingBudget())
+                break;
+
+            nbProbes++;
+            if (getTentativeBound(candidate.second / _k, candidate.second % _k) >= ub_pruning)
+                shavingRefuted.push_back(candidate.second);
+        }
+
+        schedule.recordShaving(nbProbes, shavingRefuted.size());
+
+        for (IlcInt code : shavingRefuted) {
+            const IlcInt i = code / _k, c = code % _k;
+            _X[setU_unassigned[i]].removeValue(c);
+            domains.removeValue(setU_unassigned[i], c);
+
+            if (domains.getSize(setU_unassigned[i]) == 1 && cannotLinks.hasPartners(setU_unassigned[i]))
+                cannotLinkedVarWasFixed = true;
+        }
+    }
+
+    // Points fixed above have partners to update (see CannotLinkGraph.h)
+    if (cannotLinkedVarWasFixed)
+        push();
+}
+
+
+// Global lower bound if the i-th unassigned point were assigned to cluster c, computed from the state of propagate.
+//     S1 and s2 of c are updated with the point, which no longer competes for any cluster, and its cannot-linked partners
+//     no longer compete for c. s3 is reused as is: the point can't be among the companions of the others anymore, so the
+//     actual contributions are only larger. IlcInfinity if some cluster can't be completed.
+IlcFloat IlcWCSS_StandardCardControlI::getTentativeBound(IlcInt i, IlcInt c) {
+    const IlcInt point = setU_unassigned[i];
+    const IlcInt w = weights[point];
+
+    cannotLinks.markPartners(point);
+
+    IlcFloat lb = 0;
+    for (IlcInt c2 = 0; c2 < _k; c2++) {
+        const IlcInt toAdd = nb_points_to_add[c2] - ((c2 == c) ? w : 0);
+        const IlcFloat S1c = S1[c2] + ((c2 == c) ? w*s2[i][c] : 0);
+
+        if (toAdd == 0) {
+            lb += S1c / _targetCards[c2];
+            continue;
+        }
+
+        s.clear();
+        for (IlcInt j = 0; j < q; j++) {
+            if (j == i || s2[j][c2] == IlcInfinity || (c2 == c && cannotLinks.isMarked(setU_unassigned[j])))
+                continue;
+
+            IlcFloat contribution = s2[j][c2] + s3[j][toAdd - 1];
+            if (c2 == c)
+                contribution += w*_dissimilarities[point][setU_unassigned[j]];
+            s.push_back(WeightedContribution(contribution, weights[setU_unassigned[j]]));
+        }
+
+        const IlcFloat S2 = ObservationWeights::sumSmallestUnits(s, toAdd);
+        if (S2 == IlcInfinity)
+            return IlcInfinity;
+
+        lb += (S1c + S2) / _targetCards[c2];
+    }
+
+    return lb;
 }
 
 
 // Function which returns an engine handle (IlcConstraintI*) for the constraint implementation IlcWCSS_StandardCardControlI
-IlcConstraint IlcWCSS_StandardCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data) {
+IlcConstraint IlcWCSS_StandardCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation) {
     IlcCPEngine cp = X.getCPEngine();
-    return new (cp.getHeap()) IlcWCSS_StandardCardControlI(cp, X, V, data);
+    return new (cp.getHeap()) IlcWCSS_StandardCardControlI(cp, X, V, data, propagation);
 }
 
 
 // Macro which wraps the engine constraint handle into a modeling layer (Concert Technology) extractable object
-ILOCPCONSTRAINTWRAPPER3(IloWCSS_StandardCardControl, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao) {
+ILOCPCONSTRAINTWRAPPER4(IloWCSS_StandardCardControl, cp, IloIntVarArray, _Xo, IloFloatVar, _Vo, const Data*, _datao, const PropagationParameters*, _propagationo) {
     use(cp, _Xo);
     use(cp, _Vo);
-    return IlcWCSS_StandardCardControl(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao);
+    return IlcWCSS_StandardCardControl(cp.getIntVarArray(_Xo), cp.getFloatVar(_Vo), *_datao, _propagationo);
 }
\ No newline at end of file
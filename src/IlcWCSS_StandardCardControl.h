@@ -28,11 +28,33 @@
 
 // Vector and vector operations
 #include <algorithm>
+#include <functional>
 #include <vector>
 
+// Shaving budget
+#include <chrono>
+
 // Problem data structure
 #include "Data.h"
 
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Cannot-link constraints
+#include "CannotLinkGraph.h"
+
+// Observation weights
+#include "ObservationWeights.h"
+
+// Coordinate-space bound
+#include "CentroidBound.h"
+
+// Scheduling of cost-based filtering
+#include "PropagationSchedule.h"
+
+// Nogoods learned from bound failures
+#include "NogoodStore.h"
+
 // Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
 #include <ilcp/cpext.h>
 
@@ -54,7 +76,17 @@ protected:
     IlcIntVarArray _X; // Point assignments
     IlcFloatVar _V; // total WCSS
 
+    CannotLinkGraph cannotLinks;
+    ObservationWeights weights;
+    CentroidBound centroids;
+    PropagationSchedule schedule;
+    NogoodStore nogoods;
+
     // In propagate
+    DomainSnapshot domains;
+    std::vector<DomainWord> fullClusters;
+    std::vector<IlcInt> candidateCount;
+
     std::vector<IlcInt> setU_unassigned;
     std::vector<IlcInt>* setP_assigned;
 
@@ -65,6 +97,7 @@ protected:
     IlcFloatArray S1;
     IlcFloat** s2;
     std::vector<IlcFloat>* s3;
+    std::vector<WeightedContribution> s;
 
     IlcFloat lb_global;
 
@@ -76,14 +109,20 @@ protected:
     IlcInt max_clust_completion;
     IlcFloat V_prime;
 
+    // Shaving (see PropagationSchedule.h)
+    std::vector<std::pair<IlcFloat, IlcInt> > shavingCandidates; // (V_prime, i*_k + c) of the values kept by filtering
+    std::vector<IlcInt> shavingRefuted;
+
     double _epsc;
 
+    IlcFloat getTentativeBound(IlcInt i, IlcInt c);
+
 public:
-    IlcWCSS_StandardCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data);
+    IlcWCSS_StandardCardControlI(IloCPEngine cp, IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation);
     ~IlcWCSS_StandardCardControlI();
     virtual void propagate();
     virtual void post();
     IlcIntVarArray getEngineVars() { return _X; }
 };
 
-IlcConstraint IlcWCSS_StandardCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data);
\ No newline at end of file
+IlcConstraint IlcWCSS_StandardCardControl(IlcIntVarArray X, IlcFloatVar V, const Data& data, const PropagationParameters* propagation = NULL);
\ No newline at end of file
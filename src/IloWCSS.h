@@ -28,4 +28,9 @@
 #include "IlcWCSS.h"
 
 
-IloConstraint IloWCSS(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0);
\ No newline at end of file
+// propagation may be NULL (filtering at every propagation), otherwise it must outlive the model's extraction
+IloConstraint IloWCSS(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const PropagationParameters* propagation, const char* name = 0);
+
+inline IloConstraint IloWCSS(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0) {
+    return IloWCSS(env, X, V, data, (const PropagationParameters*) NULL, name);
+}
\ No newline at end of file
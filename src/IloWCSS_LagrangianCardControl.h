@@ -0,0 +1,28 @@
+/*
+ * This constraint should be used in conjunction with an appropriate model to speedup exact Minimum Sum of Squares Clustering with pre-set, strict cluster cardinalities.
+ * It bounds the WCSS as IloWCSS_NetworkCardControl does, but through a Lagrangian relaxation of the cardinality constraints of its MCF,
+ *     whose multipliers are improved by subgradient steps warm-started along the search, rather than by solving the MCF with CPLEX.
+ *     For fixed multipliers, the bound and the filtering of all values take O(qk) time.
+ * The objective function is filtered through tightening of the lower bound.
+ * The reprentative variables are filtered through cost-based filtering against an upper bound decided by the best incumbent solution.
+ *
+ * Main arguments: * X, array of integer representative variables that link observations to their cluster.
+ *                 * V, WCSS of solution, must be constrained to take value of WCSS in Concert Technology model.
+ *
+ * Additional arguments: * data, refer to Data struct in Data.h for problem data nomenclature.
+ *
+ * Note: this constraint is also heavily dependent on the search strategy. Use IloMSSCSearchStrategy (IloGoal).
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include "IlcWCSS_LagrangianCardControl.h"
+
+
+// propagation may be NULL (filtering at every propagation), otherwise it must outlive the model's extraction
+IloConstraint IloWCSS_LagrangianCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const PropagationParameters* propagation, const char* name = 0);
+
+inline IloConstraint IloWCSS_LagrangianCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0) {
+    return IloWCSS_LagrangianCardControl(env, X, V, data, (const PropagationParameters*) NULL, name);
+}
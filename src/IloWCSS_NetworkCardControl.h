@@ -28,4 +28,9 @@
 #include "IlcWCSS_NetworkCardControl.h"
 
 
-IloConstraint IloWCSS_NetworkCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0);
\ No newline at end of file
+// propagation may be NULL (filtering at every propagation), otherwise it must outlive the model's extraction
+IloConstraint IloWCSS_NetworkCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const PropagationParameters* propagation, const char* name = 0);
+
+inline IloConstraint IloWCSS_NetworkCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0) {
+    return IloWCSS_NetworkCardControl(env, X, V, data, (const PropagationParameters*) NULL, name);
+}
\ No newline at end of file
@@ -29,4 +29,9 @@
 #include "IlcWCSS_StandardCardControl.h"
 
 
-IloConstraint IloWCSS_StandardCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0);
\ No newline at end of file
+// propagation may be NULL (filtering at every propagation), otherwise it must outlive the model's extraction
+IloConstraint IloWCSS_StandardCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const PropagationParameters* propagation, const char* name = 0);
+
+inline IloConstraint IloWCSS_StandardCardControl(IloEnv env, IloIntVarArray X, IloFloatVar V, const Data* data, const char* name = 0) {
+    return IloWCSS_StandardCardControl(env, X, V, data, (const PropagationParameters*) NULL, name);
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+/*
+ * Resident instances for long-lived processes.
+ * Refer to InstanceCache.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "InstanceCache.h"
+
+
+KnownBounds::KnownBounds() : objective(std::numeric_limits<double>::infinity()), bound(0), proven(false),
+provenGap(std::numeric_limits<double>::infinity()) {}
+
+
+CachedInstance::CachedInstance(const std::string& path_, long long modificationTime_, long long fileSize_) :
+path(path_), modificationTime(modificationTime_), fileSize(fileSize_) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("cannot open " + path);
+
+    int N, S, K;
+    if (!(in >> N >> S >> K) || N <= 0 || S <= 0 || K <= 0 || K > N)
+        throw std::runtime_error("bad header in " + path);
+
+    coordinateStorage.resize(N*(size_t) S);
+    for (size_t v = 0; v < coordinateStorage.size(); v++)
+        if (!(in >> coordinateStorage[v]))
+            throw std::runtime_error("missing coordinates in " + path);
+
+    // Target cardinalities are optional, but then complete
+    int target;
+    while (in >> target)
+        targetStorage.push_back(target);
+    if (!in.eof())
+        throw std::runtime_error("bad target cardinalities in " + path);
+    if (!targetStorage.empty()) {
+        long total = 0;
+        for (int t : targetStorage)
+            total += t;
+        if ((int) targetStorage.size() != K || total != N || *std::min_element(targetStorage.begin(), targetStorage.end()) <= 0)
+            throw std::runtime_error("target cardinalities do not match N and K in " + path);
+    }
+
+    coordinateRows.resize(N);
+    for (int i = 0; i < N; i++)
+        coordinateRows[i] = &coordinateStorage[i*(size_t) S];
+
+    // Squared euclidean distances, computed once for all solves of this instance
+    dissimilarityStorage.assign(N*(size_t) N, 0.0);
+    dissimilarityRows.resize(N);
+    for (int i = 0; i < N; i++)
+        dissimilarityRows[i] = &dissimilarityStorage[i*(size_t) N];
+    for (int i = 0; i < N - 1; i++)
+        for (int j = i + 1; j < N; j++) {
+            double d = 0;
+            for (int s = 0; s < S; s++) {
+                const double diff = coordinateRows[i][s] - coordinateRows[j][s];
+                d += diff*diff;
+            }
+            dissimilarityRows[i][j] = dissimilarityRows[j][i] = d;
+        }
+
+    data.fileID = path;
+    data.N = N;
+    data.S = S;
+    data.K = K;
+    data.coordinates = coordinateRows.data();
+    data.dissimilarities = dissimilarityRows.data();
+    data.targetCardinalities = targetStorage.empty() ? NULL : targetStorage.data();
+
+    nbBytes = sizeof(CachedInstance) + path.size() + (coordinateStorage.size() + dissimilarityStorage.size())*sizeof(double)
+              + (coordinateRows.size() + dissimilarityRows.size())*sizeof(double*) + targetStorage.size()*sizeof(int)
+              + 2*N*sizeof(int); // Known solutions
+}
+
+
+KnownBounds CachedInstance::getKnown(bool cardinalitiesKnown) const {
+    std::lock_guard<std::mutex> lock(boundsMutex);
+    return known[cardinalitiesKnown];
+}
+
+
+void CachedInstance::record(bool cardinalitiesKnown, double objective, const std::vector<int>& memberships, double bound,
+                            bool completed, double relativeGap) {
+    std::lock_guard<std::mutex> lock(boundsMutex);
+    KnownBounds& k = known[cardinalitiesKnown];
+
+    if (!memberships.empty() && objective < k.objective) {
+        k.objective = objective;
+        k.memberships = memberships;
+    }
+
+    k.bound = std::max(k.bound, bound);
+
+    if (completed && relativeGap < k.provenGap) {
+        k.proven = true;
+        k.provenGap = relativeGap;
+    }
+}
+
+
+InstanceCache::InstanceCache(size_t capacity) : _capacity(capacity), nbBytes(0), nbHits(0), nbMisses(0), nbEvictions(0) {}
+
+
+std::shared_ptr<CachedInstance> InstanceCache::get(const std::string& path) {
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0)
+        throw std::runtime_error("cannot open " + path);
+    const long long modificationTime = (long long) status.st_mtime, fileSize = (long long) status.st_size;
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto found = byPath.find(path);
+        if (found != byPath.end()) {
+            std::shared_ptr<CachedInstance> instance = *found->second;
+            if (instance->modificationTime == modificationTime && instance->fileSize == fileSize) {
+                instances.splice(instances.begin(), instances, found->second);
+                nbHits++;
+                return instance;
+            }
+
+            // Stale, solves in progress keep their copy
+            nbBytes -= instance->nbBytes;
+            instances.erase(found->second);
+            byPath.erase(found);
+        }
+        nbMisses++;
+    }
+
+    // Loaded without holding the lock, other instances remain available meanwhile
+    std::shared_ptr<CachedInstance> loaded = std::make_shared<CachedInstance>(path, modificationTime, fileSize);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = byPath.find(path);
+    if (found != byPath.end()) { // Loaded concurrently by another request
+        instances.splice(instances.begin(), instances, found->second);
+        return *found->second;
+    }
+
+    instances.push_front(loaded);
+    byPath[path] = instances.begin();
+    nbBytes += loaded->nbBytes;
+    evict();
+
+    return loaded;
+}
+
+
+void InstanceCache::evict() {
+    while (nbBytes > _capacity && instances.size() > 1) {
+        nbBytes -= instances.back()->nbBytes;
+        byPath.erase(instances.back()->path);
+        instances.pop_back();
+        nbEvictions++;
+    }
+}
+
+
+InstanceCacheStats InstanceCache::getStats() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    InstanceCacheStats stats;
+    stats.nbInstances = instances.size();
+    stats.nbBytes = nbBytes;
+    stats.nbHits = nbHits;
+    stats.nbMisses = nbMisses;
+    stats.nbEvictions = nbEvictions;
+
+    return stats;
+}
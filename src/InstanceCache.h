@@ -0,0 +1,110 @@
+/*
+ * Resident instances for long-lived processes (see MSSCDaemon.h), kept in least recently used order within a memory budget.
+ * An instance is identified by its file path, and reloaded if the file changed (modification time or size) since.
+ *
+ * Each instance keeps, besides its Data (dissimilarities precomputed), what previous solves learned about it: best known
+ *     solution, best lower bound and whether optimality (resp. infeasibility) was proven, separately for the general
+ *     MSSC and for the cardinality-constrained one. Later solves start from the best known solution, or are answered
+ *     directly once proven.
+ *
+ * Instance file format (text, whitespace separated):
+ *     N S K
+ *     N lines of S coordinates
+ *     Optionally, K target cardinalities
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __INSTANCE_CACHE_H
+#define __INSTANCE_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+
+// What is known about one problem (general or cardinality-constrained) on an instance
+struct KnownBounds {
+    double objective; // V of best known solution, infinity if none
+    std::vector<int> memberships; // Best known solution, empty if none
+    double bound; // Best known lower bound on V
+
+    bool proven; // Search completed: objective is optimal within provenGap, or there is no solution
+    double provenGap;
+
+    KnownBounds();
+};
+
+
+class CachedInstance {
+private:
+    // Storage behind data
+    std::vector<double> coordinateStorage, dissimilarityStorage;
+    std::vector<double*> coordinateRows, dissimilarityRows;
+    std::vector<int> targetStorage;
+
+    mutable std::mutex boundsMutex; // Protects known
+    KnownBounds known[2]; // Indexed by cardinalitiesKnown
+
+public:
+    const std::string path;
+    long long modificationTime, fileSize; // Identity of the file loaded
+
+    Data data; // Read only once cached, shared by concurrent solves
+    size_t nbBytes; // Memory held, for the cache budget
+
+    // Throws std::runtime_error if the file can't be read or is malformed
+    CachedInstance(const std::string& path, long long modificationTime, long long fileSize);
+
+    CachedInstance(const CachedInstance&) = delete;
+    CachedInstance& operator=(const CachedInstance&) = delete;
+
+    bool hasTargets() const { return data.targetCardinalities != NULL; }
+
+    KnownBounds getKnown(bool cardinalitiesKnown) const;
+
+    // Merge the outcome of a solve. completed means the search space was exhausted (optimal or infeasible) within relativeGap.
+    void record(bool cardinalitiesKnown, double objective, const std::vector<int>& memberships, double bound,
+                bool completed, double relativeGap);
+};
+
+
+struct InstanceCacheStats {
+    size_t nbInstances, nbBytes;
+    long long nbHits, nbMisses, nbEvictions;
+};
+
+
+class InstanceCache {
+private:
+    size_t _capacity; // Bytes
+
+    mutable std::mutex cacheMutex; // Protects everything below
+    std::list<std::shared_ptr<CachedInstance>> instances; // Most recently used first
+    std::unordered_map<std::string, std::list<std::shared_ptr<CachedInstance>>::iterator> byPath;
+    size_t nbBytes;
+    long long nbHits, nbMisses, nbEvictions;
+
+    void evict(); // Down to capacity, the most recently used instance is always kept
+
+public:
+    InstanceCache(size_t capacity);
+
+    InstanceCache(const InstanceCache&) = delete;
+    InstanceCache& operator=(const InstanceCache&) = delete;
+
+    // Cached instance of path, loaded if absent or stale. Evicted instances stay valid as long as they are referenced.
+    //     Throws std::runtime_error if the file can't be read or is malformed.
+    std::shared_ptr<CachedInstance> get(const std::string& path);
+
+    InstanceCacheStats getStats() const;
+};
+
+#endif // !__INSTANCE_CACHE_H
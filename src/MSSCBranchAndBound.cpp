@@ -0,0 +1,1062 @@
+/*
+ * Standalone depth-first branch-and-bound for cardinality-constrained MSSC.
+ * Refer to MSSCBranchAndBound.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "MSSCBranchAndBound.h"
+
+// Possible to use <limits> but eh...
+#define __MAX_INT 2147483647
+
+
+static const double infinity = std::numeric_limits<double>::infinity();
+
+#define __BB_CHECKPOINT_VERSION 1
+
+
+MSSCBranchAndBound::MSSCBranchAndBound(const Data& data, const BBParameters& parameters) :
+_data(data), _parameters(parameters), _n(data.N), _k(data.K), _w((data.K + 63) / 64),
+started(false), over(false), pendingPropagation(true), upperBound(infinity), rootBound(0), lastBound(0), epsilon(5e-5), nbNodes(0), nbFails(0), time(0),
+stopRequested(false) {
+    assert(isSupported(data));
+
+    // Full domains 0..K-1
+    words.assign(_n*(size_t) _w, 0);
+    for (int i = 0; i < _n; i++)
+        for (int c = 0; c < _k; c++)
+            words[i*_w + (c >> 6)] |= ((DomainWord) 1) << (c & 63);
+
+    // Adjacency of pairwise constraints
+    cannotLinkPartners.resize(_n);
+    for (int l = 0; l < data.nbCannotLinks; l++) {
+        cannotLinkPartners[data.cannotLinks[2*l]].push_back(data.cannotLinks[2*l + 1]);
+        cannotLinkPartners[data.cannotLinks[2*l + 1]].push_back(data.cannotLinks[2*l]);
+    }
+
+    mustLinkPartners.resize(_n);
+    for (int l = 0; l < data.nbMustLinks; l++) {
+        mustLinkPartners[data.mustLinks[2*l]].push_back(data.mustLinks[2*l + 1]);
+        mustLinkPartners[data.mustLinks[2*l + 1]].push_back(data.mustLinks[2*l]);
+    }
+
+    // Clusters of equal target cardinality are interchangeable, they are used in increasing order
+    precedingCluster.assign(_k, -1);
+    if (_parameters.symmetryBreaking)
+        for (int c = 1; c < _k; c++)
+            for (int c2 = c - 1; c2 >= 0; c2--)
+                if (data.targetCardinalities[c2] == data.targetCardinalities[c]) {
+                    precedingCluster[c] = c2;
+                    break;
+                }
+
+    setP.resize(_k);
+    nbToAdd.resize(_k);
+    S1.resize(_k);
+    lbCluster.resize(_k);
+    lbClusterLess.resize(_k);
+    openClusters.resize(_w);
+    isPartner.assign(_n, 0);
+
+    flowMembers.resize(_k);
+    flowLoad.resize(_k);
+    moveCost.resize(_k*(size_t) _k);
+    moveWitness.resize(_k*(size_t) _k);
+    pathCost.resize(_k*(size_t) _k);
+    label.resize(_k);
+    parent.resize(_k);
+    touched.resize(_k);
+}
+
+
+bool MSSCBranchAndBound::isSupported(const Data& data) {
+    if (data.K < 1 || data.N < data.K || data.dissimilarities == NULL || data.targetCardinalities == NULL)
+        return false;
+
+    long total = 0;
+    for (int c = 0; c < data.K; c++) {
+        if (data.targetCardinalities[c] <= 0)
+            return false;
+        total += data.targetCardinalities[c];
+    }
+    if (total != data.N)
+        return false;
+
+    if (data.weights != NULL)
+        for (int i = 0; i < data.N; i++)
+            if (data.weights[i] != 1)
+                return false;
+
+    return true;
+}
+
+
+bool MSSCBranchAndBound::setIncumbent(const int* memberships) {
+    assert(!started);
+
+    std::vector<int> cards(_k, 0);
+    for (int i = 0; i < _n; i++) {
+        if (memberships[i] < 0 || memberships[i] >= _k)
+            return false;
+        cards[memberships[i]]++;
+    }
+
+    for (int c = 0; c < _k; c++)
+        if (cards[c] != _data.targetCardinalities[c])
+            return false;
+
+    for (int l = 0; l < _data.nbMustLinks; l++)
+        if (memberships[_data.mustLinks[2*l]] != memberships[_data.mustLinks[2*l + 1]])
+            return false;
+    for (int l = 0; l < _data.nbCannotLinks; l++)
+        if (memberships[_data.cannotLinks[2*l]] == memberships[_data.cannotLinks[2*l + 1]])
+            return false;
+
+    std::vector<double> sums(_k, 0.0);
+    for (int i = 0; i < _n - 1; i++)
+        for (int j = i + 1; j < _n; j++)
+            if (memberships[i] == memberships[j])
+                sums[memberships[i]] += _data.dissimilarities[i][j];
+
+    double objective = 0;
+    for (int c = 0; c < _k; c++)
+        objective += sums[c] / cards[c];
+
+    if (!(objective < upperBound))
+        return false;
+
+    incumbent.assign(memberships, memberships + _n);
+    upperBound = objective;
+    return true;
+}
+
+
+/*
+ * Domain store
+ */
+
+int MSSCBranchAndBound::getSize(int i) const {
+    if (_w == 1)
+        return domainWordPopCount(words[i]);
+
+    int size = 0;
+    for (int b = 0; b < _w; b++)
+        size += domainWordPopCount(words[i*_w + b]);
+    return size;
+}
+
+
+int MSSCBranchAndBound::getValue(int i) const {
+    for (int b = 0; b < _w; b++)
+        if (words[i*_w + b] != 0)
+            return (b << 6) + domainWordLowestBit(words[i*_w + b]);
+    return -1;
+}
+
+
+bool MSSCBranchAndBound::removeValue(int i, int c) {
+    const int index = i*_w + (c >> 6);
+    const DomainWord bit = ((DomainWord) 1) << (c & 63);
+
+    if ((words[index] & bit) == 0)
+        return true;
+
+    trail.push_back(std::make_pair(index, words[index]));
+    words[index] &= ~bit;
+
+    return (_w == 1) ? (words[index] != 0) : (getSize(i) > 0);
+}
+
+
+void MSSCBranchAndBound::assign(int i, int c) {
+    for (int b = 0; b < _w; b++) {
+        const DomainWord word = (b == (c >> 6)) ? (((DomainWord) 1) << (c & 63)) : 0;
+        if (words[i*_w + b] != word) {
+            trail.push_back(std::make_pair(i*_w + b, words[i*_w + b]));
+            words[i*_w + b] = word;
+        }
+    }
+}
+
+
+bool MSSCBranchAndBound::restrictTo(int i, const DomainWord* mask) {
+    bool empty = true;
+    for (int b = 0; b < _w; b++) {
+        const DomainWord word = words[i*_w + b] & mask[b];
+        if (word != words[i*_w + b]) {
+            trail.push_back(std::make_pair(i*_w + b, words[i*_w + b]));
+            words[i*_w + b] = word;
+        }
+        empty = empty && (word == 0);
+    }
+
+    return !empty;
+}
+
+
+void MSSCBranchAndBound::undoTo(size_t mark) {
+    while (trail.size() > mark) {
+        words[trail.back().first] = trail.back().second;
+        trail.pop_back();
+    }
+}
+
+
+/*
+ * Propagation
+ */
+
+bool MSSCBranchAndBound::isPruned(double lb) const {
+    return (lb - epsilon) >= upperBound*(1 - _parameters.relativeGap);
+}
+
+
+bool MSSCBranchAndBound::propagate() {
+    bool fixedSome;
+    do {
+        if (!propagateStructure())
+            return false;
+
+        if (!propagateBound(fixedSome))
+            return false;
+    } while (fixedSome);
+
+    return true;
+}
+
+
+bool MSSCBranchAndBound::propagateStructure() {
+    int nbFixed = -1;
+
+    while (true) {
+        // Sets and subproblem characteristics
+        setU.clear();
+        for (int c = 0; c < _k; c++)
+            setP[c].clear();
+
+        for (int i = 0; i < _n; i++) {
+            if (getSize(i) == 1)
+                setP[getValue(i)].push_back(i);
+            else
+                setU.push_back(i);
+        }
+
+        maxToAdd = 0;
+        for (int c = 0; c < _k; c++) {
+            nbToAdd[c] = _data.targetCardinalities[c] - (int) setP[c].size();
+            if (nbToAdd[c] < 0)
+                return false; // Cluster overfilled
+            maxToAdd = std::max(maxToAdd, nbToAdd[c]);
+        }
+
+        // Stop once a pass fixes no variable
+        if (_n - (int) setU.size() == nbFixed)
+            break;
+        nbFixed = _n - (int) setU.size();
+
+        // Full clusters are closed to free points
+        std::fill(openClusters.begin(), openClusters.end(), 0);
+        for (int c = 0; c < _k; c++)
+            if (nbToAdd[c] > 0)
+                openClusters[c >> 6] |= ((DomainWord) 1) << (c & 63);
+
+        for (int i : setU)
+            if (!restrictTo(i, openClusters.data()))
+                return false;
+
+        // Cannot-links: the cluster of a fixed point is closed to its partners
+        for (int c = 0; c < _k; c++)
+            for (int i : setP[c])
+                for (int j : cannotLinkPartners[i])
+                    if (!removeValue(j, c))
+                        return false;
+
+        // Must-links: partners share their domains
+        for (int i = 0; i < _n; i++)
+            for (int j : mustLinkPartners[i])
+                if (!restrictTo(j, &words[i*_w]))
+                    return false;
+
+        // Value precedence: c can't be taken before (nor by) the first point which can take its preceding cluster
+        for (int c = 0; c < _k; c++) {
+            if (precedingCluster[c] == -1)
+                continue;
+
+            int first = 0;
+            while (first < _n && !isInDomain(first, precedingCluster[c]))
+                first++;
+
+            for (int i = 0; i <= first && i < _n; i++)
+                if (isInDomain(i, c) && !removeValue(i, c))
+                    return false;
+        }
+    }
+
+    // A cluster which can't reach its target cardinality with the free points that may still join it is a dead end
+    for (int c = 0; c < _k; c++) {
+        int candidates = 0;
+        for (int i : setU)
+            if (isInDomain(i, c))
+                candidates++;
+
+        if (candidates < nbToAdd[c])
+            return false;
+    }
+
+    return true;
+}
+
+
+void MSSCBranchAndBound::prepareContributions() {
+    const int q = (int) setU.size();
+    double const* const* const d = _data.dissimilarities;
+
+    // Sum of dissimilarities of each cluster
+    for (int c = 0; c < _k; c++) {
+        S1[c] = 0;
+        for (size_t a = 0; a + 1 < setP[c].size(); a++)
+            for (size_t b = a + 1; b < setP[c].size(); b++)
+                S1[c] += d[setP[c][a]][setP[c][b]];
+    }
+
+    // Sum of dissimilarities between each free point and each cluster it may join
+    s2.resize(q*(size_t) _k);
+    for (int u = 0; u < q; u++) {
+        for (int c = 0; c < _k; c++) {
+            double sum = infinity;
+            if (nbToAdd[c] > 0 && isInDomain(setU[u], c)) {
+                sum = 0;
+                for (int j : setP[c])
+                    sum += d[setU[u]][j];
+            }
+            s2[u*_k + c] = sum;
+        }
+    }
+
+    // Smallest 1/2 contributions of each free point together with m other free points, cannot-linked partners excluded
+    s3.resize(q*(size_t) std::max(maxToAdd, 1));
+    for (int u = 0; u < q; u++) {
+        for (int j : cannotLinkPartners[setU[u]])
+            isPartner[j] = 1;
+
+        sorted.clear();
+        for (int v = 0; v < q; v++)
+            sorted.push_back(isPartner[setU[v]] ? infinity : d[setU[u]][setU[v]] / 2);
+
+        for (int j : cannotLinkPartners[setU[u]])
+            isPartner[j] = 0;
+
+        std::partial_sort(sorted.begin(), sorted.begin() + maxToAdd, sorted.end()); // First element 0, d(x, x) = 0
+        double* row = &s3[u*(size_t) maxToAdd];
+        for (int m = 0; m < maxToAdd; m++)
+            row[m] = (m == 0) ? sorted[0] : (row[m - 1] + sorted[m]);
+    }
+}
+
+
+bool MSSCBranchAndBound::propagateBound(bool& fixedSome) {
+    fixedSome = false;
+
+    prepareContributions();
+
+    // Leaf: the bound is the objective
+    if (setU.empty()) {
+        lastBound = 0;
+        for (int c = 0; c < _k; c++)
+            lastBound += S1[c] / _data.targetCardinalities[c];
+
+        return lastBound < upperBound*(1 - _parameters.relativeGap);
+    }
+
+    bool failed = false;
+    if (_parameters.bound == CustomBBOptions::Bound::STANDARD_CARD_CONTROL)
+        lastBound = computeStandardBound(fixedSome, failed);
+    else
+        lastBound = computeNetworkBound(fixedSome, failed);
+
+    return !failed;
+}
+
+
+double MSSCBranchAndBound::computeStandardBound(bool& fixedSome, bool& failed) {
+    const int q = (int) setU.size();
+
+    // Per-cluster bounds, completing c with nbToAdd[c] points (lbCluster) or with one fewer (lbClusterLess)
+    double lb = 0;
+    for (int c = 0; c < _k; c++) {
+        const int target = _data.targetCardinalities[c], nb = nbToAdd[c];
+
+        if (nb == 0) {
+            lbCluster[c] = S1[c] / target;
+            lbClusterLess[c] = 0;
+            lb += lbCluster[c];
+            continue;
+        }
+
+        sorted.clear();
+        for (int u = 0; u < q; u++)
+            if (s2[u*_k + c] < infinity)
+                sorted.push_back(s2[u*_k + c] + s3[u*maxToAdd + nb - 1]);
+
+        if ((int) sorted.size() < nb) {
+            failed = true;
+            return infinity;
+        }
+
+        std::nth_element(sorted.begin(), sorted.begin() + (nb - 1), sorted.end());
+        double S2 = 0;
+        for (int m = 0; m < nb; m++)
+            S2 += sorted[m];
+
+        lbCluster[c] = (S1[c] + S2) / target;
+        lbClusterLess[c] = (target > 1) ? (S1[c] + S2 - sorted[nb - 1]) / (target - 1) : 0;
+        lb += lbCluster[c];
+    }
+
+    if (isPruned(lb)) {
+        failed = true;
+        return lb;
+    }
+
+    // Cost-based filtering, i completes c along with (nbToAdd[c] - 1) other points
+    for (int c = 0; c < _k; c++) {
+        const int target = _data.targetCardinalities[c], nb = nbToAdd[c];
+        if (nb == 0)
+            continue;
+
+        for (int u = 0; u < q; u++) {
+            if (!(s2[u*_k + c] < infinity))
+                continue;
+
+            const double lbPrime = ((target - 1)*lbClusterLess[c] + s2[u*_k + c] + s3[u*maxToAdd + nb - 1]) / target;
+            if (isPruned(lb - lbCluster[c] + lbPrime)) {
+                if (!removeValue(setU[u], c)) {
+                    failed = true;
+                    return lb;
+                }
+                fixedSome = fixedSome || (getSize(setU[u]) == 1);
+            }
+        }
+    }
+
+    return lb;
+}
+
+
+double MSSCBranchAndBound::computeNetworkBound(bool& fixedSome, bool& failed) {
+    const int q = (int) setU.size();
+
+    // Arc costs, as in the MCF of IlcWCSS_NetworkCardControl
+    arcCost.resize(q*(size_t) _k);
+    for (int u = 0; u < q; u++)
+        for (int c = 0; c < _k; c++)
+            arcCost[u*_k + c] = (s2[u*_k + c] < infinity) ? (s2[u*_k + c] + s3[u*maxToAdd + nbToAdd[c] - 1]) / _data.targetCardinalities[c] : infinity;
+
+    if (!solveTransportation()) {
+        failed = true;
+        return infinity;
+    }
+
+    double lb = 0;
+    for (int c = 0; c < _k; c++)
+        lb += S1[c] / _data.targetCardinalities[c];
+    for (int u = 0; u < q; u++)
+        lb += arcCost[u*_k + flowCluster[u]];
+
+    if (isPruned(lb)) {
+        failed = true;
+        return lb;
+    }
+
+    // Shortest paths between clusters in the residual graph (no negative cycle, the flow is optimal)
+    for (int a = 0; a < _k; a++)
+        for (int b = 0; b < _k; b++)
+            pathCost[a*_k + b] = (a == b) ? 0 : moveCost[a*_k + b];
+
+    for (int m = 0; m < _k; m++)
+        for (int a = 0; a < _k; a++)
+            if (pathCost[a*_k + m] < infinity)
+                for (int b = 0; b < _k; b++)
+                    if (pathCost[a*_k + m] + pathCost[m*_k + b] < pathCost[a*_k + b])
+                        pathCost[a*_k + b] = pathCost[a*_k + m] + pathCost[m*_k + b];
+
+    // Reduced costs: sending u to c instead of o pushes a point of c along a cheapest path back to o
+    for (int u = 0; u < q; u++) {
+        const int o = flowCluster[u];
+        for (int c = 0; c < _k; c++) {
+            if (c == o || !(arcCost[u*_k + c] < infinity))
+                continue;
+
+            const double delta = arcCost[u*_k + c] - arcCost[u*_k + o] + pathCost[c*_k + o]; // Infinite if no such path
+            if (isPruned(lb + delta)) {
+                if (!removeValue(setU[u], c)) {
+                    failed = true;
+                    return lb;
+                }
+                fixedSome = fixedSome || (getSize(setU[u]) == 1);
+            }
+        }
+    }
+
+    return lb;
+}
+
+
+void MSSCBranchAndBound::updateMoves(int a) {
+    for (int b = 0; b < _k; b++) {
+        moveCost[a*_k + b] = infinity;
+        moveWitness[a*_k + b] = -1;
+        if (b == a)
+            continue;
+
+        for (int u : flowMembers[a]) {
+            if (!(arcCost[u*_k + b] < infinity))
+                continue;
+
+            const double cost = arcCost[u*_k + b] - arcCost[u*_k + a];
+            if (cost < moveCost[a*_k + b]) {
+                moveCost[a*_k + b] = cost;
+                moveWitness[a*_k + b] = u;
+            }
+        }
+    }
+}
+
+
+bool MSSCBranchAndBound::solveTransportation() {
+    const int q = (int) setU.size();
+
+    flowCluster.assign(q, -1);
+    for (int c = 0; c < _k; c++) {
+        flowMembers[c].clear();
+        flowLoad[c] = 0;
+    }
+    std::fill(moveCost.begin(), moveCost.end(), infinity);
+
+    // Points are added one at a time along a shortest path to a cluster with room left, which keeps the flow optimal
+    for (int u = 0; u < q; u++) {
+        // Bellman-Ford on clusters, every cluster u may be sent to is a source
+        for (int c = 0; c < _k; c++) {
+            label[c] = arcCost[u*_k + c];
+            parent[c] = -1;
+        }
+
+        for (int pass = 0; pass < _k; pass++) {
+            bool relaxed = false;
+            for (int a = 0; a < _k; a++) {
+                if (!(label[a] < infinity))
+                    continue;
+
+                for (int b = 0; b < _k; b++) {
+                    if (label[a] + moveCost[a*_k + b] + 1e-12 < label[b]) { // Tolerance shields against cycles of null cost
+                        label[b] = label[a] + moveCost[a*_k + b];
+                        parent[b] = a;
+                        relaxed = true;
+                    }
+                }
+            }
+
+            if (!relaxed)
+                break;
+        }
+
+        int target = -1;
+        for (int c = 0; c < _k; c++)
+            if (flowLoad[c] < nbToAdd[c] && label[c] < infinity && (target == -1 || label[c] < label[target]))
+                target = c;
+
+        if (target == -1)
+            return false; // No valid assignment of free points
+
+        // Augment: each cluster on the path hands its witness point over to the next one
+        std::fill(touched.begin(), touched.end(), 0);
+        flowLoad[target]++;
+
+        int b = target;
+        for (int steps = 0; parent[b] != -1 && steps < _k; steps++) {
+            const int a = parent[b], v = moveWitness[a*_k + b];
+
+            flowMembers[a].erase(std::find(flowMembers[a].begin(), flowMembers[a].end(), v));
+            flowMembers[b].push_back(v);
+            flowCluster[v] = b;
+            touched[a] = touched[b] = 1;
+
+            b = a;
+        }
+
+        flowCluster[u] = b;
+        flowMembers[b].push_back(u);
+        touched[b] = 1;
+
+        for (int c = 0; c < _k; c++)
+            if (touched[c])
+                updateMoves(c);
+    }
+
+    return true;
+}
+
+
+/*
+ * Search
+ */
+
+void MSSCBranchAndBound::chooseBranching(int& var, int& value) const {
+    const int q = (int) setU.size();
+
+    // MAX_MIN_VAR: variable whose cheapest assignment is the most expensive, scores as in IlcMSSCSearchStrategy
+    //     s2 and S1 are those of the last propagation, domains only shrank since
+    var = setU[0];
+    value = getValue(setU[0]);
+    int maxContrib = 0;
+
+    for (int u = 0; u < q; u++) {
+        int minContrib = __MAX_INT, minValue = -1;
+
+        for (int c = 0; c < _k; c++) {
+            if (!isInDomain(setU[u], c))
+                continue;
+
+            const int card = (int) setP[c].size();
+            const int contrib = (card == 0) ? 0 : (int) (((S1[c] + s2[u*_k + c]) / (card + 1) - S1[c] / card) * 1000);
+
+            if (contrib < minContrib) {
+                minContrib = contrib;
+                minValue = c;
+            }
+        }
+
+        if (minContrib >= maxContrib) {
+            maxContrib = minContrib;
+            var = setU[u];
+            value = minValue;
+        }
+    }
+
+    // UNBOUND_FARTHEST_TOTAL_SS: an empty cluster makes every delta null, start it at the point farthest from free points
+    if (maxContrib == 0) {
+        int toFill = -1;
+        for (int c = 0; c < _k && toFill == -1; c++)
+            if (setP[c].empty())
+                toFill = c;
+
+        if (toFill != -1) {
+            int maxDist = 0;
+            for (int u = 0; u < q; u++) {
+                if (!isInDomain(setU[u], toFill))
+                    continue;
+
+                double total = 0;
+                for (int v = 0; v < q; v++)
+                    total += _data.dissimilarities[setU[v]][setU[u]];
+
+                if ((int) (total * 100) > maxDist) {
+                    maxDist = (int) (total * 100);
+                    var = setU[u];
+                    value = toFill;
+                }
+            }
+        }
+    }
+
+    assert(var >= 0 && value >= 0 && isInDomain(var, value));
+}
+
+
+void MSSCBranchAndBound::recordSolution() {
+    incumbent.resize(_n);
+    for (int i = 0; i < _n; i++)
+        incumbent[i] = getValue(i);
+
+    upperBound = lastBound;
+}
+
+
+bool MSSCBranchAndBound::backtrack() {
+    for (;;) {
+        while (!decisions.empty() && decisions.back().refuted) {
+            undoTo(decisions.back().trailMark);
+            decisions.pop_back();
+        }
+
+        if (decisions.empty())
+            return false;
+
+        // Second branch of the deepest open decision
+        Decision& decision = decisions.back();
+        undoTo(decision.trailMark);
+        decision.refuted = true;
+
+        // Never empty during the search (the variable was free when branched on), but replayed decisions may have
+        //     been taken on a variable which is now fixed
+        if (removeValue(decision.var, decision.value)) {
+            pendingPropagation = true;
+            return true;
+        }
+
+        nbFails++;
+    }
+}
+
+
+/*
+ * Root probing
+ */
+
+void MSSCBranchAndBound::probeVariables(const std::vector<int>& vars, std::atomic<size_t>& next, std::vector<std::pair<int, int> >& refuted,
+                                        const std::function<bool()>& isStopRequested) {
+    for (size_t v = next++; v < vars.size() && !(isStopRequested && isStopRequested()); v = next++) {
+        const int i = vars[v];
+
+        for (int c = 0; c < _k; c++) {
+            if (!isInDomain(i, c))
+                continue;
+
+            const size_t mark = trail.size();
+            assign(i, c);
+            if (!propagate())
+                refuted.push_back(std::make_pair(i, c));
+            undoTo(mark);
+        }
+    }
+}
+
+
+long MSSCBranchAndBound::probeRoot(int nbWorkers, const std::function<bool()>& isStopRequested) {
+    assert(!started);
+
+    // Probes start from the propagated root, whose reductions are kept as well
+    bool dead = !propagate();
+
+    std::vector<int> vars;
+    for (int i = 0; i < _n && !dead; i++)
+        if (getSize(i) > 1)
+            vars.push_back(i);
+
+    if (nbWorkers <= 0)
+        nbWorkers = std::max(1, (int) std::thread::hardware_concurrency());
+    nbWorkers = std::min(nbWorkers, (int) vars.size());
+
+    // Each worker engine is a copy of the root state, variables are handed out one at a time
+    std::vector<std::unique_ptr<MSSCBranchAndBound> > engines;
+    std::vector<std::vector<std::pair<int, int> > > refuted(nbWorkers);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next(0);
+
+    for (int t = 0; t < nbWorkers; t++) {
+        engines.emplace_back(new MSSCBranchAndBound(_data, _parameters));
+        engines.back()->words = words;
+        engines.back()->upperBound = upperBound;
+    }
+    for (int t = 0; t < nbWorkers; t++)
+        threads.emplace_back(&MSSCBranchAndBound::probeVariables, engines[t].get(), std::cref(vars), std::ref(next), std::ref(refuted[t]),
+                             std::cref(isStopRequested));
+    for (std::thread& thread : threads)
+        thread.join();
+
+    long nbRemoved = 0;
+    for (int t = 0; t < nbWorkers && !dead; t++)
+        for (const std::pair<int, int>& value : refuted[t]) {
+            dead = !removeValue(value.first, value.second);
+            nbRemoved++;
+        }
+
+    // Nothing better than the incumbent: the search is over
+    if (dead) {
+        started = true;
+        over = true;
+        rootBound = upperBound;
+        nbFails++;
+        return -1;
+    }
+
+    return nbRemoved;
+}
+
+
+bool MSSCBranchAndBound::run(long nodeBudget) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const long nodeLimit = (nodeBudget > 0) ? (nbNodes + nodeBudget) : -1;
+    const bool checkpointing = !_parameters.checkpointPath.empty();
+    std::chrono::steady_clock::time_point lastCheckpoint = start;
+
+    while (!over && !stopRequested) {
+        if (pendingPropagation) {
+            pendingPropagation = false;
+
+            const bool consistent = propagate();
+
+            if (!started) {
+                started = true;
+                rootBound = consistent ? lastBound : upperBound; // Infeasible, or nothing better than the initial incumbent
+            }
+
+            if (!consistent || setU.empty()) {
+                if (consistent)
+                    recordSolution();
+                else
+                    nbFails++;
+
+                over = !backtrack();
+                continue;
+            }
+        }
+
+        if (nodeLimit >= 0 && nbNodes >= nodeLimit)
+            break;
+
+        // Clock read every 256 nodes only
+        if (checkpointing && (nbNodes & 255) == 0) {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (std::chrono::duration<double>(now - lastCheckpoint).count() >= _parameters.checkpointInterval) {
+                writeCheckpoint(_parameters.checkpointPath, time + std::chrono::duration<double>(now - start).count());
+                lastCheckpoint = now;
+            }
+        }
+
+        Decision decision;
+        chooseBranching(decision.var, decision.value);
+        decision.refuted = false;
+        decision.trailMark = trail.size();
+
+        decisions.push_back(decision);
+        assign(decision.var, decision.value);
+        nbNodes++;
+        pendingPropagation = true;
+    }
+
+    stopRequested = false;
+    time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // On failure, the previous checkpoint is left in place
+    if (checkpointing)
+        writeCheckpoint(_parameters.checkpointPath, time);
+
+    return over;
+}
+
+
+BBResult MSSCBranchAndBound::getResult() const {
+    BBResult result;
+
+    const bool solFound = !incumbent.empty();
+    if (over)
+        result.status = solFound ? CustomBBOptions::Status::OPTIMAL : CustomBBOptions::Status::INFEASIBLE;
+    else
+        result.status = solFound ? CustomBBOptions::Status::FEASIBLE : CustomBBOptions::Status::UNKNOWN;
+
+    result.objective = upperBound;
+    result.bound = (over && solFound) ? std::max(rootBound, upperBound*(1 - _parameters.relativeGap)) : rootBound; // Pruned within the gap
+    result.memberships = incumbent;
+    result.nbNodes = nbNodes;
+    result.nbFails = nbFails;
+    result.time = time;
+
+    return result;
+}
+
+
+/*
+ * Checkpoints
+ */
+
+// FNV-1a over the problem data the search depends on
+unsigned long long MSSCBranchAndBound::getFingerprint() const {
+    unsigned long long hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* bytes, size_t size) {
+        for (size_t b = 0; b < size; b++) {
+            hash ^= static_cast<const unsigned char*>(bytes)[b];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(_data.targetCardinalities, _k*sizeof(int));
+    mix(&_data.nbMustLinks, sizeof(int));
+    mix(_data.mustLinks, 2*_data.nbMustLinks*sizeof(int));
+    mix(&_data.nbCannotLinks, sizeof(int));
+    mix(_data.cannotLinks, 2*_data.nbCannotLinks*sizeof(int));
+    for (int i = 0; i < _n - 1; i++)
+        mix(_data.dissimilarities[i] + i + 1, (_n - i - 1)*sizeof(double));
+
+    return hash;
+}
+
+
+// Flush file to disk, close it and move it over path
+static bool replaceAtomically(FILE* file, const std::string& temporaryPath, const std::string& path) {
+    bool ok = (std::fflush(file) == 0);
+#ifdef _WIN32
+    ok = ok && (_commit(_fileno(file)) == 0);
+    ok = (std::fclose(file) == 0) && ok;
+    ok = ok && MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    ok = ok && (fsync(fileno(file)) == 0);
+    ok = (std::fclose(file) == 0) && ok;
+    ok = ok && (std::rename(temporaryPath.c_str(), path.c_str()) == 0);
+#endif
+
+    if (!ok)
+        std::remove(temporaryPath.c_str());
+    return ok;
+}
+
+
+// Text format, one record per line, doubles in hexadecimal to be restored exactly:
+//     MSSCBB <version>
+//     instance <N> <K> <fingerprint>
+//     parameters <symmetryBreaking> <relativeGap>
+//     state <started> <over> <rootBound> <nbNodes> <nbFails> <time>
+//     incumbent <0|1> [<objective> <N labels>]
+//     decisions <count>, then one line per decision, from the root: x_<i> = <c> or x_<i> != <c> (refuted)
+//     end
+bool MSSCBranchAndBound::writeCheckpoint(const std::string& path, double totalTime) const {
+    const std::string temporaryPath = path + ".tmp";
+    FILE* file = std::fopen(temporaryPath.c_str(), "w");
+    if (file == NULL)
+        return false;
+
+    std::fprintf(file, "MSSCBB %d\n", __BB_CHECKPOINT_VERSION);
+    std::fprintf(file, "instance %d %d %016llx\n", _n, _k, getFingerprint());
+    std::fprintf(file, "parameters %d %a\n", (int) _parameters.symmetryBreaking, _parameters.relativeGap);
+    std::fprintf(file, "state %d %d %a %ld %ld %a\n", (int) started, (int) over, rootBound, nbNodes, nbFails, totalTime);
+
+    std::fprintf(file, "incumbent %d", (int) !incumbent.empty());
+    if (!incumbent.empty()) {
+        std::fprintf(file, " %a", upperBound);
+        for (int i = 0; i < _n; i++)
+            std::fprintf(file, " %d", incumbent[i]);
+    }
+
+    std::fprintf(file, "\ndecisions %lu\n", (unsigned long) decisions.size());
+    for (const Decision& decision : decisions)
+        std::fprintf(file, "x_%d %s %d\n", decision.var, decision.refuted ? "!=" : "=", decision.value);
+    std::fprintf(file, "end\n");
+
+    return replaceAtomically(file, temporaryPath, path);
+}
+
+
+bool MSSCBranchAndBound::loadCheckpoint(const std::string& path) {
+    assert(!started);
+
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (file == NULL)
+        return false;
+
+    // Whole file parsed and checked before anything is changed
+    int version, n, k, savedSymmetryBreaking, savedStarted, savedOver, solFound;
+    unsigned long long fingerprint;
+    double savedRelativeGap, savedRootBound, savedTime, savedObjective;
+    long savedNodes, savedFails;
+    unsigned long nbDecisions;
+
+    bool valid = std::fscanf(file, " MSSCBB %d", &version) == 1 && version == __BB_CHECKPOINT_VERSION
+        && std::fscanf(file, " instance %d %d %llx", &n, &k, &fingerprint) == 3
+        && n == _n && k == _k && fingerprint == getFingerprint()
+        && std::fscanf(file, " parameters %d %la", &savedSymmetryBreaking, &savedRelativeGap) == 2
+        && (savedSymmetryBreaking != 0) == _parameters.symmetryBreaking && savedRelativeGap == _parameters.relativeGap
+        && std::fscanf(file, " state %d %d %la %ld %ld %la", &savedStarted, &savedOver, &savedRootBound, &savedNodes,
+                       &savedFails, &savedTime) == 6
+        && std::fscanf(file, " incumbent %d", &solFound) == 1;
+
+    std::vector<int> savedIncumbent;
+    if (valid && solFound) {
+        savedIncumbent.resize(_n);
+        valid = std::fscanf(file, " %la", &savedObjective) == 1;
+        for (int i = 0; i < _n && valid; i++)
+            valid = std::fscanf(file, " %d", &savedIncumbent[i]) == 1;
+    }
+
+    // Each decision fixes a variable or removes a value, hence at most N*K of them
+    valid = valid && std::fscanf(file, " decisions %lu", &nbDecisions) == 1 && nbDecisions <= _n*(unsigned long) _k
+        && (savedStarted || nbDecisions == 0) && (!savedOver || nbDecisions == 0);
+
+    std::vector<Decision> savedDecisions;
+    for (unsigned long d = 0; d < nbDecisions && valid; d++) {
+        Decision decision;
+        char relation[3];
+        valid = std::fscanf(file, " x_%d %2s %d", &decision.var, relation, &decision.value) == 3
+            && decision.var >= 0 && decision.var < _n && decision.value >= 0 && decision.value < _k
+            && (std::strcmp(relation, "=") == 0 || std::strcmp(relation, "!=") == 0);
+        decision.refuted = (relation[0] == '!');
+        savedDecisions.push_back(decision);
+    }
+
+    char terminator[4];
+    valid = valid && std::fscanf(file, " %3s", terminator) == 1 && std::strcmp(terminator, "end") == 0;
+    std::fclose(file);
+
+    if (!valid)
+        return false;
+
+    // The better of this incumbent and the current one is kept
+    if (solFound)
+        setIncumbent(savedIncumbent.data());
+
+    started = (savedStarted != 0);
+    rootBound = savedRootBound;
+    nbNodes = savedNodes;
+    nbFails = savedFails;
+    time = savedTime;
+
+    if (savedOver) {
+        over = true;
+        return true;
+    }
+
+    if (!started)
+        return true;
+
+    // Replay the root and each decision but the last one with propagation, as run left them. A better incumbent may
+    //     prune a prefix, whose subtree is then done with.
+    bool dead = !propagate();
+    bool leaf = !dead && setU.empty();
+    for (size_t d = 0; d < savedDecisions.size() && !dead && !leaf; d++) {
+        Decision decision = savedDecisions[d];
+        decision.trailMark = trail.size();
+        decisions.push_back(decision);
+
+        if (decision.refuted)
+            dead = !removeValue(decision.var, decision.value);
+        else if (isInDomain(decision.var, decision.value))
+            assign(decision.var, decision.value);
+        else
+            dead = true;
+
+        if (!dead && d + 1 < savedDecisions.size()) {
+            dead = !propagate();
+            leaf = !dead && setU.empty();
+        }
+    }
+
+    if (dead || leaf) {
+        if (leaf)
+            recordSolution();
+        else
+            nbFails++;
+
+        over = !backtrack();
+    }
+    else
+        pendingPropagation = true; // Last decision (or root) propagated by the next run
+
+    return true;
+}
@@ -0,0 +1,234 @@
+/*
+ * Standalone depth-first branch-and-bound for cardinality-constrained Minimum Sum of Squares Clustering (MSSC).
+ * Needs neither CP Optimizer nor CPLEX: it solves the same problem as MSSCSolver with the same ingredients, specialized.
+ *     * Domains of the representative variables are packed bitsets (see DomainWord.h) in one flat array. Every change is
+ *       recorded on a trail of (word, previous value) entries, undone on backtrack down to the mark of the decision.
+ *     * Propagation is a fixed sequence of direct calls, repeated until nothing changes: full clusters, cannot-links,
+ *       must-links, value precedence among clusters of equal target cardinality, then one of the card-control bounds
+ *       with its cost-based filtering. There is no event queue nor virtual dispatch.
+ *     * Bounds are those of IlcWCSS_StandardCardControl and IlcWCSS_NetworkCardControl. The MCF of the latter is a
+ *       transportation problem (q unit supplies, k capacities), solved exactly by successive shortest paths on the
+ *       graph of clusters (moving a point from a to b costs the difference of its arc costs), without an LP solver.
+ *       Reduced costs are then read from all-pairs shortest paths between clusters.
+ *     * Branching is binary (x_i = c, then x_i != c) on the variable chosen by MAX_MIN_VAR with
+ *       UNBOUND_FARTHEST_TOTAL_SS tie handling, as in IlcMSSCSearchStrategy.
+ * The search is iterative on an explicit stack of decisions, so it can be run by slices of nodes (see run).
+ *
+ * Checkpoints: the stack of decisions describes the open subproblems, each non-refuted decision x_i = c leaving open
+ *     the subproblem made of the decisions above it and x_i != c. It is saved along with the incumbent, the bound and
+ *     the counters, in a text file written to a temporary file then renamed over the previous checkpoint, so that a
+ *     crash leaves either the old or the new one. On resume, the decisions are replayed with propagation (under the
+ *     restored incumbent, possibly pruning more than originally), and the search goes on from the last one.
+ *
+ * Root probing: before the first run, probeRoot tentatively assigns every value of every free variable at the root and
+ *     propagates it against the incumbent, on worker copies of the engine in parallel. Refuted values are removed for
+ *     good, so that every node inherits the smaller domains, which can also be read back (isInRootDomain) to restrict
+ *     another model of the instance (see SolverParameters::probingWorkers).
+ *
+ * Supported instances: target cardinalities set and no weights (see Data::weights). Must-links and cannot-links are
+ *     propagated on domains, bounds do not account for them.
+ *
+ * Main arguments: * data, refer to Data struct in Data.h for problem data nomenclature. Must outlive the engine.
+ *                 * parameters, see below.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __MSSC_BRANCH_AND_BOUND_H
+#define __MSSC_BRANCH_AND_BOUND_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+// Packed domain words
+#include "DomainWord.h"
+
+
+namespace CustomBBOptions {
+    enum class Bound {
+        STANDARD_CARD_CONTROL, // Per-cluster bound of IlcWCSS_StandardCardControl
+        NETWORK_CARD_CONTROL // Transportation bound of IlcWCSS_NetworkCardControl
+    };
+
+    enum class Status {
+        UNKNOWN, // No solution found, search not over
+        FEASIBLE, // Solution found, search not over
+        OPTIMAL, // Solution found and proven optimal (within relativeGap)
+        INFEASIBLE // Search space exhausted without any solution
+    };
+}
+
+
+struct BBParameters {
+    CustomBBOptions::Bound bound;
+
+    bool symmetryBreaking; // Value precedence among clusters of equal target cardinality
+    double relativeGap; // Nodes whose bound is within this gap of the incumbent are pruned
+
+    std::string checkpointPath; // If not empty, run saves a checkpoint there every checkpointInterval and when it returns
+    double checkpointInterval; // Seconds
+
+    BBParameters() : bound(CustomBBOptions::Bound::NETWORK_CARD_CONTROL), symmetryBreaking(true), relativeGap(0),
+    checkpointInterval(600) {}
+};
+
+
+struct BBResult {
+    CustomBBOptions::Status status;
+
+    double objective; // V of best solution, meaningless if no solution
+    double bound; // Lower bound on V: objective lowered by relativeGap if the search is over (no less than the root bound), root bound otherwise
+    std::vector<int> memberships; // Best solution, empty if no solution
+
+    long nbNodes; // Decisions taken
+    long nbFails;
+    double time; // Total duration of run calls (s)
+};
+
+
+class MSSCBranchAndBound {
+protected:
+    const Data& _data;
+    BBParameters _parameters;
+
+    int _n, _k, _w; // nb of points, nb of clusters, nb of words per domain
+
+    // Domain store and trail
+    std::vector<DomainWord> words; // words[i*_w + (c >> 6)] bit (c & 63) set means c is in domain of x_i
+    std::vector<std::pair<int, DomainWord> > trail; // (word index, previous value)
+
+    // Search state
+    struct Decision {
+        int var, value;
+        bool refuted; // Second branch (var != value) taken
+        size_t trailMark;
+    };
+    std::vector<Decision> decisions;
+    bool started, over, pendingPropagation;
+
+    // Incumbent
+    std::vector<int> incumbent;
+    double upperBound; // Infinity if no solution
+    double rootBound;
+    double lastBound; // Bound of the last propagation (objective at a leaf)
+    double epsilon; // Subtracted from bounds before pruning, protection against rounding errors (as IlcWCSS_StandardCardControl)
+
+    long nbNodes, nbFails;
+    double time;
+
+    std::atomic<bool> stopRequested;
+
+    // Pairwise constraints and symmetry breaking, static
+    std::vector<std::vector<int> > cannotLinkPartners;
+    std::vector<std::vector<int> > mustLinkPartners;
+    std::vector<int> precedingCluster; // precedingCluster[c] = previous cluster of same target cardinality, -1 if none
+
+    // Propagation buffers
+    std::vector<int> setU; // Free points
+    std::vector<std::vector<int> > setP; // setP[c] = points fixed to c
+    std::vector<int> nbToAdd; // Points still to add to each cluster
+    std::vector<DomainWord> openClusters; // Mask of clusters which are not full
+    std::vector<char> isPartner; // Cannot-link partners of the point at hand
+    std::vector<double> S1; // Sum of dissimilarities of each cluster
+    std::vector<double> s2; // s2[u*_k + c] = sum of dissimilarities between u-th free point and cluster c
+    std::vector<double> s3; // s3[u*(maxToAdd) + m] = smallest 1/2 contribution of u-th free point with m other free points
+    std::vector<double> arcCost; // arcCost[u*_k + c] = cost of sending u-th free point to c, infinity if no such arc
+    std::vector<double> sorted;
+    int maxToAdd;
+    std::vector<double> lbCluster, lbClusterLess; // Bound of each cluster completed with nbToAdd[c] (resp. nbToAdd[c] - 1) free points
+
+    // Transportation problem (NETWORK_CARD_CONTROL)
+    std::vector<int> flowCluster; // flowCluster[u] = cluster the u-th free point is sent to
+    std::vector<std::vector<int> > flowMembers; // flowMembers[c] = free points (by index in U) sent to c
+    std::vector<int> flowLoad;
+    std::vector<double> moveCost; // moveCost[a*_k + b] = cheapest cost of moving a point sent to a to b
+    std::vector<int> moveWitness; // Point realizing moveCost
+    std::vector<double> pathCost; // pathCost[a*_k + b] = shortest path from a to b in the residual graph
+    std::vector<double> label; // Bellman-Ford labels when adding a point
+    std::vector<int> parent;
+    std::vector<char> touched; // Clusters whose members changed
+
+    // Domain operations, all trailed
+    bool isInDomain(int i, int c) const { return ((words[i*_w + (c >> 6)] >> (c & 63)) & 1) != 0; }
+    int getSize(int i) const;
+    int getValue(int i) const; // Smallest value in domain
+    bool removeValue(int i, int c); // Returns false if the domain becomes empty
+    void assign(int i, int c);
+    bool restrictTo(int i, const DomainWord* mask); // Domain of i &= mask, returns false if emptied
+    void undoTo(size_t mark);
+
+    // Propagation, returns false on failure
+    bool propagate();
+    bool propagateStructure();
+    bool propagateBound(bool& fixedSome);
+    void prepareContributions();
+    double computeStandardBound(bool& fixedSome, bool& failed);
+    double computeNetworkBound(bool& fixedSome, bool& failed);
+    bool solveTransportation();
+    void updateMoves(int a);
+    bool isPruned(double lb) const;
+
+    // Search
+    void chooseBranching(int& var, int& value) const;
+    void recordSolution();
+    bool backtrack(); // Returns false when the search is over
+
+    // Root probing of the variables of vars taken in turn through next, refuted receives the failed (var, value) pairs
+    void probeVariables(const std::vector<int>& vars, std::atomic<size_t>& next, std::vector<std::pair<int, int> >& refuted,
+                        const std::function<bool()>& isStopRequested);
+
+    // Checkpoints
+    unsigned long long getFingerprint() const; // Hash of the instance, checked on resume
+    bool writeCheckpoint(const std::string& path, double totalTime) const;
+
+public:
+    // data must satisfy isSupported and outlive the engine
+    MSSCBranchAndBound(const Data& data, const BBParameters& parameters = BBParameters());
+
+    MSSCBranchAndBound(const MSSCBranchAndBound&) = delete;
+    MSSCBranchAndBound& operator=(const MSSCBranchAndBound&) = delete;
+
+    static bool isSupported(const Data& data);
+
+    // Start from a known solution (eg. Data::memberships): only better solutions are searched for.
+    //     Returns false (and ignores it) if it is not a valid solution. Must be called before the first run.
+    bool setIncumbent(const int* memberships);
+
+    // Probe every value of every free variable at the root in parallel on nbWorkers engines (0 means one per hardware
+    //     thread), then remove the refuted values. Solutions better than the incumbent are never cut off.
+    //     Must be called before the first run (after setIncumbent, if any). Returns the number of values removed, or -1
+    //     if the root fails (some variable loses all its values), in which case the search is over.
+    //     isStopRequested, if set, is polled by the workers between variables (from their threads): once it returns true,
+    //     the variables left aren't probed and only the values refuted so far are removed.
+    long probeRoot(int nbWorkers = 0, const std::function<bool()>& isStopRequested = std::function<bool()>());
+
+    // Domain of x_i at the root, only meaningful before the first run (eg. after probeRoot)
+    bool isInRootDomain(int i, int c) const { return isInDomain(i, c); }
+
+    // Explore at most nodeBudget more nodes (no limit if <= 0) and return true once the search is over.
+    //     Successive calls resume the search where the previous one stopped.
+    bool run(long nodeBudget = 0);
+
+    // Save the current state to path (atomically replaced), returns false on I/O error
+    bool saveCheckpoint(const std::string& path) const { return writeCheckpoint(path, time); }
+
+    // Restore the state saved in path. Must be called before the first run, possibly after setIncumbent (the better
+    //     of both incumbents is kept). Returns false, leaving the engine untouched, if the file is missing or invalid,
+    //     or was saved for another instance or other symmetryBreaking or relativeGap parameters.
+    bool loadCheckpoint(const std::string& path);
+
+    bool isOver() const { return over; }
+    long getNbNodes() const { return nbNodes; }
+    BBResult getResult() const;
+
+    // Stop the run in progress as soon as possible, it returns as if its budget were spent. Thread-safe.
+    void abort() { stopRequested = true; }
+};
+
+#endif // !__MSSC_BRANCH_AND_BOUND_H
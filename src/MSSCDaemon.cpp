@@ -0,0 +1,366 @@
+/*
+ * Long-lived local solve server.
+ * Refer to MSSCDaemon.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "MSSCDaemon.h"
+
+
+// Longest request line accepted
+#define __MAX_REQUEST_LENGTH 65536
+
+
+// Read a line (without its end of line) from fd, completing what pending already holds.
+//     Returns 1 if a line was read, 0 if none came within timeoutMs, -1 if the connection is closed or broken.
+static int readLine(int fd, std::string& pending, std::string& line, int timeoutMs) {
+    for (;;) {
+        const size_t end = pending.find('\n');
+        if (end != std::string::npos) {
+            line.assign(pending, 0, end);
+            pending.erase(0, end + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            return 1;
+        }
+
+        if (pending.size() > __MAX_REQUEST_LENGTH)
+            return -1;
+
+        pollfd event = {fd, POLLIN, 0};
+        const int ready = poll(&event, 1, timeoutMs);
+        if (ready == 0)
+            return 0;
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        char buffer[4096];
+        const ssize_t nbRead = recv(fd, buffer, sizeof(buffer), 0);
+        if (nbRead < 0 && errno == EINTR)
+            continue;
+        if (nbRead <= 0)
+            return -1;
+        pending.append(buffer, nbRead);
+    }
+}
+
+
+// Returns false if the client is gone
+static bool sendLine(int fd, const std::string& line) {
+    const std::string message = line + "\n";
+
+    size_t sent = 0;
+    while (sent < message.size()) {
+        const ssize_t nbSent = send(fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (nbSent < 0 && errno == EINTR)
+            continue;
+        if (nbSent <= 0)
+            return false;
+        sent += nbSent;
+    }
+
+    return true;
+}
+
+
+static const char* getStatusName(CustomCPSolverOptions::Status status) {
+    switch (status) {
+        case CustomCPSolverOptions::Status::FEASIBLE:
+            return "FEASIBLE";
+        case CustomCPSolverOptions::Status::OPTIMAL:
+            return "OPTIMAL";
+        case CustomCPSolverOptions::Status::INFEASIBLE:
+            return "INFEASIBLE";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+
+static void writeMemberships(std::ostringstream& out, const std::vector<int>& memberships) {
+    for (int label : memberships)
+        out << ' ' << label;
+}
+
+
+MSSCDaemon::MSSCDaemon(const DaemonParameters& parameters) :
+_parameters(parameters), cache(parameters.cacheCapacity), scheduler(parameters.nbWorkers), listenFd(-1), stopRequested(false) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (_parameters.socketPath.empty() || _parameters.socketPath.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("invalid socket path " + _parameters.socketPath);
+    std::strcpy(address.sun_path, _parameters.socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+
+    unlink(_parameters.socketPath.c_str()); // Left over by a previous run
+    if (bind(listenFd, (const sockaddr*) &address, sizeof(address)) != 0 || listen(listenFd, SOMAXCONN) != 0) {
+        const std::string error = std::strerror(errno);
+        close(listenFd);
+        throw std::runtime_error("cannot listen on " + _parameters.socketPath + ": " + error);
+    }
+}
+
+
+MSSCDaemon::~MSSCDaemon() {
+    stop();
+    reapConnections(true);
+
+    close(listenFd);
+    unlink(_parameters.socketPath.c_str());
+}
+
+
+void MSSCDaemon::serve() {
+    const int intervalMs = std::max(1, (int) (_parameters.progressInterval*1000));
+
+    while (!stopRequested) {
+        reapConnections(false);
+
+        pollfd event = {listenFd, POLLIN, 0};
+        if (poll(&event, 1, intervalMs) <= 0)
+            continue;
+
+        const int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0)
+            continue;
+
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connections.emplace_back(new Connection());
+        Connection* connection = connections.back().get();
+        connection->fd = fd;
+        connection->done = false;
+        connection->thread = std::thread(&MSSCDaemon::serveConnection, this, connection);
+    }
+
+    // Connections notice stopRequested within progressInterval
+    reapConnections(true);
+}
+
+
+void MSSCDaemon::reapConnections(bool all) {
+    std::list<std::unique_ptr<Connection>> finished;
+
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (all || (*it)->done)
+                finished.splice(finished.end(), connections, it++);
+            else
+                ++it;
+        }
+    }
+
+    for (auto& connection : finished)
+        connection->thread.join();
+}
+
+
+void MSSCDaemon::serveConnection(Connection* connection) {
+    const int intervalMs = std::max(1, (int) (_parameters.progressInterval*1000));
+    std::string pending, request;
+
+    while (!stopRequested) {
+        const int read = readLine(connection->fd, pending, request, intervalMs);
+        if (read == 0)
+            continue;
+        if (read < 0)
+            break;
+
+        std::istringstream words(request);
+        std::string command;
+        words >> command;
+
+        bool open = true;
+        if (command.empty())
+            continue;
+        else if (command == "SOLVE")
+            open = handleSolve(connection->fd, pending, request);
+        else if (command == "STATS") {
+            const InstanceCacheStats stats = cache.getStats();
+            std::ostringstream out;
+            out << "STATS " << stats.nbInstances << ' ' << stats.nbBytes << ' ' << stats.nbHits << ' ' << stats.nbMisses
+                << ' ' << stats.nbEvictions;
+            open = sendLine(connection->fd, out.str());
+        }
+        else if (command == "QUIT")
+            break;
+        else
+            open = sendLine(connection->fd, "ERROR unknown request " + command);
+
+        if (!open)
+            break;
+    }
+
+    close(connection->fd);
+    connection->done = true;
+}
+
+
+// Returns false if the client is gone
+bool MSSCDaemon::handleSolve(int fd, std::string& pending, const std::string& request) {
+    std::istringstream words(request);
+    std::string command, path, option;
+    words >> command >> path;
+    if (path.empty())
+        return sendLine(fd, "ERROR SOLVE needs an instance path");
+
+    std::shared_ptr<CachedInstance> instance;
+    try {
+        instance = cache.get(path);
+    }
+    catch (std::exception& e) {
+        return sendLine(fd, std::string("ERROR ") + e.what());
+    }
+
+    SolverParameters parameters;
+    if (!instance->hasTargets())
+        parameters.constraint = CustomCPSolverOptions::Constraint::WCSS;
+    bool warm = true;
+
+    while (words >> option) {
+        const size_t equal = option.find('=');
+        const std::string key = option.substr(0, equal);
+        std::istringstream value((equal == std::string::npos) ? "" : option.substr(equal + 1));
+
+        bool valid = (equal != std::string::npos);
+        if (key == "constraint") {
+            const std::string name = value.str();
+            if (name == "wcss")
+                parameters.constraint = CustomCPSolverOptions::Constraint::WCSS;
+            else if (name == "external")
+                parameters.constraint = CustomCPSolverOptions::Constraint::WCSS_EXTERNAL_CARD_CONTROL;
+            else if (name == "standard")
+                parameters.constraint = CustomCPSolverOptions::Constraint::STANDARD_CARD_CONTROL;
+            else if (name == "network")
+                parameters.constraint = CustomCPSolverOptions::Constraint::NETWORK_CARD_CONTROL;
+            else if (name == "lagrangian")
+                parameters.constraint = CustomCPSolverOptions::Constraint::LAGRANGIAN_CARD_CONTROL;
+            else
+                valid = false;
+        }
+        else if (key == "time")
+            valid = valid && (value >> parameters.timeLimit);
+        else if (key == "fails")
+            valid = valid && (value >> parameters.failLimit);
+        else if (key == "branches")
+            valid = valid && (value >> parameters.branchLimit);
+        else if (key == "gap")
+            valid = valid && (value >> parameters.relativeGap) && parameters.relativeGap >= 0;
+        else if (key == "symmetry")
+            valid = valid && (value >> parameters.symmetryBreaking);
+        else if (key == "warm")
+            valid = valid && (value >> warm);
+        else
+            valid = false;
+
+        if (!valid)
+            return sendLine(fd, "ERROR bad option " + option);
+    }
+
+    const bool cardinalitiesKnown = (parameters.constraint != CustomCPSolverOptions::Constraint::WCSS);
+    if (cardinalitiesKnown && !instance->hasTargets())
+        return sendLine(fd, "ERROR " + path + " has no target cardinalities");
+
+    // Already proven, within the requested gap
+    const KnownBounds known = instance->getKnown(cardinalitiesKnown);
+    if (known.proven && known.provenGap <= parameters.relativeGap) {
+        const bool solFound = !known.memberships.empty();
+        std::ostringstream out;
+        out.precision(17);
+        out << "RESULT " << (solFound ? "OPTIMAL" : "INFEASIBLE") << ' ' << known.objective << ' '
+            << (solFound ? std::max(known.bound, known.objective*(1 - known.provenGap)) : known.bound) << ' ' << (int) solFound << " 0 0 0"; // Proven within provenGap only
+        writeMemberships(out, known.memberships);
+        return sendLine(fd, out.str());
+    }
+
+    // The job works on its own shallow copy of the instance, only memberships differ
+    Data data = instance->data;
+    std::vector<int> warmStart;
+    if (warm && !known.memberships.empty()) {
+        warmStart = known.memberships;
+        data.memberships = warmStart.data();
+        parameters.searchParameters.initialSolution = CustomCPSearchOptions::InitialSolution::MEMBERSHIPS_AS_INDICATED;
+    }
+
+    SolveHandle handle = scheduler.submit(data, parameters);
+
+    // Stream improvements and watch for cancellation until done. The job references data: always wait for it.
+    bool clientGone = false;
+    IloInt nbReported = 0;
+    std::string line, deferred; // Requests received meanwhile, handled after this one
+    while (!handle.waitFor(_parameters.progressInterval)) {
+        if (stopRequested)
+            handle.cancel();
+
+        if (!clientGone) {
+            const int read = readLine(fd, pending, line, 0);
+            if (read < 0) {
+                clientGone = true;
+                handle.cancel();
+                continue;
+            }
+            if (read > 0) {
+                if (line == "CANCEL")
+                    handle.cancel();
+                else
+                    deferred += line + "\n";
+            }
+        }
+
+        if (!clientGone && handle.poll().nbSolutions > nbReported) {
+            const MSSCProgress progress = handle.poll(true);
+            std::ostringstream out;
+            out.precision(17);
+            out << "SOLUTION " << progress.nbSolutions << ' ' << progress.objective << ' ' << progress.bound << ' '
+                << progress.time;
+            writeMemberships(out, progress.memberships);
+            clientGone = !sendLine(fd, out.str());
+            nbReported = progress.nbSolutions;
+        }
+    }
+
+    pending.insert(0, deferred);
+
+    MSSCResult result;
+    try {
+        result = handle.result();
+    }
+    catch (std::exception& e) {
+        return !clientGone && sendLine(fd, std::string("ERROR ") + e.what());
+    }
+
+    const bool completed = (result.status == CustomCPSolverOptions::Status::OPTIMAL
+                            || result.status == CustomCPSolverOptions::Status::INFEASIBLE);
+    instance->record(cardinalitiesKnown, result.objective, result.memberships, result.bound, completed, parameters.relativeGap);
+
+    if (clientGone)
+        return false;
+
+    std::ostringstream out;
+    out.precision(17);
+    out << "RESULT " << getStatusName(result.status) << ' ' << result.objective << ' ' << result.bound << ' '
+        << result.nbSolutions << ' ' << result.nbBranches << ' ' << result.nbFails << ' ' << result.time;
+    writeMemberships(out, result.memberships);
+
+    return sendLine(fd, out.str());
+}
@@ -0,0 +1,91 @@
+/*
+ * Long-lived local solve server: requests arrive on a Unix domain socket, instances stay resident in an InstanceCache
+ *     (see InstanceCache.h) and solves run on an MSSCScheduler worker pool (see MSSCScheduler.h). A client thus pays
+ *     neither process startup nor instance loading, and later solves of an instance start from what earlier ones found.
+ *
+ * Protocol: line-based text, one request at a time per connection, any number of connections.
+ *     * SOLVE <path> [option=value ...]
+ *           Options: constraint=wcss|external|standard|network|lagrangian (default network, wcss if the instance has no targets),
+ *                    time=<s>, fails=<n>, branches=<n>, gap=<relative gap>, symmetry=0|1, warm=0|1 (start from the best
+ *                    known solution, default 1).
+ *           Replies with any number of lines
+ *               SOLUTION <nbSolutions> <objective> <bound> <time> <N memberships>
+ *           as the incumbent improves (at most one per progressInterval), then
+ *               RESULT <status> <objective> <bound> <nbSolutions> <nbBranches> <nbFails> <time> [<N memberships>]
+ *           where status is one of UNKNOWN, FEASIBLE, OPTIMAL, INFEASIBLE. Problems already proven within the requested gap
+ *           are answered from the cache (nbBranches = 0), with the bound of that proof.
+ *           While a solve runs, a CANCEL line (or closing the connection) cancels it, a RESULT is still sent. Other
+ *           requests sent meanwhile are handled after it.
+ *     * STATS, replies STATS <nbInstances> <nbBytes> <nbHits> <nbMisses> <nbEvictions>
+ *     * QUIT, closes the connection
+ *     Malformed requests and failed solves are answered by ERROR <message>.
+ *
+ * POSIX only. serve runs the accept loop on the calling thread, one thread per connection, until stop is called.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __MSSC_DAEMON_H
+#define __MSSC_DAEMON_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "InstanceCache.h"
+#include "MSSCScheduler.h"
+
+
+struct DaemonParameters {
+    std::string socketPath; // Replaced if it exists
+    unsigned nbWorkers; // 0 means one worker per hardware thread
+    size_t cacheCapacity; // Bytes of resident instances
+    double progressInterval; // Seconds between checks for improved solutions and cancellation
+
+    DaemonParameters() : nbWorkers(0), cacheCapacity((size_t) 1 << 30), progressInterval(0.1) {}
+};
+
+
+class MSSCDaemon {
+private:
+    DaemonParameters _parameters;
+    InstanceCache cache;
+    MSSCScheduler scheduler;
+
+    int listenFd;
+    std::atomic<bool> stopRequested;
+
+    struct Connection {
+        int fd;
+        std::thread thread;
+        std::atomic<bool> done;
+    };
+    std::mutex connectionsMutex; // Protects connections
+    std::list<std::unique_ptr<Connection>> connections;
+
+    void reapConnections(bool all);
+    void serveConnection(Connection* connection);
+    bool handleSolve(int fd, std::string& pending, const std::string& request);
+
+public:
+    // Binds the socket, throws std::runtime_error on failure
+    MSSCDaemon(const DaemonParameters& parameters);
+
+    // Must not be destroyed while serve runs
+    ~MSSCDaemon();
+
+    MSSCDaemon(const MSSCDaemon&) = delete;
+    MSSCDaemon& operator=(const MSSCDaemon&) = delete;
+
+    // Accept connections until stop, then wait for them to close (their solves are cancelled)
+    void serve();
+
+    // Thread-safe, eg. from a signal handling thread
+    void stop() { stopRequested = true; }
+};
+
+#endif // !__MSSC_DAEMON_H
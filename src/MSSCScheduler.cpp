@@ -0,0 +1,211 @@
+/*
+ * Asynchronous resolution of (cardinality-constrained) MSSC instances on a pool of worker threads.
+ * Refer to MSSCScheduler.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "MSSCScheduler.h"
+
+
+class MSSCSolveJob {
+public:
+    const Data& data;
+    SolverParameters parameters;
+
+    SearchControl control; // Read by the search goal on the worker, written by cancel
+
+    std::mutex progressMutex; // Protects progress
+    MSSCProgress progress;
+
+    std::promise<MSSCResult> promise;
+    std::shared_future<MSSCResult> future;
+
+    MSSCSolveJob(const Data& data_, const SolverParameters& parameters_) : data(data_), parameters(parameters_) {
+        parameters.searchParameters.control = &control;
+
+        progress.state = CustomCPSolverOptions::SolveState::QUEUED;
+        progress.objective = IloInfinity;
+        progress.bound = 0;
+        progress.nbSolutions = 0;
+        progress.time = 0;
+
+        future = promise.get_future().share();
+    }
+
+    void setState(CustomCPSolverOptions::SolveState state) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress.state = state;
+    }
+
+    void run();
+};
+
+
+void MSSCSolveJob::run() {
+    if (control.isCancelRequested()) { // Cancelled while queued
+        MSSCResult result;
+        result.status = CustomCPSolverOptions::Status::UNKNOWN;
+        result.objective = IloInfinity;
+        result.bound = 0;
+        result.nbSolutions = 0;
+        result.nbBranches = 0;
+        result.nbFails = 0;
+        result.time = 0;
+
+        setState(CustomCPSolverOptions::SolveState::DONE);
+        promise.set_value(result);
+        return;
+    }
+
+    setState(CustomCPSolverOptions::SolveState::RUNNING);
+
+    try {
+        MSSCSolver solver(data, parameters);
+
+        MSSCResult result = solver.solve([this](const MSSCSolution& solution) {
+            {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                progress.objective = solution.objective;
+                progress.bound = solution.bound;
+                progress.memberships.assign(solution.memberships, solution.memberships + data.N);
+                progress.nbSolutions = solution.index + 1;
+                progress.time = solution.time;
+            }
+
+            return !control.isCancelRequested();
+        });
+
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            progress.state = CustomCPSolverOptions::SolveState::DONE;
+            progress.bound = result.bound;
+            progress.time = result.time;
+        }
+        promise.set_value(result);
+    }
+    catch (IloException& e) {
+        setState(CustomCPSolverOptions::SolveState::DONE);
+        promise.set_exception(std::make_exception_ptr(std::runtime_error(e.getMessage())));
+    }
+    catch (...) {
+        setState(CustomCPSolverOptions::SolveState::DONE);
+        promise.set_exception(std::current_exception());
+    }
+}
+
+
+const MSSCResult& SolveHandle::result() const {
+    return _job->future.get();
+}
+
+
+void SolveHandle::wait() const {
+    _job->future.wait();
+}
+
+
+bool SolveHandle::waitFor(double seconds) const {
+    return _job->future.wait_for(std::chrono::duration<double>(seconds)) == std::future_status::ready;
+}
+
+
+bool SolveHandle::isDone() const {
+    return _job->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+
+MSSCProgress SolveHandle::poll(bool withMemberships) const {
+    std::lock_guard<std::mutex> lock(_job->progressMutex);
+
+    if (withMemberships)
+        return _job->progress;
+
+    MSSCProgress progress;
+    progress.state = _job->progress.state;
+    progress.objective = _job->progress.objective;
+    progress.bound = _job->progress.bound;
+    progress.nbSolutions = _job->progress.nbSolutions;
+    progress.time = _job->progress.time;
+
+    return progress;
+}
+
+
+void SolveHandle::cancel() {
+    _job->control.cancel();
+}
+
+
+MSSCScheduler::MSSCScheduler(unsigned nbWorkers) : stopping(false) {
+    if (nbWorkers == 0)
+        nbWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+    running.resize(nbWorkers);
+    for (unsigned w = 0; w < nbWorkers; w++)
+        workers.emplace_back(&MSSCScheduler::workerLoop, this, w);
+}
+
+
+MSSCScheduler::~MSSCScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+
+        // Pending solves are still handed to workers so that their handles complete
+        for (auto& job : queue)
+            job->control.cancel();
+        for (auto& job : running)
+            if (job)
+                job->control.cancel();
+    }
+    queueNotEmpty.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+
+SolveHandle MSSCScheduler::submit(const Data& data, const SolverParameters& solverParameters) {
+    std::shared_ptr<MSSCSolveJob> job = std::make_shared<MSSCSolveJob>(data, solverParameters);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping)
+            job->control.cancel();
+        queue.push_back(job);
+    }
+    queueNotEmpty.notify_one();
+
+    return SolveHandle(job);
+}
+
+
+void MSSCScheduler::workerLoop(unsigned w) {
+    for (;;) {
+        std::shared_ptr<MSSCSolveJob> job;
+
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            running[w].reset();
+
+            queueNotEmpty.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            if (queue.empty()) // stopping and nothing left
+                return;
+
+            job = queue.front();
+            queue.pop_front();
+
+            if (stopping)
+                job->control.cancel();
+            running[w] = job;
+        }
+
+        job->run();
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * Asynchronous resolution of (cardinality-constrained) MSSC instances on a pool of worker threads.
+ * Each submitted solve runs an MSSCSolver (hence its own IloEnv and IloCP engine) on one of the workers.
+ *
+ * submit returns immediately with a SolveHandle which gives:
+ *     * future-like access to the final MSSCResult (result, wait, isDone),
+ *     * a non-blocking poll of the current incumbent, bound and counters, updated at each improving solution,
+ *     * cooperative cancellation, checked by the search goal at each branching decision (see SearchControl).
+ *
+ * Solves are started in submission order as workers become available. A solve cancelled before it starts is not run
+ *     and completes with status UNKNOWN.
+ *
+ * Exceptions raised during a solve are stored in the handle and rethrown by SolveHandle::result. IloException is
+ *     rethrown as std::runtime_error holding its message, since the environment it belongs to no longer exists.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __MSSC_SCHEDULER_H
+#define __MSSC_SCHEDULER_H
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MSSCSolver.h"
+
+
+namespace CustomCPSolverOptions {
+    enum class SolveState {
+        QUEUED, // Waiting for a worker
+        RUNNING, // Search in progress
+        DONE // Result available
+    };
+}
+
+
+// Snapshot of a solve in progress
+struct MSSCProgress {
+    CustomCPSolverOptions::SolveState state;
+
+    double objective; // V of current incumbent, IloInfinity if none
+    double bound; // Best lower bound on V known when the incumbent was found
+    std::vector<int> memberships; // Current incumbent, only filled when requested and available
+
+    IloInt nbSolutions;
+    double time; // Solve duration (s) when the incumbent was found
+};
+
+
+class MSSCSolveJob; // Shared state between a handle and the worker running it, see MSSCScheduler.cpp
+
+
+class SolveHandle {
+private:
+    std::shared_ptr<MSSCSolveJob> _job;
+
+public:
+    SolveHandle() {}
+    SolveHandle(const std::shared_ptr<MSSCSolveJob>& job) : _job(job) {}
+
+    bool isValid() const { return (bool) _job; }
+
+    // Blocking access to the final result, rethrows exceptions raised by the solve
+    const MSSCResult& result() const;
+    void wait() const;
+    bool waitFor(double seconds) const; // Returns isDone, possibly earlier
+    bool isDone() const;
+
+    // Non-blocking, never waits on the search (only on a short critical section)
+    MSSCProgress poll(bool withMemberships = false) const;
+
+    // Request cancellation, returns immediately. The solve completes with the best solution found so far.
+    void cancel();
+};
+
+
+class MSSCScheduler {
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex queueMutex;
+    std::condition_variable queueNotEmpty;
+    std::deque<std::shared_ptr<MSSCSolveJob>> queue;
+    std::vector<std::shared_ptr<MSSCSolveJob>> running; // Job run by each worker, protected by queueMutex
+    bool stopping;
+
+    void workerLoop(unsigned w);
+
+public:
+    // nbWorkers = 0 means one worker per hardware thread
+    MSSCScheduler(unsigned nbWorkers = 0);
+
+    // Cancels pending and running solves, then waits for workers to finish
+    ~MSSCScheduler();
+
+    MSSCScheduler(const MSSCScheduler&) = delete;
+    MSSCScheduler& operator=(const MSSCScheduler&) = delete;
+
+    // data must outlive the solve. solverParameters.searchParameters.control is replaced by the handle's own.
+    SolveHandle submit(const Data& data, const SolverParameters& solverParameters = SolverParameters());
+
+    unsigned getNbWorkers() const { return (unsigned) workers.size(); }
+};
+
+#endif // !__MSSC_SCHEDULER_H
@@ -0,0 +1,198 @@
+/*
+ * C++20 coroutine interface over MSSCSolver's step-wise API, and cooperative interleaving of several solves on one thread.
+ * Refer to MSSCSolutionGenerator.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include "MSSCSolutionGenerator.h"
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+
+#include <algorithm>
+
+
+// Ends the search when the coroutine finishes or is destroyed while suspended
+class SearchGuard {
+private:
+    MSSCSolver& _solver;
+    MSSCResult* _result;
+
+public:
+    SearchGuard(MSSCSolver& solver, MSSCResult* result) : _solver(solver), _result(result) {}
+
+    // Normal termination, exceptions reach the generator's consumer
+    void finish() {
+        MSSCResult result = _solver.endSearch();
+        if (_result != nullptr)
+            *_result = result;
+    }
+
+    ~SearchGuard() {
+        if (!_solver.isSearching())
+            return;
+
+        try {
+            finish();
+        }
+        catch (...) {
+            // Destruction path (consumer stopped early), nowhere to report to
+        }
+    }
+};
+
+
+MSSCSolutionGenerator generateSolutions(MSSCSolver& solver, MSSCResult* result) {
+    solver.startSearch();
+    SearchGuard guard(solver, result);
+
+    MSSCSolution solution;
+    while (solver.nextSolution(solution))
+        co_yield solution;
+
+    guard.finish();
+}
+
+
+size_t MSSCInterleavedSolves::add(const Data& data, const SolverParameters& solverParameters, const SolutionCallback& onSolution) {
+    std::unique_ptr<Solve> solve(new Solve());
+
+    if (_branchAndBound && solverParameters.constraint != CustomCPSolverOptions::Constraint::WCSS && MSSCBranchAndBound::isSupported(data)) {
+        BBParameters bbParameters;
+        bbParameters.bound = (solverParameters.constraint == CustomCPSolverOptions::Constraint::NETWORK_CARD_CONTROL
+                              || solverParameters.constraint == CustomCPSolverOptions::Constraint::LAGRANGIAN_CARD_CONTROL)
+                             ? CustomBBOptions::Bound::NETWORK_CARD_CONTROL : CustomBBOptions::Bound::STANDARD_CARD_CONTROL;
+        bbParameters.symmetryBreaking = solverParameters.symmetryBreaking;
+        bbParameters.relativeGap = std::max(solverParameters.propagation.relativeGap, solverParameters.relativeGap); // As MSSCSolver
+
+        solve->engine.reset(new MSSCBranchAndBound(data, bbParameters));
+        if (data.memberships != NULL)
+            solve->engine->setIncumbent(data.memberships); // Ignored if not a solution
+        solve->parameters = solverParameters;
+
+        solve->result.status = CustomCPSolverOptions::Status::UNKNOWN;
+        solve->result.objective = IloInfinity;
+        solve->result.bound = 0;
+        solve->result.nbSolutions = 0;
+        solve->result.nbBranches = 0;
+        solve->result.nbFails = 0;
+        solve->result.time = 0;
+    }
+    else {
+        solve->solver.reset(new MSSCSolver(data, solverParameters));
+        solve->generator = generateSolutions(*solve->solver, &solve->result);
+    }
+    solve->onSolution = onSolution;
+    solve->done = false;
+
+    solves.push_back(std::move(solve));
+    nbRemaining++;
+
+    return solves.size() - 1;
+}
+
+
+bool MSSCInterleavedSolves::step() {
+    if (nbRemaining == 0)
+        return false;
+
+    // Turn goes to the solve which has consumed the least of its node budget (not started solves first)
+    Solve* chosen = nullptr;
+    IloInt chosenNbNodes = 0;
+    for (auto& solve : solves) {
+        if (solve->done)
+            continue;
+
+        IloInt nbNodes = solve->getNbNodes();
+        if (chosen == nullptr || nbNodes < chosenNbNodes) {
+            chosen = solve.get();
+            chosenNbNodes = nbNodes;
+        }
+    }
+
+    bool keepGoing;
+    try {
+        if (chosen->engine) {
+            keepGoing = stepEngine(*chosen);
+        }
+        else {
+            keepGoing = chosen->generator.next();
+            if (keepGoing && chosen->onSolution)
+                keepGoing = chosen->onSolution(chosen->generator.get());
+        }
+    }
+    catch (...) {
+        chosen->generator = MSSCSolutionGenerator(); // Search already released by the solver
+        chosen->done = true;
+        nbRemaining--;
+        throw;
+    }
+
+    if (!keepGoing) {
+        chosen->generator = MSSCSolutionGenerator(); // Ends the search and fills result if still in progress
+        chosen->done = true;
+        nbRemaining--;
+    }
+
+    return nbRemaining > 0;
+}
+
+
+bool MSSCInterleavedSolves::stepEngine(Solve& solve) {
+    MSSCBranchAndBound& engine = *solve.engine;
+    const SolverParameters& parameters = solve.parameters;
+
+    long budget = _nodesPerStep;
+    if (parameters.branchLimit > 0)
+        budget = std::min(budget, (long) parameters.branchLimit - engine.getNbNodes());
+
+    const bool over = engine.run(budget);
+    const BBResult bbResult = engine.getResult();
+    MSSCResult& result = solve.result;
+
+    bool keepGoing = !over;
+    if (!bbResult.memberships.empty() && (result.nbSolutions == 0 || bbResult.objective < result.objective)) {
+        result.objective = bbResult.objective;
+        result.memberships = bbResult.memberships;
+        result.nbSolutions++;
+
+        if (solve.onSolution) {
+            MSSCSolution solution;
+            solution.objective = result.objective;
+            solution.bound = bbResult.bound;
+            solution.memberships = result.memberships.data();
+            solution.time = bbResult.time;
+            solution.index = result.nbSolutions - 1;
+            if (!solve.onSolution(solution))
+                keepGoing = false;
+        }
+    }
+
+    if ((parameters.branchLimit > 0 && bbResult.nbNodes >= parameters.branchLimit)
+        || (parameters.failLimit > 0 && bbResult.nbFails >= parameters.failLimit)
+        || (parameters.timeLimit > 0 && bbResult.time >= parameters.timeLimit))
+        keepGoing = false;
+
+    if (!keepGoing) {
+        switch (bbResult.status) {
+            case CustomBBOptions::Status::OPTIMAL: result.status = CustomCPSolverOptions::Status::OPTIMAL; break;
+            case CustomBBOptions::Status::INFEASIBLE: result.status = CustomCPSolverOptions::Status::INFEASIBLE; break;
+            case CustomBBOptions::Status::FEASIBLE: result.status = CustomCPSolverOptions::Status::FEASIBLE; break;
+            default: result.status = CustomCPSolverOptions::Status::UNKNOWN; break;
+        }
+        result.bound = bbResult.bound;
+        result.nbBranches = bbResult.nbNodes;
+        result.nbFails = bbResult.nbFails;
+        result.time = bbResult.time;
+    }
+
+    return keepGoing;
+}
+
+
+void MSSCInterleavedSolves::run() {
+    while (step());
+}
+
+#endif // C++20
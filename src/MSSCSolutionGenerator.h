@@ -0,0 +1,182 @@
+/*
+ * C++20 coroutine interface over MSSCSolver's step-wise API, and cooperative interleaving of several solves on one thread.
+ * Only available when compiling with C++20 or later.
+ *
+ * MSSCSolutionGenerator yields each improving solution of a solve, eg.
+ *     for (const MSSCSolution& solution : generateSolutions(solver, &result)) { ... }
+ *     Leaving the loop early (or destroying the generator) ends the search, which is then reported as interrupted.
+ *
+ * MSSCInterleavedSolves runs many (small) solves on the calling thread. Each step gives the turn to the solve which has
+ *     explored the fewest nodes so far, for a budget of nodesPerStep nodes: the step ends once the budget is spent,
+ *     whether a solution was found or not. SolverParameters::branchLimit, failLimit and timeLimit cap each solve.
+ *     NOTE: CP Optimizer cannot suspend IloCP::next in the middle of a search, so solves run on MSSCSolver are interleaved
+ *     at solution granularity, never within the search for one solution.
+ *     Opt-in (branchAndBound): solves that MSSCBranchAndBound supports (target cardinalities, no weights, a card-control
+ *     constraint) are run by it instead, its search resuming where the previous step left it, so that steps keep to their
+ *     budget. It is a different solver: of SolverParameters, only constraint (Standard, or Network for the Network and
+ *     Lagrangian ones), symmetryBreaking, the limits and the relative gap (the larger of relativeGap and
+ *     propagation.relativeGap, as MSSCSolver) carry over. searchParameters, propagation, probingWorkers,
+ *     columnGenerationIterations and projection are ignored. Several improving solutions within one step are reported as
+ *     one, the last.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __MSSC_SOLUTION_GENERATOR_H
+#define __MSSC_SOLUTION_GENERATOR_H
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MSSCSolver.h"
+
+// Resumable search for the budgeted steps
+#include "MSSCBranchAndBound.h"
+
+
+class MSSCSolutionGenerator {
+public:
+    struct promise_type {
+        const MSSCSolution* current = nullptr;
+        std::exception_ptr exception;
+
+        MSSCSolutionGenerator get_return_object() {
+            return MSSCSolutionGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; } // Lazy, the search starts on first resume
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(const MSSCSolution& solution) noexcept {
+            current = &solution;
+            return {};
+        }
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+
+    class iterator {
+    private:
+        MSSCSolutionGenerator* _generator;
+
+    public:
+        iterator(MSSCSolutionGenerator* generator) : _generator(generator) {}
+
+        const MSSCSolution& operator*() const { return _generator->get(); }
+        iterator& operator++() {
+            if (!_generator->next())
+                _generator = nullptr;
+            return *this;
+        }
+        bool operator==(std::default_sentinel_t) const { return _generator == nullptr; }
+    };
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+
+    explicit MSSCSolutionGenerator(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+public:
+    MSSCSolutionGenerator() {}
+    MSSCSolutionGenerator(MSSCSolutionGenerator&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+    MSSCSolutionGenerator& operator=(MSSCSolutionGenerator&& other) noexcept {
+        if (this != &other) {
+            if (_handle)
+                _handle.destroy();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    MSSCSolutionGenerator(const MSSCSolutionGenerator&) = delete;
+    MSSCSolutionGenerator& operator=(const MSSCSolutionGenerator&) = delete;
+
+    ~MSSCSolutionGenerator() {
+        if (_handle)
+            _handle.destroy(); // Ends the search if still in progress
+    }
+
+    // Resume the search until next improving solution. Returns false once the search is over, rethrows its exceptions.
+    bool next() {
+        if (!_handle || _handle.done())
+            return false;
+
+        _handle.resume();
+
+        if (_handle.promise().exception)
+            std::rethrow_exception(std::exchange(_handle.promise().exception, nullptr));
+
+        return !_handle.done();
+    }
+
+    bool isDone() const { return !_handle || _handle.done(); }
+
+    // Last solution yielded, valid until next resume
+    const MSSCSolution& get() const { return *_handle.promise().current; }
+
+    iterator begin() {
+        iterator it(this);
+        return ++it;
+    }
+    std::default_sentinel_t end() { return std::default_sentinel; }
+};
+
+
+// solver must outlive the generator and must not be searching. If result is given, it receives the final result
+//     once the search ends (normally or not).
+MSSCSolutionGenerator generateSolutions(MSSCSolver& solver, MSSCResult* result = nullptr);
+
+
+class MSSCInterleavedSolves {
+private:
+    struct Solve {
+        std::unique_ptr<MSSCBranchAndBound> engine; // Budgeted solve, NULL if MSSCBranchAndBound doesn't support it
+        SolverParameters parameters; // Limits of engine
+
+        std::unique_ptr<MSSCSolver> solver; // Otherwise, stepped by solutions
+        MSSCSolutionGenerator generator;
+
+        SolutionCallback onSolution;
+        MSSCResult result;
+        bool done;
+
+        IloInt getNbNodes() const { return engine ? (IloInt) engine->getNbNodes() : solver->getSearchNbBranches(); }
+    };
+
+    std::vector<std::unique_ptr<Solve>> solves;
+    size_t nbRemaining;
+    long _nodesPerStep;
+    bool _branchAndBound;
+
+    // Run engine for one budget, returns whether to go on
+    bool stepEngine(Solve& solve);
+
+public:
+    // branchAndBound runs the solves it supports on MSSCBranchAndBound rather than MSSCSolver, see above
+    explicit MSSCInterleavedSolves(long nodesPerStep = 1000, bool branchAndBound = false) :
+    nbRemaining(0), _nodesPerStep(nodesPerStep), _branchAndBound(branchAndBound) {}
+
+    // Returns the index of the solve. data must outlive this object. onSolution may return false to stop its solve.
+    size_t add(const Data& data, const SolverParameters& solverParameters, const SolutionCallback& onSolution = SolutionCallback());
+
+    // Advance one solve by nodesPerStep nodes (by one solution if it isn't budgeted). Returns false once all solves are over.
+    bool step();
+
+    // Step until all solves are over
+    void run();
+
+    size_t getNbSolves() const { return solves.size(); }
+    bool isDone(size_t s) const { return solves[s]->done; }
+    const MSSCResult& getResult(size_t s) const { return solves[s]->result; } // Only meaningful once isDone(s)
+};
+
+#endif // C++20
+
+#endif // !__MSSC_SOLUTION_GENERATOR_H
@@ -0,0 +1,572 @@
+/*
+ * High-level solver for (cardinality-constrained) Minimum Sum of Squares Clustering (MSSC).
+ * Refer to MSSCSolver.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#include "MSSCSolver.h"
+
+// Constraints
+#include "IloIntPrecedeBinary.h"
+#include "IloWCSS.h"
+#include "IloWCSS_StandardCardControl.h"
+#include "IloWCSS_NetworkCardControl.h"
+#include "IloWCSS_LagrangianCardControl.h"
+
+// Root probing
+#include "MSSCBranchAndBound.h"
+
+// Root column generation
+#include "ColumnGeneration.h"
+
+
+// Time limit of the MIP over the columns of the root column generation (s)
+#define __COLUMN_GENERATION_MIP_TIME 10
+
+// Subtracted from the column generation bound before posting it, protection against rounding errors (as in the WCSS constraints)
+#define __COLUMN_GENERATION_EPSILON 5e-5
+
+
+MSSCSolver::MSSCSolver(const Data& data, const SolverParameters& solverParameters) :
+_data(data), _parameters(solverParameters), _modelData(&data), _modelProjection(solverParameters.projection),
+solFound(false), stopRequested(false), runningCP(NULL) {
+    _incumbent.resize(_data.N);
+
+    // The endgame completes nodes against the target cardinalities and must agree with the model's symmetry breaking
+    if (_parameters.constraint == CustomCPSolverOptions::Constraint::WCSS)
+        _parameters.searchParameters.endgameThreshold = 0;
+    _parameters.searchParameters.valuePrecedence = _parameters.symmetryBreaking;
+
+    // The constraints prune what can't improve on the incumbent by the relative gap, see PropagationSchedule::getPruningBound
+    _parameters.propagation.relativeGap = std::max(_parameters.propagation.relativeGap, _parameters.relativeGap);
+    _parameters.propagation.incumbent = &_incumbentValue;
+
+    if (_data.nbMustLinks > 0) {
+        _contraction.reset(new MustLinkContraction(_data));
+        _modelData = &_contraction->getData();
+        _modelIncumbent.resize(_modelData->N);
+
+        // A super-point lies at the (weighted) mean of its observations on the line as well
+        if (_parameters.projection != NULL) {
+            _contractedProjection.assign(_modelData->N, 0.0);
+            for (int i = 0; i < _data.N; i++) {
+                const int weight = (_data.weights != NULL) ? _data.weights[i] : 1;
+                _contractedProjection[_contraction->getComponent(i)] += weight*_parameters.projection[i];
+            }
+            for (int a = 0; a < _modelData->N; a++)
+                _contractedProjection[a] /= _modelData->weights[a];
+
+            _modelProjection = _contractedProjection.data();
+        }
+    }
+}
+
+
+MSSCSolver::~MSSCSolver() {
+    if (_search)
+        releaseSearch();
+}
+
+
+void MSSCSolver::abort() {
+    stopRequested = true;
+
+    std::lock_guard<std::mutex> lock(runningMutex);
+    if (runningCP != NULL)
+        runningCP->abortSearch(); // CP Optimizer allows aborting a search from another thread
+}
+
+
+bool MSSCSolver::isOneDimensional() const {
+    const bool cardinalitiesKnown = (_parameters.constraint != CustomCPSolverOptions::Constraint::WCSS);
+
+    return (!_contraction || _contraction->isFeasible()) && isOneDimensionalSolvable(*_modelData, _modelProjection, cardinalitiesKnown);
+}
+
+
+bool MSSCSolver::isStopRequested() const {
+    const SearchControl* control = _parameters.searchParameters.control;
+
+    return stopRequested || (control != NULL && control->isCancelRequested());
+}
+
+
+void MSSCSolver::buildModel(IloEnv env, IloModel model, IloIntVarArray x, IloFloatVar V, IloIntVarArray cardinality) const {
+    const Data& data = *_modelData;
+    const bool cardinalitiesKnown = (_parameters.constraint != CustomCPSolverOptions::Constraint::WCSS);
+
+    model.add(V);
+    model.add(x);
+
+    // CONSTRAINT: Link cardinality to actual cardinalities through Global Cardinality Constraint (GCC)
+    //     When cardinalities are known, they are fixed directly through the domains of the cardinality variables
+    //     With weights, cardinalities are loads (in units) and the GCC becomes a pack constraint
+    if (cardinalitiesKnown)
+        for (int c = 0; c < data.K; c++)
+            cardinality[c].setBounds(data.targetCardinalities[c], data.targetCardinalities[c]);
+
+    if (data.weights == NULL) {
+        IloIntArray vals(env, data.K);
+        for (int c = 0; c < data.K; c++)
+            vals[c] = c;
+        model.add(IloDistribute(env, cardinality, vals, x));
+    }
+    else {
+        IloIntArray weights(env, data.N);
+        for (int i = 0; i < data.N; i++)
+            weights[i] = data.weights[i];
+        model.add(IloPack(env, cardinality, x, weights));
+    }
+
+    // BRAIN: MSSC resolution constraint
+    switch (_parameters.constraint) {
+        case CustomCPSolverOptions::Constraint::WCSS:
+        case CustomCPSolverOptions::Constraint::WCSS_EXTERNAL_CARD_CONTROL:
+            model.add(IloWCSS(env, x, V, &data, &_parameters.propagation));
+            break;
+
+        case CustomCPSolverOptions::Constraint::STANDARD_CARD_CONTROL:
+            model.add(IloWCSS_StandardCardControl(env, x, V, &data, &_parameters.propagation));
+            break;
+
+        case CustomCPSolverOptions::Constraint::NETWORK_CARD_CONTROL:
+            model.add(IloWCSS_NetworkCardControl(env, x, V, &data, &_parameters.propagation));
+            break;
+
+        case CustomCPSolverOptions::Constraint::LAGRANGIAN_CARD_CONTROL:
+            model.add(IloWCSS_LagrangianCardControl(env, x, V, &data, &_parameters.propagation));
+            break;
+    }
+
+    // CONSTRAINT: Binding objective variable to WCSS using actual expression
+    //     Pairs at null dissimilarity contribute nothing and are skipped. When cardinalities are known,
+    //     each cluster's sum is divided by a constant rather than by a cardinality variable.
+    //     Cannot-links are propagated inside the MSSC constraint itself.
+    IloNumExpr ub_V_exp(env); // V for current solution
+    for (int c = 0; c < data.K; c++) { // for each cluster
+        IloNumExpr wcsd(env); // within cluster sum of dissimilarities for cluster c (between units if weighted)
+
+        for (int pt1 = 0; pt1 < (data.N - 1); pt1++)
+            for (int pt2 = (pt1 + 1); pt2 < data.N; pt2++) // for each pair of points
+                if (data.dissimilarities[pt1][pt2] != 0) {
+                    double weight = (data.weights != NULL) ? ((double) data.weights[pt1]*data.weights[pt2]) : 1.0;
+                    wcsd += ((x[pt1] == c)*(x[pt2] == c)*(weight*data.dissimilarities[pt1][pt2]));
+                }
+
+        if (cardinalitiesKnown)
+            ub_V_exp += (wcsd / data.targetCardinalities[c]);
+        else
+            ub_V_exp += (wcsd / cardinality[c]);
+    }
+
+    model.add(V == ub_V_exp);
+
+    // SYM BREAKING: Pair-wise int value precedence for breaking value symmetry
+    //     Only clusters of equal target cardinality are interchangeable: each one follows the previous one of equal target,
+    //     as in MSSCBranchAndBound (any two adjacent clusters if cardinalities are free)
+    if (_parameters.symmetryBreaking)
+        for (int c = 1; c < data.K; c++)
+            for (int c2 = c - 1; c2 >= 0; c2--)
+                if (!cardinalitiesKnown || data.targetCardinalities[c2] == data.targetCardinalities[c]) {
+                    model.add(IloIntPrecedeBinary(env, x, c2, c));
+                    break;
+                }
+
+    // OBJECTIVE: Minimize total WCSS
+    model.add(IloMinimize(env, V));
+}
+
+
+// Relabel clusters of equal target cardinality in order of first appearance, as value precedence requires
+static void relabelByFirstAppearance(const Data& data, std::vector<int>& memberships) {
+    std::vector<int> label(data.K, -1);
+    std::vector<char> used(data.K, 0);
+
+    for (int i = 0; i < data.N; i++) {
+        const int c = memberships[i];
+        if (label[c] < 0)
+            for (int c2 = 0; c2 < data.K; c2++)
+                if (!used[c2] && data.targetCardinalities[c2] == data.targetCardinalities[c]) {
+                    label[c] = c2;
+                    used[c2] = 1;
+                    break;
+                }
+        memberships[i] = label[c];
+    }
+}
+
+
+void MSSCSolver::rootColumnGeneration(IloModel model, IloFloatVar V, std::vector<int>& seed) const {
+    const Data& data = *_modelData;
+
+    if (_parameters.columnGenerationIterations <= 0 || _parameters.constraint == CustomCPSolverOptions::Constraint::WCSS
+        || !ColumnGeneration::isSupported(data))
+        return;
+
+    ColumnGeneration generation(data);
+    if (data.memberships != NULL)
+        generation.addPartition(data.memberships);
+
+    double mipTimeLimit = __COLUMN_GENERATION_MIP_TIME;
+    if (_parameters.timeLimit > 0)
+        mipTimeLimit = std::min(mipTimeLimit, _parameters.timeLimit / 10);
+    generation.run(_parameters.columnGenerationIterations, mipTimeLimit, [this]() { return isStopRequested(); });
+
+    if (generation.getBound() > __COLUMN_GENERATION_EPSILON)
+        model.add(V >= generation.getBound() - __COLUMN_GENERATION_EPSILON);
+
+    // The partition must be in the search's symmetry class to be followed
+    if (generation.hasSolution()) {
+        seed = generation.getMemberships();
+        if (_parameters.symmetryBreaking)
+            relabelByFirstAppearance(data, seed);
+    }
+}
+
+
+void MSSCSolver::probeRoot(IloModel model, IloIntVarArray x, const std::vector<int>& seed) const {
+    const Data& data = *_modelData;
+
+    if (_parameters.probingWorkers <= 0 || _parameters.constraint == CustomCPSolverOptions::Constraint::WCSS
+        || !MSSCBranchAndBound::isSupported(data))
+        return;
+
+    BBParameters bbParameters;
+    bbParameters.bound = (_parameters.constraint == CustomCPSolverOptions::Constraint::NETWORK_CARD_CONTROL
+                          || _parameters.constraint == CustomCPSolverOptions::Constraint::LAGRANGIAN_CARD_CONTROL)
+                         ? CustomBBOptions::Bound::NETWORK_CARD_CONTROL : CustomBBOptions::Bound::STANDARD_CARD_CONTROL;
+    bbParameters.symmetryBreaking = _parameters.symmetryBreaking; // Same precedence as the model's
+    bbParameters.relativeGap = _parameters.propagation.relativeGap; // Values which can't improve on the incumbent by the gap, as the constraints
+
+    // Initial solution: the partition of the root column generation, the indicated memberships, otherwise a dive of the
+    //     branch-and-bound (N nodes reach a leaf unless it fails on the way). Probing against none still removes the values
+    //     that propagation alone refutes.
+    MSSCBranchAndBound prober(data, bbParameters);
+
+    std::vector<int> memberships;
+    if (!seed.empty())
+        memberships = seed;
+    else if (data.memberships != NULL)
+        memberships.assign(data.memberships, data.memberships + data.N);
+    else {
+        MSSCBranchAndBound dive(data, bbParameters);
+        dive.run(data.N);
+        memberships = dive.getResult().memberships;
+    }
+
+    // The incumbent must remain a solution of the model: in the search's symmetry class, and its values kept below since
+    //     probing only spares solutions strictly better than it
+    if (!memberships.empty() && _parameters.symmetryBreaking)
+        relabelByFirstAppearance(data, memberships);
+    if (!memberships.empty() && !prober.setIncumbent(memberships.data()))
+        memberships.clear();
+
+    // Nothing better than the incumbent: it is optimal, the search is left to find it
+    if (prober.probeRoot(_parameters.probingWorkers, [this]() { return isStopRequested(); }) < 0) {
+        if (!memberships.empty())
+            for (int i = 0; i < data.N; i++)
+                model.add(x[i] == memberships[i]);
+        return;
+    }
+
+    for (int i = 0; i < data.N; i++)
+        for (int c = 0; c < data.K; c++)
+            if (!prober.isInRootDomain(i, c) && (memberships.empty() || memberships[i] != c))
+                model.add(x[i] != c);
+}
+
+
+// Engine state of the search in progress, only exists between startSearch and endSearch
+struct MSSCSolver::SearchState {
+    IloEnv env;
+    IloIntVarArray x;
+    IloCP cp;
+
+    MSSCResult result; // Filled as the search goes
+    bool exhausted; // IloCP::next returned false (search over or limit reached)
+
+    bool exact; // Solved by OneDimensionalSolver or infeasible must-links, there is no model nor engine
+    double exactObjective; // WCSS of the exact solution (on the model instance), negative if infeasible
+    double exactTime; // Duration of the exact resolution (s)
+
+    // Referenced by the search goal: the model instance, its buffers and search parameters, possibly set to follow a seed partition first
+    Data goalData;
+    SearchParameters searchParameters;
+    SearchBuffers buffers;
+    std::vector<int> seed;
+};
+
+
+static void initResult(MSSCResult& result) {
+    result.status = CustomCPSolverOptions::Status::UNKNOWN;
+    result.objective = IloInfinity;
+    result.bound = 0;
+    result.nbSolutions = 0;
+    result.nbBranches = 0;
+    result.nbFails = 0;
+    result.time = 0;
+}
+
+
+void MSSCSolver::releaseSearch() {
+    {
+        std::lock_guard<std::mutex> lock(runningMutex);
+        runningCP = NULL;
+    }
+    stopRequested = false;
+
+    _search->env.end(); // Concert Technology objects are not released when going out of scope
+    _search.reset();
+}
+
+
+void MSSCSolver::startSearch() {
+    assert(!_search); // One search at a time per solver
+
+    solFound = false;
+    _incumbentValue.reset(); // The new search must find its own solutions again
+
+    _search.reset(new SearchState());
+    initResult(_search->result);
+    _search->exhausted = false;
+    _search->exact = false;
+
+    // Cannot-links within a must-link component can never be satisfied: infeasible, without model nor engine
+    if (_contraction && !_contraction->isFeasible()) {
+        _search->exact = true;
+        _search->exactObjective = -1;
+        _search->exactTime = 0;
+        return;
+    }
+
+    // Exact resolution, the only solution is handed out by nextSolution
+    if (isOneDimensional()) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const bool cardinalitiesKnown = (_parameters.constraint != CustomCPSolverOptions::Constraint::WCSS);
+        int* memberships = _contraction ? _modelIncumbent.data() : _incumbent.data();
+
+        _search->exact = true;
+        _search->exactObjective = solveOneDimensional(*_modelData, _modelProjection, cardinalitiesKnown, memberships);
+        _search->exactTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    try {
+        IloEnv env = _search->env;
+        IloModel model(env);
+
+        // VARIABLES: Representative and auxiliary variables
+        // Without must-links, the model is built on the observations themselves. With must-links, on super-points of
+        //     the contraction, whose WCSS differs from that of the observations by a constant offset.
+        const Data& data = *_modelData;
+        IloInt totalWeight = data.N;
+        if (data.weights != NULL)
+            for (int i = 0; i < data.N; i++)
+                totalWeight += data.weights[i] - 1;
+
+        IloIntVarArray x(env, data.N, 0, (data.K - 1)); // Observation representative variables, size N array, domains 0..K-1
+        IloFloatVar V(env, 0, IloInfinity); // Objective variable, total within cluster sum of squares (WCSS). domain 0..inf
+        IloIntVarArray cardinality(env, data.K, 1, totalWeight); // Clusters' cardinalities, size K array, domains 1..N (in units)
+
+        buildModel(env, model, x, V, cardinality);
+        // Phases before the search are skipped once it is stopped, the search then ends at once (see nextSolution)
+        if (!isStopRequested())
+            rootColumnGeneration(model, V, _search->seed);
+        if (!isStopRequested())
+            probeRoot(model, x, _search->seed);
+        _search->x = x;
+
+        // SEARCH STRATEGY: Custom search heuristic, which first follows the partition of the root column generation if any
+        _search->goalData = data;
+        _search->searchParameters = _parameters.searchParameters;
+        _search->searchParameters.buffers = &_search->buffers;
+        if (!_search->seed.empty()) {
+            _search->goalData.memberships = _search->seed.data();
+            _search->searchParameters.initialSolution = CustomCPSearchOptions::InitialSolution::MEMBERSHIPS_AS_INDICATED;
+        }
+        IloGoal masterSearch = IloMSSCSearchStrategy(env, x, _search->goalData, _search->searchParameters, solFound); // Initial goal
+
+        // ENGINE: Creating and configuring CP algorithm
+        IloCP cp(model);
+        if (_parameters.quiet)
+            cp.setParameter(IloCP::LogVerbosity, IloCP::Quiet);
+        if (_parameters.timeLimit > 0)
+            cp.setParameter(IloCP::TimeLimit, _parameters.timeLimit);
+        if (_parameters.failLimit > 0)
+            cp.setParameter(IloCP::FailLimit, _parameters.failLimit);
+        if (_parameters.branchLimit > 0)
+            cp.setParameter(IloCP::BranchLimit, _parameters.branchLimit);
+        // No IloCP::RelativeOptimalityTolerance: the gap is enforced by the constraints (see constructor), not twice
+        _search->cp = cp;
+
+        // RESOLUTION: refer to main.cpp as to why IloCP::solve is not used
+        cp.startNewSearch(masterSearch);
+
+        // Make engine reachable from abort
+        {
+            std::lock_guard<std::mutex> lock(runningMutex);
+            runningCP = &_search->cp;
+        }
+    }
+    catch (...) {
+        releaseSearch();
+        throw;
+    }
+}
+
+
+bool MSSCSolver::nextSolution(MSSCSolution& solution) {
+    assert(_search);
+
+    if (_search->exhausted)
+        return false;
+
+    if (_search->exact) {
+        _search->exhausted = true;
+        if (isStopRequested() || _search->exactObjective < 0)
+            return false;
+
+        if (_contraction)
+            _contraction->expand(_modelIncumbent.data(), _incumbent.data());
+
+        MSSCResult& result = _search->result;
+        result.objective = _search->exactObjective + (_contraction ? _contraction->getOffset() : 0);
+        result.nbSolutions = 1;
+
+        solution.objective = solution.bound = result.objective;
+        solution.memberships = _incumbent.data();
+        solution.time = _search->exactTime;
+        solution.index = 0;
+
+        return true;
+    }
+
+    try {
+        if (isStopRequested() || !_search->cp.next()) {
+            _search->exhausted = true;
+            return false;
+        }
+
+        solFound = true; // At least one solution is found, so set to true
+
+        // Hot path: copy values into preallocated buffer, no formatting
+        const double offset = _contraction ? _contraction->getOffset() : 0;
+        if (_contraction) {
+            for (int i = 0; i < _modelData->N; i++)
+                _modelIncumbent[i] = (int) _search->cp.getValue(_search->x[i]);
+            _contraction->expand(_modelIncumbent.data(), _incumbent.data());
+        }
+        else {
+            for (int i = 0; i < _data.N; i++)
+                _incumbent[i] = (int) _search->cp.getValue(_search->x[i]);
+        }
+
+        _incumbentValue.update(_search->cp.getObjValue()); // Before the search resumes, on the model instance
+
+        MSSCResult& result = _search->result;
+        result.objective = _search->cp.getObjValue() + offset;
+        result.nbSolutions++;
+
+        solution.objective = result.objective;
+        solution.bound = _search->cp.getObjBound() + offset;
+        solution.memberships = _incumbent.data();
+        solution.time = _search->cp.getTime();
+        solution.index = result.nbSolutions - 1;
+    }
+    catch (...) {
+        releaseSearch();
+        throw;
+    }
+
+    return true;
+}
+
+
+IloInt MSSCSolver::getSearchNbBranches() const {
+    return (_search && !_search->exact) ? (IloInt) _search->cp.getInfo(IloCP::IntInfo::NumberOfBranches) : 0;
+}
+
+
+MSSCResult MSSCSolver::endSearch() {
+    assert(_search);
+
+    MSSCResult result = _search->result;
+
+    if (_search->exact) {
+        if (result.nbSolutions > 0) {
+            result.status = CustomCPSolverOptions::Status::OPTIMAL;
+            result.bound = result.objective;
+            result.memberships = _incumbent;
+        }
+        else if (_search->exhausted && _search->exactObjective < 0 && !isStopRequested())
+            result.status = CustomCPSolverOptions::Status::INFEASIBLE;
+        result.time = _search->exactTime;
+
+        releaseSearch();
+        return result;
+    }
+
+    try {
+        IloCP cp = _search->cp;
+
+        // A search which was stopped early, or cancelled (it then exhausts the tree through failures), has a meaningless engine status
+        const bool interrupted = !_search->exhausted || isStopRequested();
+
+        if (result.nbSolutions > 0)
+            result.memberships = _incumbent;
+
+        IloAlgorithm::Status cpStatus = cp.getStatus();
+        if (interrupted) {
+            if (result.nbSolutions > 0)
+                result.status = CustomCPSolverOptions::Status::FEASIBLE;
+        }
+        else if (cpStatus == IloAlgorithm::Optimal)
+            result.status = CustomCPSolverOptions::Status::OPTIMAL;
+        else if (cpStatus == IloAlgorithm::Infeasible)
+            result.status = CustomCPSolverOptions::Status::INFEASIBLE;
+        else if (result.nbSolutions > 0)
+            result.status = CustomCPSolverOptions::Status::FEASIBLE;
+
+        const double offset = _contraction ? _contraction->getOffset() : 0;
+        // Exhausted against the incumbent lowered by the relative gap, see PropagationSchedule::getPruningBound
+        result.bound = (result.status == CustomCPSolverOptions::Status::OPTIMAL) ? (result.objective - offset)*(1 - _parameters.propagation.relativeGap) + offset
+                                                                                 : (cp.getObjBound() + offset);
+        result.nbBranches = cp.getInfo(IloCP::IntInfo::NumberOfBranches);
+        result.nbFails = cp.getInfo(IloCP::IntInfo::NumberOfFails);
+        result.time = cp.getTime();
+
+        {
+            std::lock_guard<std::mutex> lock(runningMutex);
+            runningCP = NULL;
+        }
+
+        cp.endSearch();
+        cp.end();
+    }
+    catch (...) {
+        releaseSearch();
+        throw;
+    }
+
+    releaseSearch();
+
+    return result;
+}
+
+
+MSSCResult MSSCSolver::solve(const SolutionCallback& onSolution) {
+    startSearch();
+
+    MSSCSolution solution;
+    while (nextSolution(solution))
+        if (onSolution && !onSolution(solution))
+            break; // Stopped by callback, endSearch reports the search as interrupted
+
+    return endSearch();
+}
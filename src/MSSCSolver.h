@@ -0,0 +1,199 @@
+/*
+ * High-level solver for (cardinality-constrained) Minimum Sum of Squares Clustering (MSSC).
+ * This class builds, internally, the same Concert Technology model as the one main.cpp shows how to write by hand:
+ *     representative variables, GCC on cluster cardinalities, one of the WCSS constraints, binding of the objective
+ *     variable to the actual WCSS expression, value symmetry breaking, custom search goal and the IloCP::next loop.
+ *
+ * Solutions are streamed to a callback as they are found. The callback receives a view on a preallocated membership
+ *     buffer; nothing is formatted nor allocated on the search thread.
+ * The search can also be driven step by step (startSearch, nextSolution, endSearch), eg. to interleave several solves
+ *     on one thread (see MSSCSolutionGenerator.h).
+ *
+ * Must-linked observations are contracted into weighted super-points before the model is built (see MustLinkContraction.h).
+ *     Solutions, objective values and bounds are reported on the original observations.
+ * One-dimensional instances (S = 1, or a 1-D projection given in SolverParameters) are solved exactly by dynamic
+ *     programming, without building a model (see OneDimensionalSolver.h). The search then yields a single, optimal, solution.
+ *
+ * Main arguments: * data, refer to Data struct in Data.h for problem data nomenclature. Must outlive the solver.
+ *                 * solverParameters, see below for information on CustomCPSolverOptions.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __MSSC_SOLVER_H
+#define __MSSC_SOLVER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer
+#include <ilcp/cp.h>
+
+// Problem data structure
+#include "Data.h"
+
+// Must-link preprocessing
+#include "MustLinkContraction.h"
+
+// Exact resolution of one-dimensional instances
+#include "OneDimensionalSolver.h"
+
+// Search strategy
+#include "IloMSSCSearchStrategy.h"
+
+// Scheduling of cost-based filtering
+#include "PropagationSchedule.h"
+
+
+namespace CustomCPSolverOptions {
+    enum class Constraint {
+        WCSS, // IloWCSS alone, cardinalities are free (general MSSC)
+        WCSS_EXTERNAL_CARD_CONTROL, // IloWCSS with cardinalities fixed in the model through the GCC
+        STANDARD_CARD_CONTROL, // IloWCSS_StandardCardControl
+        NETWORK_CARD_CONTROL, // IloWCSS_NetworkCardControl
+        LAGRANGIAN_CARD_CONTROL // IloWCSS_LagrangianCardControl
+    };
+
+    enum class Status {
+        UNKNOWN, // No solution found, search interrupted by a limit
+        FEASIBLE, // Solution found, optimality not proven (limit reached or search stopped by callback)
+        OPTIMAL, // Solution found and proven optimal (within relativeGap)
+        INFEASIBLE // Search space exhausted without any solution
+    };
+}
+
+
+struct SolverParameters {
+    CustomCPSolverOptions::Constraint constraint;
+    SearchParameters searchParameters;
+
+    bool symmetryBreaking; // Post pair-wise integer value precedence between clusters of equal target cardinality (adjacent ones if free)
+
+    double timeLimit; // In seconds, <= 0 means no limit
+    IloInt failLimit; // <= 0 means no limit
+    IloInt branchLimit; // Node budget, <= 0 means no limit
+    double relativeGap; // Relative optimality tolerance, the constraints prune what can't improve on the incumbent by this share of it
+
+    bool quiet; // Suppress CP Optimizer log
+
+    PropagationParameters propagation; // Scheduling of cost-based filtering in the WCSS constraint, see PropagationSchedule.h
+
+    // Before the search, values which cannot improve on an initial solution (Data::memberships if valid, otherwise the
+    //     first one of a short dive) are removed from X by probing every (point, cluster) pair on that many threads,
+    //     see MSSCBranchAndBound::probeRoot. 0 (default) disables it. Unit weights, no must-links, cardinalities known.
+    int probingWorkers;
+
+    // Before the search (and probing), the set-partitioning LP relaxation is solved by column generation with at most that many
+    //     LP resolutions, see ColumnGeneration.h. Its bound is posted on V, and the best partition over the generated columns (or
+    //     Data::memberships if better) is followed first by the search. 0 (default) disables it. Cardinalities known.
+    int columnGenerationIterations;
+
+    // Optional N-element position of the observations on a line (NULL by default), must outlive the solver.
+    //     Dissimilarities must be the squared differences of these values, the instance is then solved exactly without search.
+    const double* projection;
+
+    SolverParameters() :
+        constraint(CustomCPSolverOptions::Constraint::NETWORK_CARD_CONTROL),
+        symmetryBreaking(true), timeLimit(0), failLimit(0), branchLimit(0), relativeGap(0), quiet(true), probingWorkers(0),
+        columnGenerationIterations(0), projection(NULL) {
+        searchParameters.initialSolution = CustomCPSearchOptions::InitialSolution::NONE;
+        searchParameters.mainSearch = CustomCPSearchOptions::MainSearch::MAX_MIN_VAR;
+        searchParameters.tieHandling = CustomCPSearchOptions::TieHandling::UNBOUND_FARTHEST_TOTAL_SS;
+    }
+};
+
+
+// View on an (intermediate) solution, only valid for the duration of the callback
+struct MSSCSolution {
+    double objective; // V
+    double bound; // Best lower bound on V known when this solution was found
+    const int* memberships; // N-element array, memberships[i] = c means observation i belongs to class c
+    double time; // Cumulative solve duration (s)
+    IloInt index; // Number of solutions found before this one
+};
+
+// Return false to stop the search after this solution
+typedef std::function<bool(const MSSCSolution&)> SolutionCallback;
+
+
+struct MSSCResult {
+    CustomCPSolverOptions::Status status;
+
+    double objective; // V of best solution, meaningless if no solution
+    double bound; // Best lower bound on V known at the end of the search
+    std::vector<int> memberships; // Best solution, empty if no solution
+
+    IloInt nbSolutions;
+    IloInt nbBranches;
+    IloInt nbFails;
+    double time; // Total solve duration (s)
+};
+
+
+class MSSCSolver {
+protected:
+    const Data& _data;
+    SolverParameters _parameters;
+
+    std::unique_ptr<MustLinkContraction> _contraction; // Only if _data has must-links
+    const Data* _modelData; // Instance the model is built on, _data or the contracted instance
+    const double* _modelProjection; // SolverParameters::projection of _modelData's observations, NULL if none
+    std::vector<double> _contractedProjection; // Storage behind _modelProjection on the contracted instance (centroids)
+
+    bool solFound; // Witness for initial solution found, handed to the search goal
+    IncumbentValue _incumbentValue; // Objective of the model's best solution, fed to the constraints (PropagationParameters::incumbent)
+
+    std::vector<int> _incumbent; // Preallocated buffer, filled from the engine at each solution
+    std::vector<int> _modelIncumbent; // Same on the contracted instance, expanded into _incumbent
+
+    std::atomic<bool> stopRequested; // Set by abort, possibly from another thread
+    std::mutex runningMutex; // Protects runningCP
+    IloCP* runningCP; // Engine of the search in progress, NULL when idle
+
+    struct SearchState;
+    std::unique_ptr<SearchState> _search; // Search in progress, NULL when idle
+
+    void buildModel(IloEnv env, IloModel model, IloIntVarArray x, IloFloatVar V, IloIntVarArray cardinality) const;
+    void rootColumnGeneration(IloModel model, IloFloatVar V, std::vector<int>& seed) const;
+    void probeRoot(IloModel model, IloIntVarArray x, const std::vector<int>& seed) const;
+    void releaseSearch();
+    bool isOneDimensional() const;
+    bool isStopRequested() const; // By abort or through SearchParameters::control
+
+public:
+    MSSCSolver(const Data& data, const SolverParameters& solverParameters = SolverParameters());
+
+    ~MSSCSolver();
+
+    MSSCSolver(const MSSCSolver&) = delete;
+    MSSCSolver& operator=(const MSSCSolver&) = delete;
+
+    const Data& getData() const { return _data; }
+    const SolverParameters& getParameters() const { return _parameters; }
+
+    // Blocking resolution. onSolution is called for each improving solution (may be empty).
+    //     IloException raised by Concert Technology or CP Optimizer are propagated to the caller.
+    MSSCResult solve(const SolutionCallback& onSolution = SolutionCallback());
+
+    // Step-wise resolution, solve is equivalent to startSearch, nextSolution until false, endSearch.
+    //     nextSolution fills solution (a view valid until the next call) and returns false once the search is over.
+    //     endSearch may be called at any time, the search is then reported as interrupted.
+    //     If any of them throws, the search is released and the solver is idle again.
+    void startSearch();
+    bool nextSolution(MSSCSolution& solution);
+    MSSCResult endSearch();
+
+    bool isSearching() const { return (bool) _search; }
+    IloInt getSearchNbBranches() const; // Nodes explored so far by the search in progress
+
+    // Stop the search in progress (or the next one if none is running) as soon as possible. Thread-safe.
+    //     The interrupted solve returns normally with the best solution found so far.
+    //     Cancellation requested through searchParameters.control has the same effect, checked at each branching decision.
+    void abort();
+};
+
+#endif // !__MSSC_SOLVER_H
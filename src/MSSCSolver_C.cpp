@@ -0,0 +1,252 @@
+/*
+ * C interface to the card-const-MSSC framework.
+ * Refer to card-const-MSSC-c.h for information.
+ *
+ * Data stores its N-by-S and N-by-N arrays as arrays of row pointers. Caller buffers are therefore referenced
+ *     through O(N) row pointers built here; the coordinates and dissimilarities themselves are never copied.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <new>
+#include <vector>
+
+#include "../card-const-MSSC-c.h"
+#include "MSSCSolver.h"
+
+
+static_assert(sizeof(int) == sizeof(int32_t), "Memberships are handed over in place, int must be 32 bits wide");
+
+
+struct mssc_solver {
+    Data data;
+    SolverParameters parameters;
+
+    std::vector<double*> coordinateRows; // Row pointers into caller buffer
+    std::vector<double*> dissimilarityRows; // Row pointers into caller buffer, or into ownedDissimilarities
+    std::vector<double> ownedDissimilarities; // Only used if caller gave no dissimilarities
+
+    MSSCSolver* solver;
+
+    mssc_solver() : solver(NULL) {}
+    ~mssc_solver() { delete solver; }
+};
+
+
+void mssc_options_init(mssc_options* options) {
+    if (options == NULL)
+        return;
+
+    SolverParameters defaults;
+    options->constraint = (int32_t) defaults.constraint;
+    options->initial_solution = (int32_t) defaults.searchParameters.initialSolution;
+    options->main_search = (int32_t) defaults.searchParameters.mainSearch;
+    options->tie_handling = (int32_t) defaults.searchParameters.tieHandling;
+    options->symmetry_breaking = defaults.symmetryBreaking ? 1 : 0;
+    options->time_limit = defaults.timeLimit;
+    options->fail_limit = defaults.failLimit;
+    options->relative_gap = defaults.relativeGap;
+}
+
+
+// Check everything the C++ layer asserts on, an assertion can't be reported to a C caller
+static bool isValid(const mssc_instance* instance, const mssc_options* options) {
+    if (instance->n <= 0 || instance->k <= 0 || instance->k > instance->n || instance->s < 0)
+        return false;
+    if (instance->coordinates == NULL && instance->dissimilarities == NULL)
+        return false;
+
+    if (options->constraint < MSSC_CONSTRAINT_WCSS || options->constraint > MSSC_CONSTRAINT_LAGRANGIAN_CARD_CONTROL)
+        return false;
+    if (options->initial_solution < MSSC_INITIAL_SOLUTION_NONE || options->initial_solution > MSSC_INITIAL_SOLUTION_MEMBERSHIPS_AS_INDICATED)
+        return false;
+    if (options->main_search != MSSC_MAIN_SEARCH_MAX_MIN_VAR)
+        return false;
+    if (options->tie_handling < MSSC_TIE_HANDLING_NONE || options->tie_handling > MSSC_TIE_HANDLING_MAX_MIN_POINT_FROM_ALL_CENTER)
+        return false;
+
+    // Center-based tie handling reads coordinates
+    if (instance->coordinates == NULL && (options->tie_handling == MSSC_TIE_HANDLING_FARTHEST_POINT_FROM_BIGGEST_CENTER
+                                          || options->tie_handling == MSSC_TIE_HANDLING_MAX_MIN_POINT_FROM_ALL_CENTER))
+        return false;
+
+    if (instance->memberships != NULL) {
+        for (int32_t i = 0; i < instance->n; i++)
+            if (instance->memberships[i] < 0 || instance->memberships[i] >= instance->k)
+                return false;
+    }
+    else if (options->initial_solution == MSSC_INITIAL_SOLUTION_MEMBERSHIPS_AS_INDICATED) {
+        return false;
+    }
+
+    if (instance->target_cardinalities != NULL) {
+        int64_t total = 0;
+        for (int32_t c = 0; c < instance->k; c++) {
+            if (instance->target_cardinalities[c] <= 0)
+                return false;
+            total += instance->target_cardinalities[c];
+        }
+        if (total != instance->n)
+            return false;
+    }
+    else if (options->constraint != MSSC_CONSTRAINT_WCSS) {
+        return false;
+    }
+
+    return true;
+}
+
+
+int32_t mssc_solver_create(const mssc_instance* instance, const mssc_options* options, mssc_solver** solver) {
+    if (instance == NULL || solver == NULL)
+        return MSSC_ERROR_INVALID_ARGUMENT;
+    *solver = NULL;
+
+    mssc_options defaultOptions;
+    if (options == NULL) {
+        mssc_options_init(&defaultOptions);
+        options = &defaultOptions;
+    }
+
+    if (!isValid(instance, options))
+        return MSSC_ERROR_INVALID_ARGUMENT;
+
+    mssc_solver* handle = NULL;
+    try {
+        handle = new mssc_solver();
+
+        const int32_t n = instance->n;
+        const int32_t s = instance->s;
+
+        // Reference caller buffers in place. Data is read-only to the framework, constness is only lost in the struct's declaration.
+        if (instance->coordinates != NULL) {
+            handle->coordinateRows.resize(n);
+            for (int32_t i = 0; i < n; i++)
+                handle->coordinateRows[i] = const_cast<double*>(instance->coordinates + (size_t) i*s);
+        }
+
+        handle->dissimilarityRows.resize(n);
+        if (instance->dissimilarities != NULL) {
+            for (int32_t i = 0; i < n; i++)
+                handle->dissimilarityRows[i] = const_cast<double*>(instance->dissimilarities + (size_t) i*n);
+        }
+        else {
+            handle->ownedDissimilarities.assign((size_t) n*n, 0.0);
+            for (int32_t i = 0; i < n; i++) {
+                handle->dissimilarityRows[i] = &handle->ownedDissimilarities[(size_t) i*n];
+                for (int32_t j = 0; j < i; j++) {
+                    double d = 0;
+                    for (int32_t f = 0; f < s; f++) {
+                        double diff = instance->coordinates[(size_t) i*s + f] - instance->coordinates[(size_t) j*s + f];
+                        d += diff*diff;
+                    }
+                    handle->ownedDissimilarities[(size_t) i*n + j] = d;
+                    handle->ownedDissimilarities[(size_t) j*n + i] = d;
+                }
+            }
+        }
+
+        handle->data.fileID = "mssc_c_api";
+        handle->data.N = n;
+        handle->data.S = s;
+        handle->data.K = instance->k;
+        handle->data.coordinates = handle->coordinateRows.empty() ? NULL : handle->coordinateRows.data();
+        handle->data.dissimilarities = handle->dissimilarityRows.data();
+        handle->data.memberships = const_cast<int*>(reinterpret_cast<const int*>(instance->memberships));
+        handle->data.targetCardinalities = const_cast<int*>(reinterpret_cast<const int*>(instance->target_cardinalities));
+
+        handle->parameters.constraint = (CustomCPSolverOptions::Constraint) options->constraint;
+        handle->parameters.searchParameters.initialSolution = (CustomCPSearchOptions::InitialSolution) options->initial_solution;
+        handle->parameters.searchParameters.mainSearch = (CustomCPSearchOptions::MainSearch) options->main_search;
+        handle->parameters.searchParameters.tieHandling = (CustomCPSearchOptions::TieHandling) options->tie_handling;
+        handle->parameters.symmetryBreaking = (options->symmetry_breaking != 0);
+        handle->parameters.timeLimit = options->time_limit;
+        handle->parameters.failLimit = (IloInt) options->fail_limit;
+        handle->parameters.relativeGap = options->relative_gap;
+        handle->parameters.quiet = true;
+
+        handle->solver = new MSSCSolver(handle->data, handle->parameters);
+    }
+    catch (std::bad_alloc&) {
+        delete handle;
+        return MSSC_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        delete handle;
+        return MSSC_ERROR_INTERNAL;
+    }
+
+    *solver = handle;
+    return MSSC_OK;
+}
+
+
+int32_t mssc_solve(mssc_solver* solver, int32_t* memberships_out, mssc_stats* stats_out,
+                   mssc_solution_callback callback, void* user_data) {
+    if (solver == NULL)
+        return MSSC_ERROR_INVALID_ARGUMENT;
+
+    try {
+        SolutionCallback onSolution;
+        if (callback != NULL) {
+            const int32_t n = solver->data.N;
+            onSolution = [callback, user_data, n](const MSSCSolution& solution) {
+                return callback(user_data, solution.objective, reinterpret_cast<const int32_t*>(solution.memberships), n, solution.time) != 0;
+            };
+        }
+
+        MSSCResult result = solver->solver->solve(onSolution);
+
+        if (memberships_out != NULL && !result.memberships.empty())
+            for (int32_t i = 0; i < solver->data.N; i++)
+                memberships_out[i] = (int32_t) result.memberships[i];
+
+        if (stats_out != NULL) {
+            stats_out->status = (int32_t) result.status;
+            stats_out->objective = result.objective;
+            stats_out->bound = result.bound;
+            stats_out->nb_solutions = (int64_t) result.nbSolutions;
+            stats_out->nb_branches = (int64_t) result.nbBranches;
+            stats_out->nb_fails = (int64_t) result.nbFails;
+            stats_out->time = result.time;
+        }
+    }
+    catch (IloException&) {
+        return MSSC_ERROR_ENGINE;
+    }
+    catch (std::bad_alloc&) {
+        return MSSC_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return MSSC_ERROR_INTERNAL;
+    }
+
+    return MSSC_OK;
+}
+
+
+int32_t mssc_cancel(mssc_solver* solver) {
+    if (solver == NULL)
+        return MSSC_ERROR_INVALID_ARGUMENT;
+
+    solver->solver->abort();
+    return MSSC_OK;
+}
+
+
+void mssc_solver_destroy(mssc_solver* solver) {
+    delete solver;
+}
+
+
+const char* mssc_error_string(int32_t code) {
+    switch (code) {
+        case MSSC_OK: return "success";
+        case MSSC_ERROR_INVALID_ARGUMENT: return "invalid argument";
+        case MSSC_ERROR_OUT_OF_MEMORY: return "out of memory";
+        case MSSC_ERROR_ENGINE: return "optimization engine error";
+        case MSSC_ERROR_INTERNAL: return "internal error";
+        default: return "unknown error code";
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ * Must-link preprocessing: contraction of must-linked observations into weighted super-points.
+ * Refer to MustLinkContraction.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include "MustLinkContraction.h"
+
+
+// Union-find root with path halving
+static int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+
+    return i;
+}
+
+
+// Weight of observation i, if the original instance is weighted
+static inline int getWeight(const Data& data, int i) {
+    return (data.weights != NULL) ? data.weights[i] : 1;
+}
+
+
+MustLinkContraction::MustLinkContraction(const Data& data) : _original(data), feasible(true), offset(0) {
+    const int N = data.N;
+
+    // Connected components of the must-link graph
+    std::vector<int> parent(N);
+    for (int i = 0; i < N; i++)
+        parent[i] = i;
+
+    for (int l = 0; l < data.nbMustLinks; l++) {
+        int a = findRoot(parent, data.mustLinks[2*l]), b = findRoot(parent, data.mustLinks[2*l + 1]);
+        if (a != b)
+            parent[a < b ? b : a] = (a < b ? a : b); // Smallest index as root, super-points keep the order of observations
+    }
+
+    // Number components in order of their first observation
+    component.assign(N, -1);
+    std::vector<int> rootComponent(N, -1);
+    int nbComponents = 0;
+    for (int i = 0; i < N; i++) {
+        int r = findRoot(parent, i);
+        if (rootComponent[r] == -1)
+            rootComponent[r] = nbComponents++;
+        component[i] = rootComponent[r];
+    }
+
+    weights.assign(nbComponents, 0);
+    for (int i = 0; i < N; i++)
+        weights[component[i]] += getWeight(data, i);
+
+    // Sums of dissimilarities between (and within) components (between units), O(N^2)
+    dissimilarityValues.assign(nbComponents*(size_t) nbComponents, 0.0);
+    for (int i = 0; i < N - 1; i++) {
+        const int a = component[i];
+        for (int j = i + 1; j < N; j++) {
+            const int b = component[j];
+            const double d = getWeight(data, i)*getWeight(data, j)*data.dissimilarities[i][j];
+            dissimilarityValues[a*(size_t) nbComponents + b] += d;
+            if (a != b)
+                dissimilarityValues[b*(size_t) nbComponents + a] += d;
+        }
+    }
+
+    // Sum of squares of each component around its centroid, SS_a = (1/w_a) sum of its pairwise dissimilarities
+    std::vector<double> componentSS(nbComponents);
+    for (int a = 0; a < nbComponents; a++) {
+        componentSS[a] = dissimilarityValues[a*(size_t) nbComponents + a] / weights[a];
+        offset += componentSS[a];
+    }
+
+    // Squared distances between centroids
+    dissimilarityRows.resize(nbComponents);
+    for (int a = 0; a < nbComponents; a++) {
+        dissimilarityRows[a] = &dissimilarityValues[a*(size_t) nbComponents];
+        dissimilarityRows[a][a] = 0;
+    }
+    for (int a = 0; a < nbComponents - 1; a++) {
+        for (int b = a + 1; b < nbComponents; b++) {
+            double d = dissimilarityRows[a][b] / ((double) weights[a]*weights[b]) - componentSS[a] / weights[a] - componentSS[b] / weights[b];
+            if (d < 0)
+                d = 0; // Rounding errors
+            dissimilarityRows[a][b] = dissimilarityRows[b][a] = d;
+        }
+    }
+
+    // Centroids
+    if (data.coordinates != NULL) {
+        coordinateValues.assign(nbComponents*(size_t) data.S, 0.0);
+        coordinateRows.resize(nbComponents);
+        for (int a = 0; a < nbComponents; a++)
+            coordinateRows[a] = &coordinateValues[a*(size_t) data.S];
+
+        for (int i = 0; i < N; i++)
+            for (int f = 0; f < data.S; f++)
+                coordinateRows[component[i]][f] += getWeight(data, i)*data.coordinates[i][f];
+
+        for (int a = 0; a < nbComponents; a++)
+            for (int f = 0; f < data.S; f++)
+                coordinateRows[a][f] /= weights[a];
+    }
+
+    // Initial solution, a component takes the class of its first observation
+    if (data.memberships != NULL) {
+        memberships.assign(nbComponents, -1);
+        for (int i = 0; i < N; i++)
+            if (memberships[component[i]] == -1)
+                memberships[component[i]] = data.memberships[i];
+    }
+
+    // Cannot-links between super-points
+    for (int l = 0; l < data.nbCannotLinks; l++) {
+        int a = component[data.cannotLinks[2*l]], b = component[data.cannotLinks[2*l + 1]];
+        if (a == b) {
+            feasible = false;
+            continue;
+        }
+
+        cannotLinks.push_back(a);
+        cannotLinks.push_back(b);
+    }
+
+    contracted.fileID = data.fileID;
+    contracted.N = nbComponents;
+    contracted.S = data.S;
+    contracted.K = data.K;
+    contracted.coordinates = coordinateRows.empty() ? NULL : coordinateRows.data();
+    contracted.dissimilarities = dissimilarityRows.data();
+    contracted.memberships = memberships.empty() ? NULL : memberships.data();
+    contracted.targetCardinalities = data.targetCardinalities; // Observation units
+    contracted.weights = weights.data();
+    contracted.nbMustLinks = 0;
+    contracted.mustLinks = NULL;
+    contracted.nbCannotLinks = (int) cannotLinks.size() / 2;
+    contracted.cannotLinks = cannotLinks.empty() ? NULL : cannotLinks.data();
+}
+
+
+void MustLinkContraction::expand(const int* contractedMemberships, int* originalMemberships) const {
+    for (int i = 0; i < _original.N; i++)
+        originalMemberships[i] = contractedMemberships[component[i]];
+}
@@ -0,0 +1,72 @@
+/*
+ * Must-link preprocessing: observations connected through must-link constraints (see Data::mustLinks) always share a
+ *     cluster, so each connected component can be replaced by a single super-point of weight |component| (the sum of the
+ *     weights of its observations if the original instance is weighted).
+ *
+ * For squared euclidean distances, the WCSS of a clustering of the observations is equal to:
+ *     offset + sum over clusters c of (1/W_c) sum over pairs {a, b} of super-points in c of w_a w_b d(a, b)
+ *     where offset is the sum of squares of each component around its own centroid (a constant), w_a the weight of
+ *     super-point a, W_c the total weight of c and d(a, b) the squared distance between the centroids of a and b.
+ *     d(a, b) is obtained from dissimilarities alone: d(a, b) = D(a, b)/(w_a w_b) - SS_a/w_a - SS_b/w_b, where D(a, b) is
+ *     the sum of dissimilarities between members of a and b, and SS_a the sum of squares of a.
+ *
+ * The contracted instance thus has N' = number of components, an N'-by-N' dissimilarity matrix, centroids as coordinates
+ *     (if the original instance has coordinates), cannot-links mapped onto super-points and the same target cardinalities
+ *     (in observation units), and super-point weights as Data::weights.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __MUST_LINK_CONTRACTION_H
+#define __MUST_LINK_CONTRACTION_H
+
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+
+class MustLinkContraction {
+protected:
+    const Data& _original;
+    Data contracted;
+
+    bool feasible; // False if a cannot-link joins two observations of a same component
+
+    std::vector<int> component; // component[i] = super-point of observation i
+    std::vector<int> weights; // weights[a] = number of observations in super-point a
+    double offset;
+
+    // Storage behind contracted's arrays
+    std::vector<double> coordinateValues;
+    std::vector<double*> coordinateRows;
+    std::vector<double> dissimilarityValues;
+    std::vector<double*> dissimilarityRows;
+    std::vector<int> memberships;
+    std::vector<int> cannotLinks;
+
+public:
+    // data must outlive the contraction
+    MustLinkContraction(const Data& data);
+
+    MustLinkContraction(const MustLinkContraction&) = delete;
+    MustLinkContraction& operator=(const MustLinkContraction&) = delete;
+
+    bool isFeasible() const { return feasible; }
+
+    // Contracted instance, only meaningful if feasible. Its weights are getWeights().
+    const Data& getData() const { return contracted; }
+    const int* getWeights() const { return weights.data(); }
+    int getNbSuperPoints() const { return contracted.N; }
+
+    // WCSS of the original instance = WCSS of contracted instance + getOffset()
+    double getOffset() const { return offset; }
+
+    int getComponent(int i) const { return component[i]; }
+
+    // Memberships of the original observations from memberships of the super-points (N'-element to N-element)
+    void expand(const int* contractedMemberships, int* originalMemberships) const;
+};
+
+#endif // !__MUST_LINK_CONTRACTION_H
@@ -0,0 +1,215 @@
+/*
+ * Nogoods learned from the bound failures of the WCSS constraints with target cardinalities.
+ * Refer to NogoodStore.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+
+#include "NogoodStore.h"
+
+
+// Bounds computed per failure to minimize the explanation, the points not tried yet are kept
+#define __NOGOOD_MAX_TESTS 64
+
+// Longer nogoods are seldom violated again, they aren't worth their propagation
+#define __NOGOOD_MAX_LENGTH 32
+
+
+void NogoodStore::build(const Data& data, IlcInt n, const PropagationParameters* parameters) {
+    _n = n;
+    _k = data.K;
+    _dissimilarities = data.dissimilarities;
+
+    capacity = (parameters != NULL && parameters->nogoodCapacity > 0 && parameters->incumbent != NULL && data.targetCardinalities != NULL) ? parameters->nogoodCapacity : 0;
+    nogoods.clear();
+    next = 0;
+    if (!isEnabled())
+        return;
+
+    _targets.assign(data.targetCardinalities, data.targetCardinalities + _k);
+    weights.build(data, _n);
+    cannotLinks.build(data, _n);
+
+    // s3 of every point among all points, which is smaller than among the free points of any node
+    const IlcInt length = *std::max_element(_targets.begin(), _targets.end());
+    std::vector<IlcInt> all(_n);
+    for (IlcInt i = 0; i < _n; i++)
+        all[i] = i;
+
+    halfContributions.resize(_n);
+    for (IlcInt i = 0; i < _n; i++) {
+        cannotLinks.markPartners(i);
+        weights.fillHalfContributions(i, all.data(), _n, _dissimilarities, cannotLinks, length, halfContributions[i]);
+        halfContributions[i].resize(std::min((IlcInt) halfContributions[i].size(), length));
+        halfContributions[i].shrink_to_fit();
+    }
+
+    clusterOf.assign(_n, -1);
+    members.resize(_k);
+    blocked.assign(_n, 0);
+}
+
+
+IlcInt NogoodStore::propagate(IlcIntVarArray X, DomainSnapshot& domains) {
+    IlcInt nbRemovals = 0;
+
+    bool removed = true;
+    while (removed) { // A removal may fix a variable, which makes other nogoods unit
+        removed = false;
+
+        for (const std::vector<IlcInt>& nogood : nogoods) {
+            IlcInt undecided = -1; // Only undecided literal, if any
+            bool satisfied = false;
+
+            for (IlcInt literal : nogood) {
+                const IlcInt i = literal / _k, c = literal % _k;
+                if (!domains.isInDomain(i, c)) {
+                    satisfied = true;
+                    break;
+                }
+                if (!domains.isFixed(i)) {
+                    if (undecided != -1) { // Two undecided literals, nothing to deduce
+                        satisfied = true;
+                        break;
+                    }
+                    undecided = literal;
+                }
+            }
+
+            if (satisfied)
+                continue;
+
+            if (undecided == -1)
+                return -1; // Every literal holds
+
+            X[undecided / _k].removeValue(undecided % _k);
+            domains.removeValue(undecided / _k, undecided % _k);
+            nbRemovals++;
+            nbPrunings++;
+            removed = true;
+        }
+    }
+
+    return nbRemovals;
+}
+
+
+bool NogoodStore::learn(const std::vector<IlcInt>* setP, IlcFloat ub, IlcFloat eps) {
+    std::fill(clusterOf.begin(), clusterOf.end(), -1);
+    for (IlcInt c = 0; c < _k; c++)
+        for (IlcInt i : setP[c])
+            clusterOf[i] = c;
+
+    // The explanation bound is weaker than that of the constraint, it may not fail even with every fixed point
+    if (getBound() - eps <= ub)
+        return false;
+
+    // Points which add least to their cluster are tried first
+    order.clear();
+    for (IlcInt c = 0; c < _k; c++) {
+        for (IlcInt i : setP[c]) {
+            IlcFloat contribution = 0;
+            for (IlcInt j : setP[c])
+                contribution += weights[j]*_dissimilarities[i][j];
+            order.push_back(std::make_pair(weights[i]*contribution, i*_k + c));
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    // Remove chunks of points for as long as the bound still fails, halving chunks otherwise
+    size_t chunk = std::max(order.size() / 2, (size_t) 1);
+    size_t first = 0;
+    for (IlcInt nbTests = 1; first < order.size() && nbTests < __NOGOOD_MAX_TESTS; nbTests++) {
+        const size_t last = std::min(first + chunk, order.size());
+        for (size_t r = first; r < last; r++)
+            clusterOf[order[r].second / _k] = -1;
+
+        if (getBound() - eps > ub) {
+            first = last;
+            continue;
+        }
+
+        for (size_t r = first; r < last; r++)
+            clusterOf[order[r].second / _k] = order[r].second % _k;
+
+        if (chunk == 1)
+            first++; // Needed, kept
+        else
+            chunk /= 2;
+    }
+
+    std::vector<IlcInt> nogood;
+    for (const std::pair<IlcFloat, IlcInt>& fixed : order)
+        if (clusterOf[fixed.second / _k] != -1)
+            nogood.push_back(fixed.second);
+
+    if (nogood.size() > __NOGOOD_MAX_LENGTH)
+        return false;
+
+    if (nogoods.size() < capacity) {
+        nogoods.push_back(nogood);
+    }
+    else {
+        nogoods[next].swap(nogood);
+        next = (next + 1) % capacity;
+    }
+    nbLearned++;
+
+    return true;
+}
+
+
+IlcFloat NogoodStore::getBound() {
+    for (IlcInt c = 0; c < _k; c++)
+        members[c].clear();
+    for (IlcInt i = 0; i < _n; i++)
+        if (clusterOf[i] != -1)
+            members[clusterOf[i]].push_back(i);
+
+    IlcFloat lb = 0;
+    for (IlcInt c = 0; c < _k; c++) {
+        const std::vector<IlcInt>& P = members[c];
+
+        const IlcInt toAdd = _targets[c] - weights.sum(P.data(), P.size());
+        if (toAdd < 0)
+            return IlcInfinity;
+
+        IlcFloat S1 = 0;
+        for (size_t a = 0; a + 1 < P.size(); a++)
+            for (size_t b = a + 1; b < P.size(); b++)
+                S1 += weights[P[a]]*weights[P[b]]*_dissimilarities[P[a]][P[b]];
+
+        if (toAdd == 0) {
+            lb += S1 / _targets[c];
+            continue;
+        }
+
+        // Free points cannot-linked to a point of c can't join it
+        stamp++;
+        for (IlcInt j : P)
+            for (const IlcInt* partner = cannotLinks.beginPartners(j); partner != cannotLinks.endPartners(j); partner++)
+                blocked[*partner] = stamp;
+
+        candidates.clear();
+        for (IlcInt i = 0; i < _n; i++) {
+            if (clusterOf[i] != -1 || blocked[i] == stamp || weights[i] > toAdd)
+                continue;
+
+            IlcFloat s2 = 0;
+            for (IlcInt j : P)
+                s2 += weights[j]*_dissimilarities[i][j];
+            candidates.push_back(WeightedContribution(s2 + halfContributions[i][toAdd - 1], weights[i]));
+        }
+
+        const IlcFloat S2 = ObservationWeights::sumSmallestUnits(candidates, toAdd);
+        if (S2 == IlcInfinity)
+            return IlcInfinity;
+
+        lb += (S1 + S2) / _targets[c];
+    }
+
+    return lb;
+}
@@ -0,0 +1,97 @@
+/*
+ * Nogoods learned from the bound failures of the WCSS constraints with target cardinalities, for use inside those constraints.
+ * When a constraint is about to fail because its lower bound exceeds the incumbent, the failure seldom depends on all
+ *     the fixed points. learn looks for a small subset E of them, fixed to their clusters, which still fails on its own, and records
+ *     the clause "not all of x_i == c for (i, c) in E". Every node where E holds is then cut off by propagate, without computing
+ *     any bound.
+ *
+ * Explanation bound: that of IlcWCSS_StandardCardControl with only the points of E fixed, every other point free to join any cluster
+ *     it fits (its weight, its cannot-links to E), and the s3 of each point taken among all points rather than the free ones. It
+ *     is a valid bound on every completion of E whatever the other domains, hence the nogood holds anywhere in the tree.
+ * Incumbent: nogoods are learned against the incumbent lowered by the relative gap (PropagationSchedule::getIncumbentBound),
+ *     never against the upper bound of V, which is local to the node. The incumbent only goes down during a search, so a nogood
+ *     holds until its end. Learning thus requires PropagationParameters::incumbent.
+ * Minimization: fixed points are tried for removal from E in order of increasing contribution to their cluster, by chunks that
+ *     halve when the bound no longer fails, a point being kept once it fails alone. At most __NOGOOD_MAX_TESTS bounds are
+ *     computed per failure, and nogoods longer than __NOGOOD_MAX_LENGTH aren't recorded (see NogoodStore.cpp).
+ * Store: at most PropagationParameters::nogoodCapacity nogoods, the oldest replaced first. propagate fails when a nogood has all
+ *     its literals true, and removes c from x_i when (i, c) is its only undecided literal.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __NOGOOD_STORE_H
+#define __NOGOOD_STORE_H
+
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Cannot-link constraints
+#include "CannotLinkGraph.h"
+
+// Observation weights
+#include "ObservationWeights.h"
+
+// Learning is enabled through the propagation parameters
+#include "PropagationSchedule.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+class NogoodStore {
+protected:
+    IlcInt _n, _k;
+    double const* const* _dissimilarities;
+    std::vector<IlcInt> _targets;
+
+    ObservationWeights weights;
+    CannotLinkGraph cannotLinks;
+    std::vector<std::vector<IlcFloat> > halfContributions; // halfContributions[i][m] = s3 of i among all points
+
+    size_t capacity;
+    std::vector<std::vector<IlcInt> > nogoods; // Literals i*_k + c
+    size_t next; // Slot of the next nogood once the store is full
+
+    // Working buffers of learn
+    std::vector<IlcInt> clusterOf; // clusterOf[i] = cluster of i if it is in E, -1 otherwise
+    std::vector<std::vector<IlcInt> > members;
+    std::vector<std::pair<IlcFloat, IlcInt> > order; // (contribution, i*_k + c) of the fixed points
+    std::vector<IlcInt> blocked; // blocked[i] == stamp means i is cannot-linked to the cluster at hand
+    IlcInt stamp;
+    std::vector<WeightedContribution> candidates;
+
+    IlcInt nbLearned, nbPrunings;
+
+    // Explanation bound with the points of clusterOf fixed, IlcInfinity if some cluster can't be completed
+    IlcFloat getBound();
+
+public:
+    NogoodStore() : _n(0), _k(0), _dissimilarities(NULL), capacity(0), next(0), stamp(0), nbLearned(0), nbPrunings(0) {}
+
+    // parameters may be NULL (no learning), learning also requires a target cardinality per cluster and an incumbent
+    void build(const Data& data, IlcInt n, const PropagationParameters* parameters);
+
+    bool isEnabled() const { return capacity > 0; }
+
+    // Enforce the nogoods on X, removals are mirrored in domains.
+    //     Returns the number of values removed, or -1 if a nogood is violated.
+    IlcInt propagate(IlcIntVarArray X, DomainSnapshot& domains);
+
+    // Called before failing on the bound, setP[c] being the points fixed to cluster c and ub the incumbent lowered by the
+    //     relative gap (see PropagationSchedule::getIncumbentBound).
+    //     Records a nogood if the explanation bound also exceeds ub + eps. Returns whether one was recorded.
+    bool learn(const std::vector<IlcInt>* setP, IlcFloat ub, IlcFloat eps);
+
+    IlcInt getNbNogoods() const { return nogoods.size(); }
+    IlcInt getNbLearned() const { return nbLearned; }
+    IlcInt getNbPrunings() const { return nbPrunings; }
+};
+
+#endif // !__NOGOOD_STORE_H
@@ -0,0 +1,165 @@
+/*
+ * Observation weights, for use inside the WCSS constraints.
+ * Refer to ObservationWeights.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cassert>
+
+#include "ObservationWeights.h"
+
+
+void ObservationWeights::build(const Data& data, IlcInt n) {
+    _weights.assign(n, 1);
+    total = n;
+    unit = true;
+
+    if (data.weights == NULL)
+        return;
+
+    total = 0;
+    for (IlcInt i = 0; i < n; i++) {
+        assert(data.weights[i] > 0);
+        _weights[i] = data.weights[i];
+        total += _weights[i];
+        unit = unit && (_weights[i] == 1);
+    }
+}
+
+
+IlcInt ObservationWeights::sum(const IlcInt* points, IlcInt nbPoints) const {
+    if (unit)
+        return nbPoints;
+
+    IlcInt weight = 0;
+    for (IlcInt i = 0; i < nbPoints; i++)
+        weight += _weights[points[i]];
+
+    return weight;
+}
+
+
+void ObservationWeights::fillHalfContributions(IlcInt i, const IlcInt* setU, IlcInt nbU, double const* const* dissimilarities,
+                                               const CannotLinkGraph& cannotLinks, IlcInt length, std::vector<IlcFloat>& s3) {
+    s3.clear();
+
+    if (unit) {
+        for (IlcInt j = 0; j < nbU; j++) {
+            // At first, we put all points in that list. Cannot-linked points can't share a cluster with i, they're pushed last.
+            if (cannotLinks.isMarked(setU[j]))
+                s3.push_back(IlcInfinity);
+            else
+                s3.push_back(dissimilarities[i][setU[j]] / 2);
+        }
+
+        std::sort(s3.begin(), s3.end()); // sort distances for each point, first element 0 because d(x,x) = 0
+
+        for (IlcInt j = 1; j < std::min(length, nbU); j++)
+            s3[j] += s3[j - 1]; // Compute minimum 1/2 contributions, first element is 0
+
+        return;
+    }
+
+    // Same on the unit expansion, the units of i itself (the first one included) are at distance 0
+    entries.clear();
+    for (IlcInt j = 0; j < nbU; j++) {
+        if (cannotLinks.isMarked(setU[j]))
+            entries.push_back(WeightedContribution(IlcInfinity, _weights[setU[j]]));
+        else
+            entries.push_back(WeightedContribution(dissimilarities[i][setU[j]] / 2, _weights[setU[j]]));
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    IlcFloat cumulated = 0;
+    for (IlcInt e = 0; e < (IlcInt) entries.size() && (IlcInt) s3.size() < length; e++) {
+        for (IlcInt u = 0; u < entries[e].second && (IlcInt) s3.size() < length; u++) {
+            cumulated += entries[e].first;
+            s3.push_back(cumulated);
+        }
+    }
+
+    assert(s3.empty() || s3[0] == 0);
+}
+
+
+IlcFloat ObservationWeights::sumSmallestUnits(std::vector<WeightedContribution>& candidates, IlcInt m) {
+    std::sort(candidates.begin(), candidates.end());
+
+    IlcFloat S = 0;
+    for (IlcInt e = 0; e < (IlcInt) candidates.size() && m > 0; e++) {
+        IlcInt taken = std::min(m, candidates[e].second); // Part of a point may be taken
+        S += taken*candidates[e].first;
+        m -= taken;
+    }
+
+    return (m > 0) ? IlcInfinity : S;
+}
+
+
+void ObservationWeights::sumSmallestUnits(std::vector<WeightedContribution>& candidates, IlcInt maxUnits, IlcFloat* sums) {
+    std::sort(candidates.begin(), candidates.end());
+
+    sums[0] = 0;
+    IlcInt m = 0;
+    for (IlcInt e = 0; e < (IlcInt) candidates.size() && m < maxUnits; e++)
+        for (IlcInt u = 0; u < candidates[e].second && m < maxUnits; u++, m++)
+            sums[m + 1] = sums[m] + candidates[e].first;
+
+    for (; m < maxUnits; m++)
+        sums[m + 1] = IlcInfinity;
+}
+
+
+void ObservationWeights::sumCandidates(const DomainSnapshot& domains, IlcInt* counts, const IlcInt* vars, IlcInt nbVars) const {
+    if (unit) {
+        domains.countCandidates(counts, vars, nbVars);
+        return;
+    }
+
+    for (IlcInt c = 0; c < domains.getNbValues(); c++)
+        counts[c] = 0;
+
+    for (IlcInt i = 0; i < nbVars; i++) {
+        const DomainWord* words = domains.getWords(vars[i]);
+        for (IlcInt b = 0; b < domains.getNbWordsPerVar(); b++) {
+            DomainWord w = words[b];
+            while (w != 0) {
+                counts[(b << 6) + domainWordLowestBit(w)] += _weights[vars[i]];
+                w &= w - 1;
+            }
+        }
+    }
+}
+
+
+IlcInt ObservationWeights::removeOversized(IlcIntVarArray X, DomainSnapshot& domains, IlcIntArray remaining, const IlcInt* vars, IlcInt nbVars) {
+    const IlcInt k = domains.getNbValues();
+    mask.resize(domains.getNbWordsPerVar());
+
+    IlcInt nbNewlyFixed = 0;
+    IlcInt maskWeight = -1; // Weight for which mask was last built, points of equal weight share it
+
+    for (IlcInt i = 0; i < nbVars; i++) {
+        const IlcInt w = _weights[vars[i]];
+
+        if (w != maskWeight) {
+            std::fill(mask.begin(), mask.end(), 0);
+            for (IlcInt c = 0; c < k; c++)
+                if (remaining[c] < w)
+                    mask[c >> 6] |= ((DomainWord) 1) << (c & 63);
+            maskWeight = w;
+        }
+
+        IlcInt nbFixed = domains.removeValues(X, mask.data(), &vars[i], 1);
+        if (nbFixed < 0)
+            return -1;
+
+        nbNewlyFixed += nbFixed;
+    }
+
+    return nbNewlyFixed;
+}
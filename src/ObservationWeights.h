@@ -0,0 +1,82 @@
+/*
+ * Observation weights (see Data::weights), for use inside the WCSS constraints.
+ * A point of weight w is handled as w unit observations at the same location (unit expansion):
+ *     * cluster sizes, target cardinalities and numbers of points to add are counted in units,
+ *     * s2 contributions are per unit, a point contributes w times its s2,
+ *     * s3 contributions are cumulated over units, the w - 1 other units of a point being at distance 0 from it, and
+ *     * the cheapest m units to add to a cluster may take part of a point (fractional selection).
+ *     Bounds computed on the unit expansion are valid for the weighted problem, where all units of a point share a cluster.
+ *
+ * When Data::weights is NULL, every point has weight 1 and the constraints behave exactly as before weights were introduced.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __OBSERVATION_WEIGHTS_H
+#define __OBSERVATION_WEIGHTS_H
+
+#include <utility>
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// Cannot-link constraints
+#include "CannotLinkGraph.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+typedef std::pair<IlcFloat, IlcInt> WeightedContribution; // (per unit contribution, nb of units)
+
+
+class ObservationWeights {
+protected:
+    std::vector<IlcInt> _weights;
+    IlcInt total;
+    bool unit; // All weights are 1
+
+    std::vector<WeightedContribution> entries; // Working buffer of fillHalfContributions
+    std::vector<DomainWord> mask; // Working buffer of removeOversized
+
+public:
+    ObservationWeights() : total(0), unit(true) {}
+
+    // Weights of the n observations of data
+    void build(const Data& data, IlcInt n);
+
+    bool isUnit() const { return unit; }
+    IlcInt getTotal() const { return total; }
+    IlcInt operator[](IlcInt i) const { return _weights[i]; }
+    const IlcInt* getWeights() const { return _weights.data(); }
+
+    // Total weight of points[0..nbPoints-1]
+    IlcInt sum(const IlcInt* points, IlcInt nbPoints) const;
+
+    // s3 of point i among free points setU[0..nbU-1]: s3[m] = smallest sum of the 1/2 dissimilarities between one unit of i
+    //     and m other free units. Cannot-linked points (marked in cannotLinks by the caller) come last, at infinity.
+    //     Only s3[0..length-1] are cumulated.
+    void fillHalfContributions(IlcInt i, const IlcInt* setU, IlcInt nbU, double const* const* dissimilarities,
+                               const CannotLinkGraph& cannotLinks, IlcInt length, std::vector<IlcFloat>& s3);
+
+    // Smallest sum of the contributions of m units, each candidate offering its number of units at its per unit contribution.
+    //     Candidates are sorted in place. Returns IlcInfinity if fewer than m units are offered.
+    static IlcFloat sumSmallestUnits(std::vector<WeightedContribution>& candidates, IlcInt m);
+
+    // Prefix version: sums[m] = sumSmallestUnits(candidates, m) for m = 0..maxUnits, in one sort
+    static void sumSmallestUnits(std::vector<WeightedContribution>& candidates, IlcInt maxUnits, IlcFloat* sums);
+
+    // counts[c] = total weight of the points among vars[0..nbVars-1] with c in their domain
+    void sumCandidates(const DomainSnapshot& domains, IlcInt* counts, const IlcInt* vars, IlcInt nbVars) const;
+
+    // Remove from each point among vars[0..nbVars-1] the clusters which can't house it anymore (remaining[c] < its weight),
+    //     both in snapshot and engine. Same return value as DomainSnapshot::removeValues.
+    IlcInt removeOversized(IlcIntVarArray X, DomainSnapshot& domains, IlcIntArray remaining, const IlcInt* vars, IlcInt nbVars);
+};
+
+#endif // !__OBSERVATION_WEIGHTS_H
@@ -0,0 +1,284 @@
+/*
+ * Exact resolution of one-dimensional instances.
+ * Refer to OneDimensionalSolver.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+#include "OneDimensionalSolver.h"
+
+
+// Weight of observation i, see Data::weights
+static inline int getWeight(const Data& data, int i) {
+    return (data.weights != NULL) ? data.weights[i] : 1;
+}
+
+
+// Position of observation i on the line
+static inline double getValue(const Data& data, const double* values, int i) {
+    return (values != NULL) ? values[i] : data.coordinates[i][0];
+}
+
+
+// Distinct targets (ascending) and their multiplicities
+static void groupTargets(const Data& data, std::vector<int>& sizes, std::vector<int>& multiplicities) {
+    std::vector<int> targets(data.targetCardinalities, data.targetCardinalities + data.K);
+    std::sort(targets.begin(), targets.end());
+
+    sizes.clear();
+    multiplicities.clear();
+    for (int c = 0; c < data.K; c++) {
+        if (sizes.empty() || sizes.back() != targets[c]) {
+            sizes.push_back(targets[c]);
+            multiplicities.push_back(0);
+        }
+        multiplicities.back()++;
+    }
+}
+
+
+bool isOneDimensionalSolvable(const Data& data, const double* values, bool cardinalitiesKnown) {
+    if (values == NULL && (data.S != 1 || data.coordinates == NULL))
+        return false;
+
+    if (data.nbCannotLinks > 0 || data.nbMustLinks > 0)
+        return false;
+
+    if (!cardinalitiesKnown)
+        return true;
+
+    if (data.targetCardinalities == NULL || data.weights != NULL)
+        return false;
+
+    std::vector<int> sizes, multiplicities;
+    groupTargets(data, sizes, multiplicities);
+
+    long nbStates = 1;
+    for (size_t v = 0; v < sizes.size(); v++) {
+        nbStates *= multiplicities[v] + 1;
+        if (nbStates > __MAX_1D_TARGET_STATES)
+            return false;
+    }
+
+    return true;
+}
+
+
+// Prefix sums over sorted observations, centered on the mean to limit cancellation: segment [i, j) has weight
+//     W[j] - W[i], linear sum M1[j] - M1[i] and quadratic sum M2[j] - M2[i]
+struct PrefixSums {
+    std::vector<double> W, M1, M2;
+
+    PrefixSums(const Data& data, const double* values, const std::vector<int>& order) :
+    W(data.N + 1, 0.0), M1(data.N + 1, 0.0), M2(data.N + 1, 0.0) {
+        double mean = 0, total = 0;
+        for (int i = 0; i < data.N; i++) {
+            mean += getWeight(data, i)*getValue(data, values, i);
+            total += getWeight(data, i);
+        }
+        mean /= total;
+
+        for (int r = 0; r < data.N; r++) {
+            const int i = order[r];
+            const double x = getValue(data, values, i) - mean;
+            W[r + 1] = W[r] + getWeight(data, i);
+            M1[r + 1] = M1[r] + getWeight(data, i)*x;
+            M2[r + 1] = M2[r] + getWeight(data, i)*x*x;
+        }
+    }
+
+    // Sum of squares of segment [i, j) around its centroid
+    double cost(int i, int j) const {
+        const double m1 = M1[j] - M1[i];
+        return (M2[j] - M2[i]) - m1*m1 / (W[j] - W[i]);
+    }
+};
+
+
+// Free cardinalities: lastCut[k*(N+1) + j] = start of cluster k when clusters 0..k cover the first j sorted points
+static bool solveFree(const Data& data, const PrefixSums& sums, std::vector<int>& segmentStarts) {
+    const int N = data.N, K = data.K;
+    if (N < K)
+        return false;
+
+    std::vector<double> previous(N + 1), current(N + 1), candidates(N + 1);
+    std::vector<int> lastCut(K*(size_t) (N + 1), 0);
+
+    for (int j = 1; j <= N - K + 1; j++)
+        previous[j] = sums.cost(0, j);
+
+    for (int k = 1; k < K; k++) {
+        for (int j = k + 1; j <= N - K + k + 1; j++) {
+            // Branch-free so the compiler can vectorize it
+            const double m1 = sums.M1[j], m2 = sums.M2[j], w = sums.W[j];
+            for (int i = k; i < j; i++)
+                candidates[i] = previous[i] + (m2 - sums.M2[i]) - (m1 - sums.M1[i])*(m1 - sums.M1[i]) / (w - sums.W[i]);
+
+            int best = k;
+            for (int i = k + 1; i < j; i++)
+                if (candidates[i] < candidates[best])
+                    best = i;
+
+            current[j] = candidates[best];
+            lastCut[k*(size_t) (N + 1) + j] = best;
+        }
+
+        previous.swap(current);
+    }
+
+    segmentStarts.resize(K);
+    int j = N;
+    for (int k = K - 1; k >= 0; k--) {
+        segmentStarts[k] = lastCut[k*(size_t) (N + 1) + j];
+        j = segmentStarts[k];
+    }
+    assert(j == 0);
+
+    return true;
+}
+
+
+// Target cardinalities: a state counts, for each distinct target v, the used[v] segments of that length already placed
+//     from the left, encoded in mixed radix (multiplicity + 1). Its segments cover the first sum of used[v]*sizes[v] points.
+static bool solveTargets(const Data& data, const PrefixSums& sums, std::vector<int>& segmentLengths) {
+    std::vector<int> sizes, multiplicities;
+    groupTargets(data, sizes, multiplicities);
+    const int nbSizes = (int) sizes.size();
+
+    long covered = 0;
+    for (int v = 0; v < nbSizes; v++)
+        covered += (long) multiplicities[v]*sizes[v];
+    if (covered != data.N)
+        return false;
+
+    std::vector<long> strides(nbSizes);
+    long nbStates = 1;
+    for (int v = 0; v < nbSizes; v++) {
+        strides[v] = nbStates;
+        nbStates *= multiplicities[v] + 1;
+    }
+
+    std::vector<double> best(nbStates, 0.0);
+    std::vector<int> lastSize(nbStates, -1);
+    std::vector<int> used(nbSizes, 0);
+    int position = 0;
+
+    for (long s = 1; s < nbStates; s++) {
+        // Next state in mixed radix, position follows
+        for (int v = 0; v < nbSizes; v++) {
+            if (used[v] < multiplicities[v]) {
+                used[v]++;
+                position += sizes[v];
+                break;
+            }
+            position -= used[v]*sizes[v];
+            used[v] = 0;
+        }
+
+        best[s] = std::numeric_limits<double>::infinity();
+        for (int v = 0; v < nbSizes; v++) {
+            if (used[v] == 0)
+                continue;
+
+            const double candidate = best[s - strides[v]] + sums.cost(position - sizes[v], position);
+            if (candidate < best[s]) {
+                best[s] = candidate;
+                lastSize[s] = v;
+            }
+        }
+    }
+
+    segmentLengths.clear();
+    for (long s = nbStates - 1; s > 0; s -= strides[lastSize[s]])
+        segmentLengths.push_back(sizes[lastSize[s]]);
+    std::reverse(segmentLengths.begin(), segmentLengths.end());
+
+    return true;
+}
+
+
+double solveOneDimensional(const Data& data, const double* values, bool cardinalitiesKnown, int* memberships) {
+    assert(isOneDimensionalSolvable(data, values, cardinalitiesKnown));
+
+    const int N = data.N, K = data.K;
+
+    std::vector<int> order(N);
+    for (int i = 0; i < N; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return getValue(data, values, a) < getValue(data, values, b); });
+
+    PrefixSums sums(data, values, order);
+
+    // Labels of sorted points
+    std::vector<int> sortedLabels(N);
+    if (!cardinalitiesKnown) {
+        std::vector<int> segmentStarts;
+        if (!solveFree(data, sums, segmentStarts))
+            return -1;
+
+        for (int k = 0; k < K; k++) {
+            const int end = (k + 1 < K) ? segmentStarts[k + 1] : N;
+            for (int r = segmentStarts[k]; r < end; r++)
+                sortedLabels[r] = k;
+        }
+    }
+    else {
+        std::vector<int> segmentLengths;
+        if (!solveTargets(data, sums, segmentLengths))
+            return -1;
+
+        // Each segment takes a cluster whose target is its length
+        std::vector<bool> taken(K, false);
+        int start = 0;
+        for (int length : segmentLengths) {
+            int c = 0;
+            while (taken[c] || data.targetCardinalities[c] != length)
+                c++;
+            taken[c] = true;
+
+            for (int r = start; r < start + length; r++)
+                sortedLabels[r] = c;
+            start += length;
+        }
+    }
+
+    for (int r = 0; r < N; r++)
+        memberships[order[r]] = sortedLabels[r];
+
+    // Without targets, clusters are interchangeable: number them in order of first observation, as value precedence would
+    if (!cardinalitiesKnown) {
+        std::vector<int> relabel(K, -1);
+        int nbLabels = 0;
+        for (int i = 0; i < N; i++) {
+            if (relabel[memberships[i]] == -1)
+                relabel[memberships[i]] = nbLabels++;
+            memberships[i] = relabel[memberships[i]];
+        }
+    }
+
+    // WCSS recomputed segment by segment around each centroid, more accurate than prefix sums
+    double wcss = 0;
+    for (int r = 0; r < N;) {
+        int end = r;
+        double weight = 0, mean = 0;
+        while (end < N && sortedLabels[end] == sortedLabels[r]) {
+            weight += getWeight(data, order[end]);
+            mean += getWeight(data, order[end])*getValue(data, values, order[end]);
+            end++;
+        }
+        mean /= weight;
+
+        for (; r < end; r++) {
+            const double d = getValue(data, values, order[r]) - mean;
+            wcss += getWeight(data, order[r])*d*d;
+        }
+    }
+
+    return wcss;
+}
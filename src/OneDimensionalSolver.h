@@ -0,0 +1,44 @@
+/*
+ * Exact resolution of one-dimensional instances (S = 1, or observations given through a 1-D projection) without search.
+ *
+ * On a line, some optimal clustering is made of contiguous segments of the sorted observations: if a < b with a in the
+ *     cluster of larger centroid and b in the other one, exchanging them strictly decreases the WCSS (cardinalities are
+ *     unchanged). The problem then reduces to placing K-1 cuts, and the WCSS of a segment is obtained in O(1) from
+ *     prefix sums.
+ * * Without target cardinalities (general MSSC): dynamic programming over (cluster, last point of the cluster), in
+ *       O(N^2*K) time and O(N*K) space, as in Wang H., Song M. (2011) Ckmeans.1d.dp: Optimal k-means Clustering in One
+ *       Dimension by Dynamic Programming. The R Journal 3(2). Weights (see Data::weights) are supported.
+ * * With target cardinalities: segment lengths are the targets, only their order along the line is to be found.
+ *       Dynamic programming over the sub-multisets of targets already placed, whose number is the product of
+ *       (multiplicity + 1) over distinct targets (K+1 when balanced, 2^K when all targets differ).
+ *       The exchange argument needs identical observations, so weighted instances are not supported in this case.
+ * Cannot-links break contiguity and are not supported. Must-links are supported through the contraction
+ *     (MustLinkContraction.h), whose super-points are weighted, hence without target cardinalities only.
+ *
+ * The result is only exact if dissimilarities are the squared differences of the given values.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __ONE_DIMENSIONAL_SOLVER_H
+#define __ONE_DIMENSIONAL_SOLVER_H
+
+// Problem data structure
+#include "Data.h"
+
+
+// Above this number of sub-multisets of targets, the instance is left to the CP search
+#define __MAX_1D_TARGET_STATES 16777216
+
+
+// values (N-element) gives the position of each observation on the line. If NULL, the coordinates are used, provided S = 1.
+
+// Whether solveOneDimensional applies to data, with (cardinalitiesKnown) or without target cardinalities
+bool isOneDimensionalSolvable(const Data& data, const double* values, bool cardinalitiesKnown);
+
+// Optimal memberships (N-element, filled) and returns their WCSS, or a negative value if no clustering into K non-empty
+//     clusters (of target cardinalities, if cardinalitiesKnown) exists. data must satisfy isOneDimensionalSolvable.
+double solveOneDimensional(const Data& data, const double* values, bool cardinalitiesKnown, int* memberships);
+
+#endif // !__ONE_DIMENSIONAL_SOLVER_H
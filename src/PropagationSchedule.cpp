@@ -0,0 +1,104 @@
+/*
+ * Adaptive scheduling of the cost-based filtering of the WCSS constraints.
+ * Refer to PropagationSchedule.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+
+#include "PropagationSchedule.h"
+
+
+// Weight of the past in the yield averages, about the last 1 / (1 - __YIELD_DECAY) runs count
+#define __YIELD_DECAY 0.9
+
+
+void PropagationSchedule::build(const PropagationParameters* parameters, IlcInt n) {
+    if (parameters != NULL)
+        _parameters = *parameters;
+    _n = n;
+
+    _parameters.nbDepthBuckets = std::max((IlcInt) 1, _parameters.nbDepthBuckets);
+
+    Context empty = {0, 0, 0, 0};
+    contexts.assign(2*_parameters.nbDepthBuckets, empty);
+}
+
+
+bool PropagationSchedule::shouldFilter(IlcInt p, IlcFloat lb, IlcFloat ub) {
+    // The previous filtering run wasn't recorded: it ended in a failure, as productive as a removal
+    if (pending >= 0)
+        record(1);
+
+    // Trigger is not reversible: it compares with the previous propagation, wherever it was in the tree
+    const bool upperBoundWentDown = (ub < lastUpperBound);
+    lastUpperBound = ub;
+
+    if (!_parameters.adaptive) {
+        nbFiltered++;
+        return true;
+    }
+
+    const IlcInt bucket = std::min(_parameters.nbDepthBuckets - 1, (p*_parameters.nbDepthBuckets) / std::max((IlcInt) 1, _n));
+    const IlcInt c = 2*bucket + (upperBoundWentDown ? 1 : 0);
+    Context& context = contexts[c];
+
+    const bool confirmed = upperBoundWentDown
+                           || context.nbMeasured < _parameters.warmupRuns
+                           || context.nbRemovals >= _parameters.minYield*context.nbRuns
+                           || (ub - lb) <= _parameters.confirmationGap*ub
+                           || context.nbSkipped >= _parameters.probePeriod;
+
+    if (!confirmed) {
+        context.nbSkipped++;
+        nbSkippedTotal++;
+        pending = -1;
+        return false;
+    }
+
+    context.nbSkipped = 0;
+    nbFiltered++;
+    pending = c;
+    return true;
+}
+
+
+void PropagationSchedule::record(IlcInt nbRemovals) {
+    if (pending < 0)
+        return;
+
+    Context& context = contexts[pending];
+    context.nbRuns = __YIELD_DECAY*context.nbRuns + 1;
+    context.nbRemovals = __YIELD_DECAY*context.nbRemovals + nbRemovals;
+    context.nbMeasured++;
+
+    pending = -1;
+}
+
+
+bool PropagationSchedule::shouldShave(IlcInt p, IlcFloat lb, IlcFloat ub) {
+    if (_parameters.shavingPeriod <= 0 || ub == IlcInfinity)
+        return false;
+
+    if ((p % _parameters.shavingPeriod) != 0 && (ub - lb) > _parameters.shavingGap*ub)
+        return false;
+
+    // Unproductive so far: shave once in a while only, so that the yield keeps being measured
+    if (shavingRefuted < _parameters.shavingMinYield*shavingProbes && shavingSkipped < _parameters.probePeriod) {
+        shavingSkipped++;
+        return false;
+    }
+
+    shavingSkipped = 0;
+    nbShaved++;
+    return true;
+}
+
+
+void PropagationSchedule::recordShaving(IlcInt nbProbes, IlcInt nbRefuted) {
+    shavingProbes = __YIELD_DECAY*shavingProbes + nbProbes;
+    shavingRefuted = __YIELD_DECAY*shavingRefuted + nbRefuted;
+    nbShavingRemovals += nbRefuted;
+}
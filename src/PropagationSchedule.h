@@ -0,0 +1,148 @@
+/*
+ * Adaptive scheduling of the cost-based filtering of the WCSS constraints (the V_prime loop of IlcWCSS and
+ *     IlcWCSS_StandardCardControl, the getDeltaObj loop of IlcWCSS_NetworkCardControl, the reduced-cost loop of
+ *     IlcWCSS_LagrangianCardControl).
+ * The lower bound on V is always computed and applied, so skipping filtering never loses a solution nor weakens the
+ *     pruning of the node itself: it only leaves values that the next full filtering (or a failure further down) removes.
+ *
+ * Pruning yield (values removed per filtering run) is tracked per context, ie per depth (share of points fixed, in
+ *     nbDepthBuckets buckets) and per trigger (the upper bound on V went down since the previous propagation, or only
+ *     domains of X changed), as an exponentially decaying average. In a context whose yield is below minYield, filtering
+ *     is delayed until a confirmation point:
+ *     * the upper bound went down (a new incumbent, which is when filtering removes most),
+ *     * the lower bound is within confirmationGap (relative) of the upper bound, or
+ *     * probePeriod propagations were skipped in a row in this context, so that its yield keeps being measured.
+ * A context filters at every propagation until it has been measured warmupRuns times.
+ *
+ * Shaving (IlcWCSS_StandardCardControl only): V_prime is an optimistic one-point relaxation, which keeps values that a
+ *     tentative assignment would refute. After a filtering run, at nodes whose number of fixed points is a multiple of
+ *     shavingPeriod or whose gap is within shavingGap, the values kept with the largest V_prime are tentatively assigned
+ *     one by one and the full bound of the constraint recomputed, until shavingBudget seconds are spent. Refuted values
+ *     are removed. If the share of probes that refute (decaying average) falls below shavingMinYield, only one selected
+ *     node in probePeriod is shaved.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __PROPAGATION_SCHEDULE_H
+#define __PROPAGATION_SCHEDULE_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+// Objective value of the best solution found so far, fed by the code driving the search (eg. MSSCSolver::nextSolution) and
+//     read by the constraints at each propagation. Unlike the upper bound of V at a node, which the model ties to the WCSS of
+//     the partial assignment, it holds in the whole tree. It only goes down until reset. Thread-safe.
+class IncumbentValue {
+protected:
+    std::atomic<double> value;
+
+public:
+    IncumbentValue() : value(IlcInfinity) {}
+
+    void update(double objective) {
+        double current = value.load(std::memory_order_relaxed);
+        while (objective < current && !value.compare_exchange_weak(current, objective, std::memory_order_relaxed));
+    }
+    void reset() { value.store(IlcInfinity, std::memory_order_relaxed); }
+
+    double get() const { return value.load(std::memory_order_relaxed); } // IlcInfinity if no solution yet
+};
+
+
+struct PropagationParameters {
+    bool adaptive; // false: filter at every propagation (original behavior)
+
+    double minYield; // Values removed per run below which filtering is delayed
+    double confirmationGap;
+    IlcInt probePeriod;
+    IlcInt warmupRuns;
+    IlcInt nbDepthBuckets;
+
+    IlcInt shavingPeriod; // 0: no shaving (original behavior)
+    double shavingGap;
+    double shavingBudget; // Seconds per node
+    double shavingMinYield; // Refuted per probe
+
+    bool centroidBound; // false: no coordinate-space bound (original behavior), see CentroidBound.h
+    IlcInt nogoodCapacity; // 0: no nogood learning (original behavior), see NogoodStore.h
+    IlcInt transpositionBytes; // 0: no transposition table (original behavior), see TranspositionTable.h
+
+    double relativeGap; // 0: prune against the upper bound of V (original behavior), see getPruningBound
+    const IncumbentValue* incumbent; // Optional (NULL by default, relativeGap is then ignored), must outlive the search
+
+    PropagationParameters() : adaptive(false), minYield(0.1), confirmationGap(0.01), probePeriod(16), warmupRuns(8), nbDepthBuckets(8),
+    shavingPeriod(0), shavingGap(0.01), shavingBudget(1e-3), shavingMinYield(0.05), centroidBound(false), nogoodCapacity(0), transpositionBytes(0), relativeGap(0),
+    incumbent(NULL) {}
+};
+
+
+class PropagationSchedule {
+protected:
+    PropagationParameters _parameters;
+    IlcInt _n;
+
+    struct Context {
+        double nbRuns, nbRemovals; // Decaying sums
+        IlcInt nbSkipped; // In a row
+        IlcInt nbMeasured;
+    };
+    std::vector<Context> contexts; // contexts[2*bucket + trigger], trigger 1 if the upper bound went down
+
+    IlcFloat lastUpperBound;
+    IlcInt pending; // Context of the filtering run allowed by the last shouldFilter, -1 if none
+
+    IlcInt nbFiltered, nbSkippedTotal;
+
+    double shavingProbes, shavingRefuted; // Decaying sums
+    IlcInt shavingSkipped; // Selected nodes not shaved in a row
+    IlcInt nbShaved, nbShavingRemovals;
+
+public:
+    PropagationSchedule() : _n(0), lastUpperBound(IlcInfinity), pending(-1), nbFiltered(0), nbSkippedTotal(0),
+    shavingProbes(0), shavingRefuted(0), shavingSkipped(0), nbShaved(0), nbShavingRemovals(0) {}
+
+    // parameters may be NULL (defaults, not adaptive)
+    void build(const PropagationParameters* parameters, IlcInt n);
+
+    // Called once per propagation, after the lower bound lb is applied to V whose upper bound is ub.
+    //     p is the number of fixed points. Returns whether to run full filtering now.
+    bool shouldFilter(IlcInt p, IlcFloat lb, IlcFloat ub);
+
+    // Bound against which nodes fail and values are filtered, ub being the upper bound of V at the node. The relative gap
+    //     applies to the incumbent (see getIncumbentBound), never to ub: ub is local to the node and, at a leaf, equals its
+    //     WCSS. Pruning what can't improve on the incumbent by the gap leaves the search with an incumbent proven within the
+    //     gap of the optimum.
+    IlcFloat getPruningBound(IlcFloat ub) const { return std::min(ub, getIncumbentBound()); }
+
+    // Incumbent lowered by the relative gap, IlcInfinity if no incumbent is fed (see PropagationParameters::incumbent) or
+    //     none is found yet. Unlike getPruningBound, it holds in the whole tree.
+    IlcFloat getIncumbentBound() const {
+        return (_parameters.incumbent != NULL) ? _parameters.incumbent->get()*(1 - _parameters.relativeGap) : IlcInfinity;
+    }
+
+    // Outcome of the filtering run allowed by shouldFilter
+    void record(IlcInt nbRemovals);
+
+    bool isShavingEnabled() const { return _parameters.shavingPeriod > 0; }
+    double getShavingBudget() const { return _parameters.shavingBudget; }
+
+    // Called after a filtering run, same arguments as shouldFilter. Returns whether to shave now.
+    bool shouldShave(IlcInt p, IlcFloat lb, IlcFloat ub);
+
+    // Outcome of the shaving allowed by shouldShave
+    void recordShaving(IlcInt nbProbes, IlcInt nbRefuted);
+
+    IlcInt getNbFiltered() const { return nbFiltered; }
+    IlcInt getNbSkipped() const { return nbSkippedTotal; }
+    IlcInt getNbShaved() const { return nbShaved; }
+    IlcInt getNbShavingRemovals() const { return nbShavingRemovals; }
+};
+
+#endif // !__PROPAGATION_SCHEDULE_H
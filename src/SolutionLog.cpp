@@ -0,0 +1,187 @@
+/*
+ * Compact binary log of successive solutions (incumbents) of a search.
+ * Refer to SolutionLog.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <cstring>
+
+#include "SolutionLog.h"
+
+
+// Records are padded to this alignment so that doubles in record headers are aligned in a mapped file
+static inline std::size_t padded(std::size_t size) {
+    return (size + 7) & ~((std::size_t) 7);
+}
+
+
+SolutionLogEncoder::SolutionLogEncoder(std::ostream& out, int n, int k, std::uint32_t keyframeInterval) :
+_out(out), _n(n), _keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1), nbRecords(0), nbBytes(0) {
+    _labelWidth = (k <= 256) ? 1 : ((k <= 65536) ? 2 : 4);
+
+    previous.resize(_n);
+    changedIndices.resize(_n);
+    payload.resize(padded(_n*(std::size_t) _labelWidth) + padded(_n*sizeof(std::uint32_t))); // Room for either kind
+
+    SolutionLogHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, __SOLUTION_LOG_MAGIC, sizeof(header.magic)); // 7 characters and terminating null
+    header.byteOrderMark = __SOLUTION_LOG_BOM;
+    header.version = __SOLUTION_LOG_VERSION;
+    header.n = (std::uint32_t) _n;
+    header.k = (std::uint32_t) k;
+    header.labelWidth = _labelWidth;
+    header.keyframeInterval = _keyframeInterval;
+
+    _out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    nbBytes += sizeof(header);
+}
+
+
+void SolutionLogEncoder::writeLabel(char* at, int label) const {
+    switch (_labelWidth) {
+        case 1: { std::uint8_t l = (std::uint8_t) label; std::memcpy(at, &l, 1); } break;
+        case 2: { std::uint16_t l = (std::uint16_t) label; std::memcpy(at, &l, 2); } break;
+        default: { std::uint32_t l = (std::uint32_t) label; std::memcpy(at, &l, 4); } break;
+    }
+}
+
+
+void SolutionLogEncoder::writeRecord(SolutionLogOptions::RecordKind kind, std::uint32_t count, double objective, double time, std::size_t payloadSize) {
+    SolutionLogRecordHeader record;
+    record.kind = kind;
+    record.count = count;
+    record.objective = objective;
+    record.time = time;
+
+    const std::size_t paddedSize = padded(payloadSize);
+    std::memset(payload.data() + payloadSize, 0, paddedSize - payloadSize);
+
+    _out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    _out.write(payload.data(), paddedSize);
+
+    nbRecords++;
+    nbBytes += sizeof(record) + paddedSize;
+}
+
+
+void SolutionLogEncoder::append(const int* memberships, double objective, double time) {
+    // Collect changes against previous solution
+    std::uint32_t nbChanged = 0;
+    if (nbRecords > 0)
+        for (int i = 0; i < _n; i++)
+            if (memberships[i] != previous[i])
+                changedIndices[nbChanged++] = (std::uint32_t) i;
+
+    const std::size_t fullSize = _n*(std::size_t) _labelWidth;
+    const std::size_t deltaSize = nbChanged*(sizeof(std::uint32_t) + _labelWidth);
+
+    if (nbRecords % _keyframeInterval == 0 || padded(deltaSize) >= padded(fullSize)) {
+        for (int i = 0; i < _n; i++)
+            writeLabel(&payload[i*(std::size_t) _labelWidth], memberships[i]);
+
+        writeRecord(SolutionLogOptions::FULL, (std::uint32_t) _n, objective, time, fullSize);
+    }
+    else {
+        std::memcpy(payload.data(), changedIndices.data(), nbChanged*sizeof(std::uint32_t));
+        char* labels = &payload[nbChanged*sizeof(std::uint32_t)];
+        for (std::uint32_t j = 0; j < nbChanged; j++)
+            writeLabel(&labels[j*(std::size_t) _labelWidth], memberships[changedIndices[j]]);
+
+        writeRecord(SolutionLogOptions::DELTA, nbChanged, objective, time, deltaSize);
+    }
+
+    for (int i = 0; i < _n; i++)
+        previous[i] = memberships[i];
+}
+
+
+SolutionLogReader::SolutionLogReader(const void* data, std::size_t size) :
+_data(static_cast<const unsigned char*>(data)), _size(size), header(NULL) {
+    if (_size < sizeof(SolutionLogHeader))
+        return;
+
+    const SolutionLogHeader* candidate = reinterpret_cast<const SolutionLogHeader*>(_data);
+    if (std::strncmp(candidate->magic, __SOLUTION_LOG_MAGIC, sizeof(candidate->magic)) != 0
+        || candidate->byteOrderMark != __SOLUTION_LOG_BOM
+        || candidate->version != __SOLUTION_LOG_VERSION
+        || (candidate->labelWidth != 1 && candidate->labelWidth != 2 && candidate->labelWidth != 4))
+        return;
+
+    header = candidate;
+    memberships.resize(header->n);
+    reset();
+}
+
+
+void SolutionLogReader::reset() {
+    offset = sizeof(SolutionLogHeader);
+    objective = 0;
+    time = 0;
+    index = (std::uint64_t) -1;
+    for (std::size_t i = 0; i < memberships.size(); i++)
+        memberships[i] = 0;
+}
+
+
+int SolutionLogReader::readLabel(const unsigned char* at) const {
+    switch (header->labelWidth) {
+        case 1: { std::uint8_t l; std::memcpy(&l, at, 1); return (int) l; }
+        case 2: { std::uint16_t l; std::memcpy(&l, at, 2); return (int) l; }
+        default: { std::uint32_t l; std::memcpy(&l, at, 4); return (int) l; }
+    }
+}
+
+
+bool SolutionLogReader::next() {
+    if (header == NULL || offset + sizeof(SolutionLogRecordHeader) > _size)
+        return false;
+
+    SolutionLogRecordHeader record;
+    std::memcpy(&record, _data + offset, sizeof(record));
+    const unsigned char* payload = _data + offset + sizeof(record);
+    const std::size_t available = _size - offset - sizeof(record);
+    const std::size_t labelWidth = header->labelWidth;
+
+    std::size_t payloadSize;
+    switch (record.kind) {
+        case SolutionLogOptions::FULL: {
+            payloadSize = header->n*labelWidth;
+            if (record.count != header->n || padded(payloadSize) > available)
+                return false;
+
+            for (std::uint32_t i = 0; i < header->n; i++)
+                memberships[i] = readLabel(payload + i*labelWidth);
+        }
+        break;
+
+        case SolutionLogOptions::DELTA: {
+            payloadSize = record.count*(sizeof(std::uint32_t) + labelWidth);
+            if (record.count > header->n || index == (std::uint64_t) -1 || padded(payloadSize) > available)
+                return false; // A log starts with a FULL record
+
+            const unsigned char* labels = payload + record.count*sizeof(std::uint32_t);
+            for (std::uint32_t j = 0; j < record.count; j++) {
+                std::uint32_t i;
+                std::memcpy(&i, payload + j*sizeof(std::uint32_t), sizeof(i));
+                if (i >= header->n)
+                    return false;
+
+                memberships[i] = readLabel(labels + j*labelWidth);
+            }
+        }
+        break;
+
+        default:
+            return false;
+    }
+
+    objective = record.objective;
+    time = record.time;
+    index++;
+    offset += sizeof(record) + padded(payloadSize);
+
+    return true;
+}
@@ -0,0 +1,128 @@
+/*
+ * Compact binary log of successive solutions (incumbents) of a search, for archiving and later analysis.
+ * The first solution is stored in full, each later one as a delta against the previous one: the indices whose
+ *     label changed and their new labels, along with the objective value and the solve time.
+ *
+ * Layout (host byte order, checked through byteOrderMark; all fields naturally aligned so that a memory-mapped
+ *     file can be read in place):
+ *     * SolutionLogHeader (32 bytes)
+ *     * Records, each made of a SolutionLogRecordHeader (24 bytes) followed by its payload padded to 8 bytes:
+ *           - FULL record : N labels;
+ *           - DELTA record: count indices (uint32), then count labels.
+ *       Labels take labelWidth bytes (1 if K <= 256, 2 if K <= 65536, 4 otherwise).
+ *
+ * A FULL record is written instead of a DELTA one every keyframeInterval records (bounding how many records must be
+ *     replayed from any point) and whenever the delta would be larger than the full record.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __SOLUTION_LOG_H
+#define __SOLUTION_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+
+#define __SOLUTION_LOG_MAGIC "MSSCLOG"
+#define __SOLUTION_LOG_VERSION 1
+#define __SOLUTION_LOG_BOM 0x01020304
+
+
+struct SolutionLogHeader {
+    char magic[8]; // __SOLUTION_LOG_MAGIC, null terminated
+    std::uint32_t byteOrderMark; // __SOLUTION_LOG_BOM as written by the producing host
+    std::uint32_t version;
+    std::uint32_t n; // Number of observations
+    std::uint32_t k; // Number of classes
+    std::uint32_t labelWidth; // Bytes per label
+    std::uint32_t keyframeInterval;
+};
+
+namespace SolutionLogOptions {
+    enum RecordKind : std::uint32_t {
+        FULL = 0,
+        DELTA = 1
+    };
+}
+
+struct SolutionLogRecordHeader {
+    std::uint32_t kind; // SolutionLogOptions::RecordKind
+    std::uint32_t count; // N for FULL, number of changed indices for DELTA
+    double objective;
+    double time;
+};
+
+static_assert(sizeof(SolutionLogHeader) == 32, "SolutionLogHeader layout");
+static_assert(sizeof(SolutionLogRecordHeader) == 24, "SolutionLogRecordHeader layout");
+
+
+class SolutionLogEncoder {
+private:
+    std::ostream& _out;
+    int _n;
+    std::uint32_t _labelWidth;
+    std::uint32_t _keyframeInterval;
+
+    std::vector<int> previous; // Last solution written
+    std::vector<std::uint32_t> changedIndices; // Working buffers, allocated once
+    std::vector<char> payload;
+
+    std::uint64_t nbRecords;
+    std::uint64_t nbBytes;
+
+    void writeLabel(char* at, int label) const;
+    void writeRecord(SolutionLogOptions::RecordKind kind, std::uint32_t count, double objective, double time, std::size_t payloadSize);
+
+public:
+    // Writes the header to out, which must be opened in binary mode
+    SolutionLogEncoder(std::ostream& out, int n, int k, std::uint32_t keyframeInterval = 256);
+
+    void append(const int* memberships, double objective, double time);
+
+    std::uint64_t getNbRecords() const { return nbRecords; }
+    std::uint64_t getNbBytes() const { return nbBytes; }
+};
+
+
+// Sequential reader over a log held in memory (eg. memory-mapped file). Does not copy the buffer, which must outlive the reader.
+class SolutionLogReader {
+private:
+    const unsigned char* _data;
+    std::size_t _size;
+    std::size_t offset; // Of next record
+
+    const SolutionLogHeader* header; // NULL if buffer is not a valid log
+
+    std::vector<int> memberships; // Current solution, after replaying records up to the current one
+    double objective;
+    double time;
+    std::uint64_t index; // Of current record, meaningless before the first call to next
+
+    int readLabel(const unsigned char* at) const;
+
+public:
+    SolutionLogReader(const void* data, std::size_t size);
+
+    // Header present, of a known version and written with the same byte order
+    bool isValid() const { return header != NULL; }
+
+    int getN() const { return (int) header->n; }
+    int getK() const { return (int) header->k; }
+
+    // Advances to the next solution. Returns false at the end of the log, or if it is truncated or corrupted.
+    bool next();
+
+    // Rewinds to the beginning of the log
+    void reset();
+
+    const int* getMemberships() const { return memberships.data(); }
+    double getObjective() const { return objective; }
+    double getTime() const { return time; }
+    std::uint64_t getIndex() const { return index; }
+};
+
+#endif // !__SOLUTION_LOG_H
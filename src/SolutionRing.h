@@ -0,0 +1,146 @@
+/*
+ * Single-producer/single-consumer lock-free ring of solutions, used to hand intermediate solutions from the search
+ *     thread over to an output thread (see SolutionWriter.h) without ever blocking the search.
+ *
+ * All slots are allocated at construction: each holds N memberships, the objective value and the solve time.
+ * The producer (search thread) writes memberships straight into a free slot, eg. from IloCP::getValue, then commits it.
+ *     If the ring is full, the solution goes to a spare slot instead of being waited upon. The spare only keeps the last
+ *     solution that missed the ring, and only while no later one got in: incumbents improve, so that solution is the best
+ *     one. The consumer reads it once the producer is done (see latest), the earlier ones are lost and counted.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __SOLUTION_RING_H
+#define __SOLUTION_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+class SolutionRing {
+private:
+    int _n; // Memberships per slot
+    std::size_t _mask; // Capacity - 1, capacity is a power of 2
+
+    std::vector<int> _memberships; // capacity*n
+    std::vector<double> _objectives;
+    std::vector<double> _times;
+
+    // Monotonic counters, index = counter & _mask. Kept on separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<std::size_t> head; // Next slot to commit, written by producer only
+    alignas(64) std::atomic<std::size_t> tail; // Next slot to consume, written by consumer only
+    alignas(64) std::atomic<std::uint64_t> nbDropped;
+
+    // Spare slot, written by producer only, read by consumer once the producer is done
+    std::vector<int> _latest;
+    double _latestObjective, _latestTime;
+    bool latestPending; // The spare holds the last solution published
+    bool publishingLatest; // The slot returned by the last beginPublish is the spare
+
+public:
+    // capacity is rounded up to a power of 2
+    SolutionRing(int n, std::size_t capacity = 64) : _n(n), head(0), tail(0), nbDropped(0), _latestObjective(0), _latestTime(0),
+    latestPending(false), publishingLatest(false) {
+        std::size_t c = 1;
+        while (c < capacity)
+            c <<= 1;
+        _mask = c - 1;
+
+        _memberships.resize(c*(std::size_t) n);
+        _objectives.resize(c);
+        _times.resize(c);
+        _latest.resize(n);
+    }
+
+    SolutionRing(const SolutionRing&) = delete;
+    SolutionRing& operator=(const SolutionRing&) = delete;
+
+    int getN() const { return _n; }
+    std::size_t getCapacity() const { return _mask + 1; }
+    std::uint64_t getNbDropped() const { return nbDropped.load(std::memory_order_relaxed); }
+
+    /*
+     * Producer side
+     */
+
+    // Returns the N-element membership buffer of a free slot, or of the spare slot if the ring is full
+    int* beginPublish() {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        publishingLatest = (h - tail.load(std::memory_order_acquire) > _mask);
+        if (publishingLatest) {
+            if (latestPending)
+                nbDropped.fetch_add(1, std::memory_order_relaxed); // Overwritten
+            return _latest.data();
+        }
+
+        return &_memberships[(h & _mask)*(std::size_t) _n];
+    }
+
+    // Makes the slot returned by the last beginPublish visible to the consumer
+    void commitPublish(double objective, double time) {
+        if (publishingLatest) {
+            _latestObjective = objective;
+            _latestTime = time;
+            latestPending = true;
+            return;
+        }
+
+        // The spare is older than this solution now
+        if (latestPending) {
+            nbDropped.fetch_add(1, std::memory_order_relaxed);
+            latestPending = false;
+        }
+
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        _objectives[h & _mask] = objective;
+        _times[h & _mask] = time;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Convenience copy, returns false if the solution went to the spare slot
+    bool publish(double objective, double time, const int* memberships) {
+        int* slot = beginPublish();
+        for (int i = 0; i < _n; i++)
+            slot[i] = memberships[i];
+        commitPublish(objective, time);
+
+        return !publishingLatest;
+    }
+
+    /*
+     * Consumer side
+     */
+
+    // Oldest committed solution, returns NULL if the ring is empty. Slot stays valid until pop.
+    const int* front(double& objective, double& time) const {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return NULL;
+
+        objective = _objectives[t & _mask];
+        time = _times[t & _mask];
+        return &_memberships[(t & _mask)*(std::size_t) _n];
+    }
+
+    // Releases the slot returned by front to the producer
+    void pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Solution of the spare slot, to be read after those of the ring, returns NULL if there is none.
+    //     Only once the last publish happened before (eg. the producer signalled it is done).
+    const int* latest(double& objective, double& time) const {
+        if (!latestPending)
+            return NULL;
+
+        objective = _latestObjective;
+        time = _latestTime;
+        return _latest.data();
+    }
+};
+
+#endif // !__SOLUTION_RING_H
@@ -0,0 +1,185 @@
+/*
+ * Independent check of a solution.
+ * Refer to SolutionVerifier.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <cmath>
+
+#include "SolutionVerifier.h"
+
+
+// Neumaier compensated summation of a few terms (across lanes, not performance critical)
+static double neumaierSum(const double* values, int nb) {
+    double sum = 0, compensation = 0;
+    for (int i = 0; i < nb; i++) {
+        double t = sum + values[i];
+        if (std::fabs(sum) >= std::fabs(values[i]))
+            compensation += (sum - t) + values[i];
+        else
+            compensation += (values[i] - t) + sum;
+        sum = t;
+    }
+
+    return sum + compensation;
+}
+
+
+// Kahan step on S independent lanes, branch-free so it vectorizes
+static inline void kahanAdd(double* sum, double* compensation, const double* values, int S) {
+    for (int f = 0; f < S; f++) {
+        double y = values[f] - compensation[f];
+        double t = sum[f] + y;
+        compensation[f] = (t - sum[f]) - y;
+        sum[f] = t;
+    }
+}
+
+
+// Weight of observation i, see Data::weights
+static inline int getWeight(const Data& data, int i) {
+    return (data.weights != NULL) ? data.weights[i] : 1;
+}
+
+
+// Fills clusterSS from centroids, O(N*S)
+static void centroidSS(const Data& data, const int* memberships, const std::vector<int>& cardinalities, std::vector<double>& clusterSS) {
+    const int N = data.N, S = data.S, K = data.K;
+
+    // Centroids, K-by-S lanes
+    std::vector<double> sums(K*S, 0.0), compensations(K*S, 0.0);
+    std::vector<double> squares(S);
+    for (int i = 0; i < N; i++) {
+        const double* x = data.coordinates[i];
+        if (data.weights != NULL) {
+            for (int f = 0; f < S; f++)
+                squares[f] = data.weights[i]*x[f]; // Buffer reused for weighted coordinates
+            x = squares.data();
+        }
+
+        kahanAdd(&sums[memberships[i]*S], &compensations[memberships[i]*S], x, S);
+    }
+
+    std::vector<double> centroids(K*S, 0.0);
+    for (int c = 0; c < K; c++)
+        if (cardinalities[c] > 0)
+            for (int f = 0; f < S; f++)
+                centroids[c*S + f] = sums[c*S + f] / cardinalities[c];
+
+    // Squared deviations, accumulated per (cluster, feature) lane
+    for (int k = 0; k < K*S; k++)
+        sums[k] = compensations[k] = 0;
+
+    for (int i = 0; i < N; i++) {
+        const double* x = data.coordinates[i];
+        const double* mu = &centroids[memberships[i]*S];
+        for (int f = 0; f < S; f++) {
+            double d = x[f] - mu[f];
+            squares[f] = getWeight(data, i)*d*d;
+        }
+
+        kahanAdd(&sums[memberships[i]*S], &compensations[memberships[i]*S], squares.data(), S);
+    }
+
+    for (int c = 0; c < K; c++)
+        clusterSS[c] = neumaierSum(&sums[c*S], S);
+}
+
+
+// Fills clusterSS from dissimilarities, O(N^2), when coordinates are not available
+static void pairwiseSS(const Data& data, const int* memberships, const std::vector<int>& cardinalities, std::vector<double>& clusterSS) {
+    std::vector<double> sums(data.K, 0.0), compensations(data.K, 0.0);
+
+    for (int i = 0; i < data.N - 1; i++) {
+        const int c = memberships[i];
+        for (int j = i + 1; j < data.N; j++) {
+            if (memberships[j] != c)
+                continue;
+
+            double y = getWeight(data, i)*getWeight(data, j)*data.dissimilarities[i][j] - compensations[c];
+            double t = sums[c] + y;
+            compensations[c] = (t - sums[c]) - y;
+            sums[c] = t;
+        }
+    }
+
+    for (int c = 0; c < data.K; c++)
+        clusterSS[c] = (cardinalities[c] > 0) ? (sums[c] / cardinalities[c]) : 0;
+}
+
+
+static bool fillCardinalities(const Data& data, const int* memberships, std::vector<int>& cardinalities) {
+    cardinalities.assign(data.K, 0);
+
+    for (int i = 0; i < data.N; i++) {
+        if (memberships[i] < 0 || memberships[i] >= data.K)
+            return false;
+        cardinalities[memberships[i]] += getWeight(data, i);
+    }
+
+    return true;
+}
+
+
+static double totalSS(const Data& data, const int* memberships, const std::vector<int>& cardinalities, std::vector<double>& clusterSS) {
+    clusterSS.assign(data.K, 0.0);
+
+    if (data.coordinates != NULL)
+        centroidSS(data, memberships, cardinalities, clusterSS);
+    else
+        pairwiseSS(data, memberships, cardinalities, clusterSS);
+
+    return neumaierSum(clusterSS.data(), data.K);
+}
+
+
+double computeWCSS(const Data& data, const int* memberships) {
+    std::vector<int> cardinalities;
+    std::vector<double> clusterSS;
+
+    fillCardinalities(data, memberships, cardinalities);
+    return totalSS(data, memberships, cardinalities, clusterSS);
+}
+
+
+VerificationReport verifySolution(const Data& data, const int* memberships, double reportedV, double relativeTolerance) {
+    VerificationReport report;
+    report.cardinalitiesMatch = false;
+    report.mustLinksRespected = false;
+    report.cannotLinksRespected = false;
+    report.objectiveMatches = false;
+    report.wcss = 0;
+    report.absoluteError = 0;
+
+    report.labelsInRange = fillCardinalities(data, memberships, report.cardinalities);
+    if (!report.labelsInRange)
+        return report;
+
+    report.cardinalitiesMatch = true;
+    if (data.targetCardinalities != NULL)
+        for (int c = 0; c < data.K; c++)
+            if (report.cardinalities[c] != data.targetCardinalities[c])
+                report.cardinalitiesMatch = false;
+
+    report.mustLinksRespected = true;
+    for (int l = 0; l < data.nbMustLinks; l++)
+        if (memberships[data.mustLinks[2*l]] != memberships[data.mustLinks[2*l + 1]])
+            report.mustLinksRespected = false;
+
+    report.cannotLinksRespected = true;
+    for (int l = 0; l < data.nbCannotLinks; l++)
+        if (memberships[data.cannotLinks[2*l]] == memberships[data.cannotLinks[2*l + 1]])
+            report.cannotLinksRespected = false;
+
+    report.wcss = totalSS(data, memberships, report.cardinalities, report.clusterSS);
+
+    report.objectiveMatches = true;
+    if (reportedV >= 0) {
+        report.absoluteError = std::fabs(reportedV - report.wcss);
+        report.objectiveMatches = (report.absoluteError <= relativeTolerance * std::fmax(1.0, report.wcss));
+    }
+
+    return report;
+}
@@ -0,0 +1,50 @@
+/*
+ * Independent check of a solution: labels in 0..K-1, cluster cardinalities against Data::targetCardinalities, must-link and
+ *     cannot-link pairs, and recomputation of the WCSS to compare with the objective value V reported by the solver.
+ *
+ * The WCSS is computed from centroids, sum over clusters of sum over members of ||x_i - mu_c||^2, in O(N*S) time instead
+ *     of the O(N^2) sum of pairwise dissimilarities divided by cardinalities (both are equal for squared euclidean distances).
+ *     Sums are compensated (Kahan per feature lane, which the compiler can vectorize since lanes are independent, then
+ *     Neumaier across lanes) so that the result does not drift with N.
+ *     NOTE: do not compile this file with -ffast-math (or equivalent), which would optimize compensation away.
+ * If Data::coordinates is NULL, the WCSS is computed from dissimilarities in O(N^2) instead.
+ * With Data::weights, cardinalities and the WCSS are counted in units (an observation of weight w counts w times).
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __SOLUTION_VERIFIER_H
+#define __SOLUTION_VERIFIER_H
+
+#include <vector>
+
+// Problem data structure
+#include "Data.h"
+
+
+struct VerificationReport {
+    bool labelsInRange; // All memberships in 0..K-1. If false, nothing else is computed.
+    bool cardinalitiesMatch; // Cardinalities equal Data::targetCardinalities (true if targetCardinalities is NULL)
+    bool mustLinksRespected; // Both observations of every must-link share a class (true if there is none)
+    bool cannotLinksRespected; // Both observations of every cannot-link are in different classes (true if there is none)
+    bool objectiveMatches; // Reported V agrees with wcss within tolerance (true if no V was given)
+
+    double wcss; // Recomputed total WCSS
+    double absoluteError; // |reported V - wcss|, 0 if no V was given
+
+    std::vector<int> cardinalities; // K-element, in units if weighted
+    std::vector<double> clusterSS; // K-element, sum of squares of each cluster
+
+    bool isValid() const { return labelsInRange && cardinalitiesMatch && mustLinksRespected && cannotLinksRespected && objectiveMatches; }
+};
+
+
+// Total WCSS of memberships (N-element, labels assumed in 0..K-1)
+double computeWCSS(const Data& data, const int* memberships);
+
+// Full check. reportedV < 0 means no objective value to compare with. A reported V matches if
+//     |reportedV - wcss| <= relativeTolerance * max(1, wcss).
+VerificationReport verifySolution(const Data& data, const int* memberships, double reportedV = -1, double relativeTolerance = 1e-6);
+
+#endif // !__SOLUTION_VERIFIER_H
@@ -0,0 +1,123 @@
+/*
+ * Background thread writing the solutions published in a SolutionRing to an output stream.
+ * Refer to SolutionWriter.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <chrono>
+
+#include "SolutionWriter.h"
+
+
+SolutionWriter::SolutionWriter(SolutionRing& ring, std::ostream& out, SolutionOutputOptions::Format format, int k) :
+_ring(ring), _out(out), _format(format), _k(k), stopRequested(false), nbWritten(0) {
+    cardinalities.resize(_k);
+    if (_format == SolutionOutputOptions::Format::DELTA_LOG)
+        encoder.reset(new SolutionLogEncoder(_out, _ring.getN(), _k)); // Writes log header, before the thread starts
+
+    thread = std::thread(&SolutionWriter::writerLoop, this);
+}
+
+
+SolutionWriter::~SolutionWriter() {
+    stop();
+}
+
+
+void SolutionWriter::stop() {
+    if (!thread.joinable())
+        return;
+
+    stopRequested.store(true, std::memory_order_release);
+    thread.join();
+}
+
+
+void SolutionWriter::writerLoop() {
+    int idleRounds = 0;
+
+    for (;;) {
+        // Read the flag before draining, so that solutions committed before stop are all written
+        const bool stopping = stopRequested.load(std::memory_order_acquire);
+
+        double objective, time;
+        const int* memberships;
+        bool wrote = false;
+        while ((memberships = _ring.front(objective, time)) != NULL) {
+            write(memberships, objective, time);
+            _ring.pop();
+            wrote = true;
+        }
+
+        if (stopping) {
+            // The last solution, if it didn't fit in the ring
+            if ((memberships = _ring.latest(objective, time)) != NULL)
+                write(memberships, objective, time);
+            break;
+        }
+
+        // Back off while idle, the producer is never made to wait nor to notify
+        if (wrote) {
+            _out.flush();
+            idleRounds = 0;
+        }
+        else if (idleRounds < 64) {
+            idleRounds++;
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    _out.flush();
+}
+
+
+void SolutionWriter::write(const int* memberships, double objective, double time) {
+    const int n = _ring.getN();
+
+    switch (_format) {
+        case SolutionOutputOptions::Format::TEXT: {
+            _out << std::endl << std::endl << "Solution #" << nbWritten << std::endl;
+            _out << "  V = " << objective << std::endl;
+
+            _out << "  Corresponding memberships: " << std::endl << "  ";
+            for (int c = 0; c < _k; c++)
+                cardinalities[c] = 0;
+            for (int i = 0; i < n; i++) {
+                cardinalities[memberships[i]]++;
+
+                _out << memberships[i] << " ";
+                if ((i + 1) % 24 == 0)
+                    _out << "..." << std::endl << "  ";
+            }
+            _out << std::endl;
+
+            _out << "  Cluster cardinalities: " << std::endl << "  ";
+            for (int c = 0; c < _k; c++)
+                _out << cardinalities[c] << " ";
+            _out << std::endl;
+
+            _out << "  Cumulative solve duration: " << time << std::endl;
+        }
+        break;
+
+        case SolutionOutputOptions::Format::BINARY: {
+            static_assert(sizeof(int) == sizeof(std::int32_t), "BINARY format stores memberships as int32");
+
+            _out.write(reinterpret_cast<const char*>(&objective), sizeof(double));
+            _out.write(reinterpret_cast<const char*>(&time), sizeof(double));
+            _out.write(reinterpret_cast<const char*>(memberships), n*sizeof(int));
+        }
+        break;
+
+        case SolutionOutputOptions::Format::DELTA_LOG:
+            encoder->append(memberships, objective, time);
+            break;
+    }
+
+    nbWritten++;
+}
@@ -0,0 +1,72 @@
+/*
+ * Background thread writing the solutions published in a SolutionRing to an output stream.
+ * Formatting and I/O happen on this thread only, so the search thread never blocks on output.
+ *
+ * Formats: * TEXT, human readable, same content as the intermediate solutions printed by main.cpp.
+ *          * BINARY, one fixed-size record per solution: objective (double), time (double), N memberships (int32),
+ *                in host byte order.
+ *          * DELTA_LOG, compact log where each solution is stored as its changes against the previous one (see SolutionLog.h).
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __SOLUTION_WRITER_H
+#define __SOLUTION_WRITER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "SolutionLog.h"
+#include "SolutionRing.h"
+
+
+namespace SolutionOutputOptions {
+    enum class Format {
+        TEXT,
+        BINARY,
+        DELTA_LOG
+    };
+}
+
+
+class SolutionWriter {
+private:
+    SolutionRing& _ring;
+    std::ostream& _out;
+    SolutionOutputOptions::Format _format;
+    int _k; // Number of classes, for cardinalities in TEXT format
+
+    std::atomic<bool> stopRequested;
+    std::thread thread;
+
+    std::uint64_t nbWritten;
+    std::vector<int> cardinalities; // Working buffer of the writer thread
+    std::unique_ptr<SolutionLogEncoder> encoder; // DELTA_LOG format only
+
+    void writerLoop();
+    void write(const int* memberships, double objective, double time);
+
+public:
+    // Starts the writer thread. ring and out must outlive the writer.
+    SolutionWriter(SolutionRing& ring, std::ostream& out, SolutionOutputOptions::Format format, int k);
+
+    // Calls stop
+    ~SolutionWriter();
+
+    SolutionWriter(const SolutionWriter&) = delete;
+    SolutionWriter& operator=(const SolutionWriter&) = delete;
+
+    // Writes the solutions still in the ring, then the one of its spare slot if any, flushes the stream and joins the
+    //     writer thread. Idempotent. Must be called once the producer is done publishing.
+    void stop();
+
+    // Only meaningful after stop
+    std::uint64_t getNbWritten() const { return nbWritten; }
+};
+
+#endif // !__SOLUTION_WRITER_H
@@ -0,0 +1,146 @@
+/*
+ * Bounded, lock-free transposition table of subproblem bounds, for use inside the WCSS constraints.
+ * Refer to TranspositionTable.h for information.
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#include "TranspositionTable.h"
+
+
+// Fewer slots than this are not worth probing
+#define __TRANSPOSITION_TABLE_MIN_SLOTS 16
+
+
+// Finalizer of splitmix64, spreads the bits of signatures before they are summed
+static std::uint64_t mix(std::uint64_t x) {
+    x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27))*0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+
+void TranspositionTable::build(IloCPEngine cp, IlcInt n, IlcInt k, const PropagationParameters* parameters) {
+    _n = n;
+    _k = k;
+
+    payloadWords = (2*_n*(size_t) _k + 63) / 64;
+    slotWords = 4 + payloadWords;
+
+    const size_t bytes = (parameters != NULL && parameters->transpositionBytes > 0) ? parameters->transpositionBytes : 0;
+    nbSlots = 1;
+    while (2*nbSlots*slotWords*sizeof(std::uint64_t) <= bytes)
+        nbSlots *= 2;
+    if (nbSlots < __TRANSPOSITION_TABLE_MIN_SLOTS) {
+        nbSlots = 0;
+        payloadWords = 0;
+        return;
+    }
+
+    // Fixed seed, so that runs are reproducible
+    std::mt19937_64 generator(0x5eed);
+    fixedCodes.resize(_n);
+    arcCodes.resize(_n);
+    fixedChecks.resize(_n);
+    arcChecks.resize(_n);
+    for (IlcInt i = 0; i < _n; i++) {
+        fixedCodes[i] = generator();
+        arcCodes[i] = generator();
+        fixedChecks[i] = generator();
+        arcChecks[i] = generator();
+    }
+
+    slots = new (cp.getHeap()) std::atomic<std::uint64_t>[nbSlots*slotWords]; // Allocation on engine heap, released with it
+    for (size_t w = 0; w < nbSlots*slotWords; w++)
+        slots[w].store(0, std::memory_order_relaxed);
+}
+
+
+TranspositionKey TranspositionTable::computeKey(const std::vector<IlcInt>* setP, const IlcInt* setU, IlcInt nbU,
+                                                const DomainSnapshot& domains, IlcIntArray targets, IlcIntArray nbToAdd,
+                                                std::vector<IlcInt>& ranks) const {
+    std::vector<std::pair<std::pair<IlcInt, std::uint64_t>, IlcInt> > signatures(_k); // ((target, signature), cluster)
+
+    // The sums don't depend on the labels of clusters, the ranks give them canonical ones
+    TranspositionKey key = {0, 0};
+    for (IlcInt c = 0; c < _k; c++) {
+        std::uint64_t signature = mix((std::uint64_t) targets[c]);
+        std::uint64_t checkSignature = mix(~(std::uint64_t) targets[c]);
+        for (size_t j = 0; j < setP[c].size(); j++) {
+            signature ^= fixedCodes[setP[c][j]];
+            checkSignature ^= fixedChecks[setP[c][j]];
+        }
+        if (nbToAdd[c] > 0) {
+            for (IlcInt u = 0; u < nbU; u++) {
+                if (domains.isInDomain(setU[u], c)) {
+                    signature ^= arcCodes[setU[u]];
+                    checkSignature ^= arcChecks[setU[u]];
+                }
+            }
+        }
+
+        key.hash += mix(signature);
+        key.check += mix(checkSignature);
+        signatures[c] = std::make_pair(std::make_pair((IlcInt) targets[c], signature), c);
+    }
+
+    std::sort(signatures.begin(), signatures.end());
+    ranks.resize(_k);
+    for (IlcInt r = 0; r < _k; r++)
+        ranks[signatures[r].second] = r;
+
+    return key;
+}
+
+
+bool TranspositionTable::lookup(const TranspositionKey& key, IlcFloat& bound, std::uint64_t* flow) {
+    nbLookups.fetch_add(1, std::memory_order_relaxed);
+    std::atomic<std::uint64_t>* slot = &slots[(key.hash & (nbSlots - 1))*slotWords];
+
+    const std::uint64_t sequence = slot[0].load(std::memory_order_acquire);
+    if ((sequence & 1) != 0) // Being written
+        return false;
+    if (slot[1].load(std::memory_order_relaxed) != key.hash || slot[2].load(std::memory_order_relaxed) != key.check)
+        return false;
+
+    const std::uint64_t boundBits = slot[3].load(std::memory_order_relaxed);
+    for (size_t w = 0; w < payloadWords; w++)
+        flow[w] = slot[4 + w].load(std::memory_order_relaxed);
+
+    // The entry may have been replaced while it was read
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot[0].load(std::memory_order_relaxed) != sequence)
+        return false;
+
+    std::memcpy(&bound, &boundBits, sizeof(bound));
+    nbHits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+void TranspositionTable::store(const TranspositionKey& key, IlcFloat bound, const std::uint64_t* flow) {
+    std::atomic<std::uint64_t>* slot = &slots[(key.hash & (nbSlots - 1))*slotWords];
+
+    // Writers don't wait for each other, the entry is dropped if another one holds the slot
+    std::uint64_t sequence = slot[0].load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 || !slot[0].compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::uint64_t boundBits;
+    std::memcpy(&boundBits, &bound, sizeof(bound));
+
+    slot[1].store(key.hash, std::memory_order_relaxed);
+    slot[2].store(key.check, std::memory_order_relaxed);
+    slot[3].store(boundBits, std::memory_order_relaxed);
+    for (size_t w = 0; w < payloadWords; w++)
+        slot[4 + w].store(flow[w], std::memory_order_relaxed);
+
+    slot[0].store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,84 @@
+/*
+ * Bounded, lock-free transposition table of subproblem bounds, for use inside the WCSS constraints whose bound is expensive
+ *     (one CPLEX MCF per propagation in IlcWCSS_NetworkCardControl).
+ * Different branching paths often reach the same subproblem: same points fixed to the same clusters, and same arcs from the free
+ *     points to the clusters which are not full, up to a relabelling of clusters of equal target cardinality. The bound and flow
+ *     of that subproblem are then the same, and are looked up rather than recomputed.
+ *
+ * Key: Zobrist hashing. Each point has random 64-bit codes for being fixed to a cluster and for having an arc to it, and each
+ *     cluster a signature, the xor of the codes of its fixed points and arcs, and of the code of its target. The key combines
+ *     the mixed signatures of all clusters by a sum, which doesn't depend on their labels. Two such keys are kept, from two
+ *     independent sets of codes: one to find the slot, the other to check the entry. Clusters are given a canonical rank (by
+ *     target then signature), under which the flow is stored and read back.
+ * Slots: a power of two of them, within PropagationParameters::transpositionBytes, each replaced by the last entry stored there. Every slot is guarded by
+ *     a sequence number (seqlock): a writer makes it odd, writes, then makes it even again, and gives up if another writer holds
+ *     it; a reader retries nothing, it misses if the number is odd or changed during its read. So the table can be shared by
+ *     engines on several threads without locks. Entries are never wrong, at worst lost.
+ * Payload: the bound, and 2 bits per free point and cluster rank (the arc has flow, the arc is saturated).
+ *
+ * This is part of my (Haouas, M.N.) MSc's research project under supervision of Pesant, G. & Aloise, D.
+ */
+
+
+#ifndef __TRANSPOSITION_TABLE_H
+#define __TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Packed snapshot of domains
+#include "DomainSnapshot.h"
+
+// The table is enabled through the propagation parameters
+#include "PropagationSchedule.h"
+
+// Using (IBM ILOG CPLEX Optimization Studio) CP Optimizer Extensions
+#include <ilcp/cpext.h>
+
+
+struct TranspositionKey {
+    std::uint64_t hash, check;
+};
+
+
+class TranspositionTable {
+protected:
+    IlcInt _n, _k;
+
+    std::vector<std::uint64_t> fixedCodes, arcCodes; // Codes of point i when fixed to a cluster, when it has an arc to it
+    std::vector<std::uint64_t> fixedChecks, arcChecks; // Same, drawn independently, for the check key
+
+    size_t nbSlots, slotWords, payloadWords;
+    std::atomic<std::uint64_t>* slots; // Per slot: sequence, hash, check, bound, then payload. On the engine heap.
+
+    std::atomic<long> nbLookups, nbHits;
+
+public:
+    TranspositionTable() : _n(0), _k(0), nbSlots(0), slotWords(0), payloadWords(0), slots(NULL), nbLookups(0), nbHits(0) {}
+
+    // Codes and slots for n points and k clusters. parameters may be NULL (no table)
+    void build(IloCPEngine cp, IlcInt n, IlcInt k, const PropagationParameters* parameters);
+
+    bool isEnabled() const { return nbSlots > 0; }
+
+    // Key of the subproblem made of the points fixed in setP[c] and of the arcs from the free points setU[0..nbU-1] to the clusters
+    //     in their domain with nbToAdd[c] > 0. ranks[c] receives the canonical rank of cluster c.
+    TranspositionKey computeKey(const std::vector<IlcInt>* setP, const IlcInt* setU, IlcInt nbU, const DomainSnapshot& domains,
+                                IlcIntArray targets, IlcIntArray nbToAdd, std::vector<IlcInt>& ranks) const;
+
+    // Bit of the flow of the u-th free point to cluster rank r: hasFlow (saturated = false) or isSaturated (saturated = true)
+    static size_t getFlowBit(IlcInt u, IlcInt r, IlcInt k, bool saturated) { return 2*(u*(size_t) k + r) + (saturated ? 1 : 0); }
+    size_t getNbPayloadWords() const { return payloadWords; }
+
+    // Returns true and fills bound and flow (getNbPayloadWords() words) if key is in the table. Thread-safe.
+    bool lookup(const TranspositionKey& key, IlcFloat& bound, std::uint64_t* flow);
+
+    // Record the bound (IlcInfinity if the subproblem is infeasible) and flow of key. Thread-safe.
+    void store(const TranspositionKey& key, IlcFloat bound, const std::uint64_t* flow);
+
+    long getNbLookups() const { return nbLookups; }
+    long getNbHits() const { return nbHits; }
+};
+
+#endif // !__TRANSPOSITION_TABLE_H